@@ -16,30 +16,26 @@ struct ExtHandTracking
     };
     return s_extensions;
   }
-  XRFW_PROC(xrCreateHandTrackerEXT);
-  XRFW_PROC(xrDestroyHandTrackerEXT);
-  XRFW_PROC(xrLocateHandJointsEXT);
-  ExtHandTracking(XrInstance instance, XrSystemId system)
-    : xrCreateHandTrackerEXT(instance)
-    , xrDestroyHandTrackerEXT(instance)
-    , xrLocateHandJointsEXT(instance)
-  {
-  }
+  XRFW_EXT_HAND_TRACKING_FUNCTIONS(XRFW_PROC)
+  // the functions are resolved by their first call
+  ExtHandTracking(XrInstance instance, XrSystemId system) {}
 };
 
 struct ExtHandTracker
 {
   const ExtHandTracking& m_ext;
+  XrHandEXT m_hand;
   XrHandTrackerEXT m_tracker = XR_NULL_HANDLE;
   XrHandJointLocationEXT m_jointLocations[XR_HAND_JOINT_COUNT_EXT];
   XrHandJointLocationsEXT m_locations = {};
 
   ExtHandTracker(const ExtHandTracking& ext, XrSession session, bool isLeft)
     : m_ext(ext)
+    , m_hand(isLeft ? XR_HAND_LEFT_EXT : XR_HAND_RIGHT_EXT)
   {
     XrHandTrackerCreateInfoEXT createInfo{
       .type = XR_TYPE_HAND_TRACKER_CREATE_INFO_EXT,
-      .hand = isLeft ? XR_HAND_LEFT_EXT : XR_HAND_RIGHT_EXT,
+      .hand = m_hand,
       .handJointSet = XR_HAND_JOINT_SET_DEFAULT_EXT,
     };
     if (XR_FAILED(
@@ -74,6 +70,7 @@ struct ExtHandTracker
       PLOG_ERROR << "xrLocateHandJointsEXT";
       return {};
     }
+    xrfwCaptureHandJoints(m_hand, time, &m_locations);
 
     if (!m_locations.isActive) {
       return {};
@@ -7,6 +7,7 @@
 #include <vrm/srht_sender.h>
 #include <xrfw.h>
 #include <xrfw_impl_win32_d3d11.h>
+#include <xrfw_pose_batch.h>
 
 static std::optional<libvrm::vrm::HumanBones>
 ToVrmBone(XrBodyJointFB joint)
@@ -163,6 +164,8 @@ struct Context
   FbBodyTracking m_ext;
   std::shared_ptr<FbBodyTracker> m_tracker;
   std::vector<cuber::Instance> m_instances;
+  XrfwPoseBatch<XR_BODY_JOINT_COUNT_FB> m_joints;
+  DirectX::XMFLOAT4X4 m_jointMatrices[XR_BODY_JOINT_COUNT_FB];
 
   std::shared_ptr<libvrm::gltf::Scene> m_scene;
   asio::io_context m_io;
@@ -185,6 +188,9 @@ struct Context
   {
     // updae scene
     m_scene->Clear();
+    m_joints.Clear();
+    m_joints.Append(joints);
+    m_joints.StoreMatrix4x4(m_jointMatrices, sizeof(m_jointMatrices[0]));
     for (size_t i = 0; i < joints.size(); ++i) {
       // auto& joint = joints[i];
       char name[64];
@@ -192,7 +198,7 @@ struct Context
       auto ptr = std::make_shared<libvrm::gltf::Node>(name);
       m_scene->m_nodes.push_back(ptr);
     }
-    for (size_t i = 0; i < joints.size(); ++i) {
+    for (size_t i = 0; i < m_joints.count; ++i) {
       auto& joint = joints[i];
       auto& node = m_scene->m_nodes[i];
       if (i == 0) {
@@ -207,11 +213,7 @@ struct Context
           };
         }
       }
-      auto r = DirectX::XMMatrixRotationQuaternion(DirectX::XMLoadFloat4(
-        (const DirectX::XMFLOAT4*)&joint.pose.orientation));
-      auto t = DirectX::XMMatrixTranslationFromVector(
-        DirectX::XMLoadFloat3((const DirectX::XMFLOAT3*)&joint.pose.position));
-      node->SetWorldMatrix(r * t);
+      node->SetWorldMatrix(DirectX::XMLoadFloat4x4(&m_jointMatrices[i]));
     }
     m_scene->InitializeNodes();
 
@@ -224,17 +226,13 @@ struct Context
     const XrSpaceLocationFlags isValid =
       XR_SPACE_LOCATION_ORIENTATION_VALID_BIT |
       XR_SPACE_LOCATION_POSITION_VALID_BIT;
-    for (size_t i = 0; i < joints.size(); ++i) {
-      auto& joint = joints[i];
-      auto& node = m_scene->m_nodes[i];
-      if ((joint.locationFlags & isValid) != 0) {
-        // auto size = 0.01f; // joint.radius * 2;
-        // auto s = DirectX::XMMatrixScaling(size, size, size);
-        auto r = DirectX::XMMatrixRotationQuaternion(DirectX::XMLoadFloat4(
-          (const DirectX::XMFLOAT4*)&joint.pose.orientation));
-        auto t = DirectX::XMMatrixTranslationFromVector(DirectX::XMLoadFloat3(
-          (const DirectX::XMFLOAT3*)&joint.pose.position));
-        node->SetWorldMatrix(r * t);
+    m_joints.Clear();
+    m_joints.Append(joints);
+    m_joints.StoreMatrix4x4(m_jointMatrices, sizeof(m_jointMatrices[0]));
+    for (size_t i = 0; i < m_joints.count; ++i) {
+      if ((m_joints.flags[i] & isValid) != 0) {
+        m_scene->m_nodes[i]->SetWorldMatrix(
+          DirectX::XMLoadFloat4x4(&m_jointMatrices[i]));
       }
     }
 
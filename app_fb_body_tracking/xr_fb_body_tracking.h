@@ -16,18 +16,10 @@ struct FbBodyTracking
     };
     return s_extensions;
   }
-  XRFW_PROC(xrCreateBodyTrackerFB);
-  XRFW_PROC(xrDestroyBodyTrackerFB);
-  XRFW_PROC(xrLocateBodyJointsFB);
-  XRFW_PROC(xrGetBodySkeletonFB);
-
-  FbBodyTracking(XrInstance instance, XrSystemId system)
-    : xrCreateBodyTrackerFB(instance)
-    , xrDestroyBodyTrackerFB(instance)
-    , xrLocateBodyJointsFB(instance)
-    , xrGetBodySkeletonFB(instance)
-  {
-  }
+  XRFW_FB_BODY_TRACKING_FUNCTIONS(XRFW_PROC)
+
+  // the functions are resolved by their first call
+  FbBodyTracking(XrInstance instance, XrSystemId system) {}
 };
 
 struct FbBodyTracker
@@ -94,6 +86,7 @@ struct FbBodyTracker
       PLOG_ERROR << "xrLocateBodyJointsFB_";
       return {};
     }
+    xrfwCaptureBodyJoints(time, &m_locations);
 
     if (!m_locations.isActive) {
       return {};
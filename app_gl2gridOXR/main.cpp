@@ -22,13 +22,17 @@ renderFunc(XrTime time,
   fbo->Begin(xrfwCastTextureWin32OpenGL(swapchainImage),
              info.width,
              info.height,
-             g_clearColor);
+             g_clearColor,
+             xrfwCastTextureWin32OpenGL(
+               xrfwGetDepthSwapchainImage(info.firstView)));
   render_gles_scene(info.width, info.height, projection, view);
   if (rightProjection) {
     fbo->Begin(xrfwCastTextureWin32OpenGL(rightSwapchainImage),
                info.width,
                info.height,
-               g_clearColor);
+               g_clearColor,
+               xrfwCastTextureWin32OpenGL(
+                 xrfwGetDepthSwapchainImage(info.firstView + 1)));
     render_gles_scene(info.width, info.height, rightProjection, rightView);
   }
   fbo->End();
@@ -49,6 +53,8 @@ int
 main(int argc, char** argv)
 {
   XrfwPlatformWin32OpenGL platform;
+  // renderFunc draws into the depth swapchain images
+  xrfwSetCompositionLayerDepth(true);
   auto instance = platform.CreateInstance();
   if (!instance) {
     return 1;
@@ -69,6 +75,8 @@ void
 android_main(struct android_app* state)
 {
   XrfwPlatform platform(state);
+  // renderFunc draws into the depth swapchain images
+  xrfwSetCompositionLayerDepth(true);
   auto instance = platform.CreateInstance();
   if (!instance) {
     return;
@@ -7,6 +7,7 @@
 #include <plog/Log.h>
 #include <xrfw.h>
 #include <xrfw_impl_win32_d3d11.h>
+#include <xrfw_pose_batch.h>
 
 const auto TextureBind = 0;
 const auto PalleteIndex = 7;
@@ -23,6 +24,7 @@ struct Context
   winrt::com_ptr<ID3D11DepthStencilView> m_dsv;
   cuber::dx11::DxCubeStereoRenderer m_cuber;
   std::vector<cuber::Instance> m_instances;
+  XrfwPoseBatch<XR_HAND_JOINT_COUNT_EXT * 2> m_joints;
 
   ExtHandTracking m_ext;
   std::shared_ptr<ExtHandTracker> m_trackerL;
@@ -220,27 +222,13 @@ struct Context
     m_instances.clear();
 
     auto space = xrfwAppSpace();
-    for (auto& joint : m_trackerL->Update(time, space)) {
-      auto size = joint.radius * 2;
-      auto s = DirectX::XMMatrixScaling(size, size, size);
-      auto r = DirectX::XMMatrixRotationQuaternion(DirectX::XMLoadFloat4(
-        (const DirectX::XMFLOAT4*)&joint.pose.orientation));
-      auto t = DirectX::XMMatrixTranslationFromVector(
-        DirectX::XMLoadFloat3((const DirectX::XMFLOAT3*)&joint.pose.position));
-
-      m_instances.push_back({});
-      DirectX::XMStoreFloat4x4(&m_instances.back().Matrix, s * r * t);
-    }
-    for (auto& joint : m_trackerR->Update(time, space)) {
-      auto size = joint.radius * 2;
-      auto s = DirectX::XMMatrixScaling(size, size, size);
-      auto r = DirectX::XMMatrixRotationQuaternion(DirectX::XMLoadFloat4(
-        (const DirectX::XMFLOAT4*)&joint.pose.orientation));
-      auto t = DirectX::XMMatrixTranslationFromVector(
-        DirectX::XMLoadFloat3((const DirectX::XMFLOAT3*)&joint.pose.position));
-
-      m_instances.push_back({});
-      DirectX::XMStoreFloat4x4(&m_instances.back().Matrix, s * r * t);
+    m_joints.Clear();
+    // a cube of the joint diameter
+    m_joints.Append(m_trackerL->Update(time, space), 2.0f);
+    m_joints.Append(m_trackerR->Update(time, space), 2.0f);
+    m_instances.resize(m_joints.count);
+    if (m_joints.count > 0) {
+      m_joints.StoreMatrix4x4(&m_instances[0].Matrix, sizeof(cuber::Instance));
     }
 
     // cube
@@ -34,15 +34,9 @@ struct FBPassthrough
            XR_PASSTHROUGH_CAPABILITY_BIT_FB;
   }
 
-  XRFW_PROC(xrCreatePassthroughFB);
-  XRFW_PROC(xrCreatePassthroughLayerFB);
-  XRFW_PROC(xrPassthroughLayerSetStyleFB);
-  FBPassthrough(XrInstance instance, XrSystemId system)
-    : xrCreatePassthroughFB(instance)
-    , xrCreatePassthroughLayerFB(instance)
-    , xrPassthroughLayerSetStyleFB(instance)
-  {
-  }
+  XRFW_FB_PASSTHROUGH_FUNCTIONS(XRFW_PROC)
+  // the functions are resolved by their first call
+  FBPassthrough(XrInstance instance, XrSystemId system) {}
 };
 
 struct FBPassthroughFeature
@@ -1,9 +1,23 @@
 #include <array>
 #include <plog/Log.h>
 #include <xrfw.h>
+#include <xrfw_cull.h>
 #include <xrfw_swapchain_fbo.h>
 
 #include "ogldrawable.h"
+
+// the world bounds of the unit cube (-0.5 to 0.5) placed by cube
+static void
+PushCubeBounds(XrfwCullBoxes* bounds, const Cube& cube)
+{
+  auto r = glm::mat3_cast(cube.rotation);
+  auto h = cube.scale * 0.5f;
+  auto e = glm::abs(r[0]) * h.x + glm::abs(r[1]) * h.y + glm::abs(r[2]) * h.z;
+  auto mins = cube.translation - e;
+  auto maxs = cube.translation + e;
+  bounds->Push({ mins.x, mins.y, mins.z }, { maxs.x, maxs.y, maxs.z });
+}
+
 template<typename T>
 int
 run(T& platform)
@@ -16,6 +30,10 @@ run(T& platform)
     std::shared_ptr<OglDrawable> drawable;
     XrfwSwapchainFbo fbo = {};
     std::vector<Cube> cubes;
+    // cubes do not move, the bounds are built once
+    XrfwCullBoxes bounds;
+    XrfwCullFrustum frustum;
+    std::vector<uint32_t> visible;
   };
   Context context{
     .platform = platform,
@@ -27,6 +45,10 @@ run(T& platform)
     { 0, 0, 0 },
     { 0.25f, 0.25f, 0.25f },
   });
+  for (auto& cube : context.cubes) {
+    PushCubeBounds(&context.bounds, cube);
+  }
+  context.visible.resize(context.bounds.count);
 
   auto renderFunc = [](XrTime time,
                        const XrSwapchainImageBaseHeader* swapchainImage,
@@ -38,17 +60,35 @@ run(T& platform)
                        const float rightView[16],
                        void* user) -> const XrCompositionLayerBaseHeader* {
     auto pContext = ((Context*)user);
-    pContext->fbo.Begin(pContext->platform.CastTexture(swapchainImage),
-                        info.width,
-                        info.height,
-                        &pContext->clearColor[0]);
-    pContext->drawable->Render(projection, view, pContext->cubes);
+    // once for both eyes
+    if (rightProjection) {
+      pContext->frustum.Set(projection, view, rightProjection, rightView);
+    } else {
+      pContext->frustum.Set(projection, view, projection, view);
+    }
+    std::span<const uint32_t> visible{
+      pContext->visible.data(),
+      xrfwCullBoxes(
+        pContext->frustum, pContext->bounds, pContext->visible.data()),
+    };
+    pContext->fbo.Begin(
+      pContext->platform.CastTexture(swapchainImage),
+      info.width,
+      info.height,
+      &pContext->clearColor[0],
+      pContext->platform.CastTexture(
+        xrfwGetDepthSwapchainImage(info.firstView)));
+    pContext->drawable->Render(projection, view, pContext->cubes, visible);
     if (rightProjection) {
-      pContext->fbo.Begin(pContext->platform.CastTexture(rightSwapchainImage),
-                          info.width,
-                          info.height,
-                          &pContext->clearColor[0]);
-      pContext->drawable->Render(rightProjection, rightView, pContext->cubes);
+      pContext->fbo.Begin(
+        pContext->platform.CastTexture(rightSwapchainImage),
+        info.width,
+        info.height,
+        &pContext->clearColor[0],
+        pContext->platform.CastTexture(
+          xrfwGetDepthSwapchainImage(info.firstView + 1)));
+      pContext->drawable->Render(
+        rightProjection, rightView, pContext->cubes, visible);
     }
     pContext->fbo.End();
     return nullptr;
@@ -62,6 +102,8 @@ int
 main(int argc, char** argv)
 {
   XrfwPlatformWin32OpenGL platform;
+  // renderFunc draws into the depth swapchain images
+  xrfwSetCompositionLayerDepth(true);
   auto instance = platform.CreateInstance();
   if (!instance) {
     return 1;
@@ -83,6 +125,8 @@ void
 android_main(struct android_app* state)
 {
   XrfwPlatformAndroidOpenGLES platform(state);
+  // renderFunc draws into the depth swapchain images
+  xrfwSetCompositionLayerDepth(true);
   auto instance = platform.CreateInstance();
   if (!instance) {
     return;
@@ -107,7 +107,8 @@ OglDrawable::~OglDrawable() {
 }
 
 void OglDrawable::Render(const float projection[16], const float view[16],
-                         std::span<Cube> cubes) {
+                         std::span<const Cube> cubes,
+                         std::span<const uint32_t> visible) {
   // Set shaders and uniform variables.
   glUseProgram(m_program);
 
@@ -118,8 +119,9 @@ void OglDrawable::Render(const float projection[16], const float view[16],
   // Set cube primitive data.
   glBindVertexArray(m_vao);
 
-  // Render each cube
-  for (const Cube &cube : cubes) {
+  // Render each visible cube
+  for (auto index : visible) {
+    const Cube &cube = cubes[index];
     // Compute the model-view-projection transform and set it..
     auto t = glm::translate(glm::mat4(1), cube.translation);
     auto r = glm::toMat4(cube.rotation);
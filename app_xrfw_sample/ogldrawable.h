@@ -28,6 +28,8 @@ public:
   OglDrawable(const OglDrawable &) = delete;
   OglDrawable &operator=(const OglDrawable &) = delete;
   static std::shared_ptr<OglDrawable> Create();
+  // draws cubes[visible[i]]
   void Render(const float projection[16], const float view[16],
-              std::span<Cube> cubes);
+              std::span<const Cube> cubes,
+              std::span<const uint32_t> visible);
 };
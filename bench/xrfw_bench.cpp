@@ -0,0 +1,301 @@
+// Frame loop overhead of xrfw itself.
+//
+// Drives xrfwSession with a no-op RenderFunc against the mock runtime
+// (mock_runtime/) running unthrottled, and reports the CPU time of each
+// phase and the heap allocations per frame as json.
+// --sessions N runs N sessions on N threads, each with its own XrfwContext.
+// --trace path writes the frame trace of all sessions (xrfwWriteTrace).
+// --pipelined runs xrfwSessionPipelined, xrWaitFrame on the frame pacer
+// thread. Fails when no frame is rendered.
+//
+//   xrfw_bench [--frames N] [--warmup N] [--sessions N] [--output path]
+//              [--trace path] [--pipelined]
+#include <xrfw.h>
+#include <xrfw_frame_pacer.h>
+
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+//
+// count operator new. xrfw, the loader and the runtime are all counted, and
+// with --sessions the allocations of the other sessions too.
+//
+static std::atomic<uint64_t> g_allocations = 0;
+
+void*
+operator new(size_t size)
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto p = malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void
+operator delete(void* p) noexcept
+{
+  free(p);
+}
+void
+operator delete(void* p, size_t) noexcept
+{
+  free(p);
+}
+
+static const XrCompositionLayerBaseHeader*
+render(XrTime time,
+       const XrSwapchainImageBaseHeader* leftOrVrptSwapchainImage,
+       const XrSwapchainImageBaseHeader* rightSwapchainImage,
+       const XrfwSwapchains& info,
+       const float projection[16],
+       const float view[16],
+       const float rightProjection[16],
+       const float rightView[16],
+       void* user)
+{
+  return nullptr;
+}
+
+// per frame samples. nanoseconds
+struct BenchSample
+{
+  int64_t poll;
+  int64_t waitFrame;
+  int64_t beginFrame;
+  int64_t acquire;
+  int64_t release;
+  int64_t endFrame;
+  int64_t total;
+  uint64_t allocations;
+};
+
+// No graphics. The mock runtime ignores the graphics binding.
+struct BenchPlatform
+{
+  uint32_t warmup;
+  uint32_t frames;
+  uint32_t activeFrames = 0;
+  int64_t frameBegin = 0;
+  uint64_t allocationBegin = 0;
+  int64_t lastEndFrame = 0;
+  std::vector<BenchSample> samples;
+
+  BenchPlatform(uint32_t warmup, uint32_t frames)
+    : warmup(warmup)
+    , frames(frames)
+  {
+    samples.reserve(frames);
+  }
+
+  XrSession CreateSession(XrfwSwapchains* swapchains)
+  {
+    return xrfwCreateSessionLinuxEGL(
+      swapchains, EGL_NO_DISPLAY, nullptr, EGL_NO_CONTEXT);
+  }
+
+  bool BeginFrame()
+  {
+    if (activeFrames >= warmup + frames) {
+      return false;
+    }
+    allocationBegin = g_allocations.load(std::memory_order_relaxed);
+    frameBegin = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+                   .count();
+    return true;
+  }
+
+  void EndFrame(RenderFunc render, void* user)
+  {
+    auto allocations =
+      g_allocations.load(std::memory_order_relaxed) - allocationBegin;
+
+    XrfwFrameRecord record;
+    if (!xrfwGetFrameRecords(&record, 1) ||
+        record.endFrameEnd == lastEndFrame) {
+      // session is not running yet
+      return;
+    }
+    lastEndFrame = record.endFrameEnd;
+    if (activeFrames++ < warmup) {
+      return;
+    }
+    samples.push_back({
+      .poll = record.waitFrameBegin - frameBegin,
+      .waitFrame = record.waitFrameEnd - record.waitFrameBegin,
+      .beginFrame = record.beginFrameEnd - record.beginFrameBegin,
+      .acquire = record.acquireEnd - record.acquireBegin,
+      .release = record.releaseEnd - record.releaseBegin,
+      .endFrame = record.endFrameEnd - record.endFrameBegin,
+      .total = record.endFrameEnd - frameBegin,
+      .allocations = allocations,
+    });
+  }
+
+  void WaitEvent(std::chrono::milliseconds timeout)
+  {
+    std::this_thread::sleep_for(timeout);
+  }
+};
+
+template<typename T>
+static void
+printPhase(FILE* fp,
+           const char* name,
+           std::vector<BenchSample>& samples,
+           T BenchSample::*member,
+           bool last = false)
+{
+  std::vector<T> values;
+  values.reserve(samples.size());
+  for (auto& sample : samples) {
+    values.push_back(sample.*member);
+  }
+  auto percentile = [&](size_t p) {
+    auto nth = values.begin() + (values.size() - 1) * p / 100;
+    std::nth_element(values.begin(), nth, values.end());
+    return (long long)*nth;
+  };
+  double sum = 0;
+  for (auto value : values) {
+    sum += static_cast<double>(value);
+  }
+  fprintf(fp,
+          "    \"%s\": {\"mean\": %.1f, \"p50\": %lld, \"p95\": %lld, "
+          "\"p99\": %lld, \"max\": %lld}%s\n",
+          name,
+          sum / values.size(),
+          percentile(50),
+          percentile(95),
+          percentile(99),
+          (long long)*std::max_element(values.begin(), values.end()),
+          last ? "" : ",");
+}
+
+int
+main(int argc, char** argv)
+{
+  uint32_t frames = 2000;
+  uint32_t warmup = 200;
+  uint32_t sessions = 1;
+  const char* output = nullptr;
+  const char* trace = nullptr;
+  bool pipelined = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg == "--pipelined") {
+      pipelined = true;
+    } else if (i + 1 == argc) {
+      break;
+    } else if (arg == "--frames") {
+      frames = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--warmup") {
+      warmup = atoi(argv[++i]);
+    } else if (arg == "--sessions") {
+      sessions = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--output") {
+      output = argv[++i];
+    } else if (arg == "--trace") {
+      trace = argv[++i];
+    }
+  }
+
+  // measure xrfw, not the display period
+#ifdef XRFW_BENCH_RUNTIME_JSON
+  setenv("XR_RUNTIME_JSON", XRFW_BENCH_RUNTIME_JSON, 0);
+#endif
+  setenv("XRFW_MOCK_THROTTLE", "0", 0);
+
+  XrGraphicsRequirementsOpenGLESKHR graphicsRequirements = {
+    .type = XR_TYPE_GRAPHICS_REQUIREMENTS_OPENGL_ES_KHR,
+  };
+  xrfwInitExtensionsLinuxEGL(&graphicsRequirements);
+  if (!xrfwCreateInstance()) {
+    return 1;
+  }
+  // keep session state logging out of the measurement
+  plog::get()->setMaxSeverity(plog::warning);
+  xrfwSetTraceEnabled(trace != nullptr);
+
+  // returns after the frame pacer thread joined
+  auto run = [pipelined](BenchPlatform& platform) {
+    return pipelined ? xrfwSessionPipelined(platform, &render, nullptr)
+                     : xrfwSession(platform, &render, nullptr);
+  };
+
+  // the first session on the main thread with the default context
+  std::vector<BenchPlatform> platforms(sessions, { warmup, frames });
+  std::vector<int> rets(sessions);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 1; i < sessions; ++i) {
+    threads.emplace_back([&run, &platform = platforms[i], &ret = rets[i]]() {
+      auto context = xrfwCreateContext();
+      xrfwMakeContextCurrent(context);
+      xrfwSetTraceThreadName("session");
+      ret = run(platform);
+      xrfwMakeContextCurrent(nullptr);
+      xrfwDestroyContext(context);
+    });
+  }
+  xrfwSetTraceThreadName("main");
+  rets[0] = run(platforms[0]);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (trace && !xrfwWriteTrace(trace)) {
+    return 1;
+  }
+  xrfwDestroyInstance();
+
+  BenchPlatform platform(warmup, frames * sessions);
+  for (uint32_t i = 0; i < sessions; ++i) {
+    if (rets[i]) {
+      return rets[i];
+    }
+    platform.samples.insert(platform.samples.end(),
+                            platforms[i].samples.begin(),
+                            platforms[i].samples.end());
+  }
+  if (platform.samples.empty()) {
+    fprintf(stderr, "no frames\n");
+    return 1;
+  }
+
+  auto fp = output ? fopen(output, "w") : stdout;
+  if (!fp) {
+    fprintf(stderr, "fopen %s\n", output);
+    return 1;
+  }
+  fprintf(fp, "{\n");
+  fprintf(fp, "  \"sessions\": %u,\n", sessions);
+  fprintf(fp, "  \"pipelined\": %s,\n", pipelined ? "true" : "false");
+  fprintf(fp, "  \"frames\": %zu,\n", platform.samples.size());
+  fprintf(fp, "  \"unit\": \"ns\",\n");
+  fprintf(fp, "  \"phases\": {\n");
+  printPhase(fp, "poll", platform.samples, &BenchSample::poll);
+  printPhase(fp, "waitFrame", platform.samples, &BenchSample::waitFrame);
+  printPhase(fp, "beginFrame", platform.samples, &BenchSample::beginFrame);
+  printPhase(fp, "acquire", platform.samples, &BenchSample::acquire);
+  printPhase(fp, "release", platform.samples, &BenchSample::release);
+  printPhase(fp, "endFrame", platform.samples, &BenchSample::endFrame);
+  printPhase(fp, "total", platform.samples, &BenchSample::total, true);
+  fprintf(fp, "  },\n");
+  fprintf(fp, "  \"allocationsPerFrame\": {\n");
+  printPhase(
+    fp, "operatorNew", platform.samples, &BenchSample::allocations, true);
+  fprintf(fp, "  }\n");
+  fprintf(fp, "}\n");
+  if (fp != stdout) {
+    fclose(fp);
+  }
+  return 0;
+}
@@ -0,0 +1,91 @@
+// Runs the headless EGL backend (XrfwPlatformLinuxEGL, -Dimpl_egl=true) with
+// the mock runtime for a few frames. Exits 77 (skipped) without an EGL
+// display.
+//
+//   xrfw_egl_smoke [--frames N]
+#include <xrfw.h>
+#include <xrfw_impl_linux_egl.h>
+
+#include <GLES3/gl32.h>
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string_view>
+
+struct SmokePlatform : XrfwPlatformLinuxEGL
+{
+  uint32_t frames;
+  uint32_t renderedFrames = 0;
+
+  SmokePlatform(uint32_t frames)
+    : frames(frames)
+  {
+  }
+
+  bool BeginFrame()
+  {
+    if (renderedFrames >= frames) {
+      return false;
+    }
+    return XrfwPlatformLinuxEGL::BeginFrame();
+  }
+};
+
+static const XrCompositionLayerBaseHeader*
+render(XrTime time,
+       const XrSwapchainImageBaseHeader* leftOrVrptSwapchainImage,
+       const XrSwapchainImageBaseHeader* rightSwapchainImage,
+       const XrfwSwapchains& info,
+       const float projection[16],
+       const float view[16],
+       const float rightProjection[16],
+       const float rightView[16],
+       void* user)
+{
+  auto platform = (SmokePlatform*)user;
+  ++platform->renderedFrames;
+  glClearColor(0, 0, 0, 1);
+  glClear(GL_COLOR_BUFFER_BIT);
+  return nullptr;
+}
+
+int
+main(int argc, char** argv)
+{
+  uint32_t frames = 60;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string_view arg = argv[i];
+    if (arg == "--frames") {
+      frames = std::max(1, atoi(argv[i + 1]));
+    }
+  }
+
+#ifdef XRFW_BENCH_RUNTIME_JSON
+  setenv("XR_RUNTIME_JSON", XRFW_BENCH_RUNTIME_JSON, 0);
+#endif
+  // mesa. a pbuffer context without X11 or Wayland
+  setenv("EGL_PLATFORM", "surfaceless", 0);
+
+  SmokePlatform platform(frames);
+  if (!platform.CreateInstance()) {
+    return 1;
+  }
+  if (!platform.InitializeGraphics()) {
+    fprintf(stderr, "no EGL display\n");
+    xrfwDestroyInstance();
+    return 77;
+  }
+
+  auto ret = xrfwSession(platform, &render, &platform);
+  xrfwDestroyInstance();
+  if (ret) {
+    return ret;
+  }
+  if (platform.renderedFrames < frames) {
+    fprintf(stderr, "%u / %u frames\n", platform.renderedFrames, frames);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,165 @@
+// Session level checks of xrfw against the mock runtime (mock_runtime/) with
+// XRFW_MOCK_VALIDATE, which aborts on a swapchain left at xrDestroySession and
+// on projection views that are not the last located poses at xrEndFrame.
+// Each case runs its own session. Returns 0 when all pass.
+//
+//   xrfw_session_test
+#include <xrfw.h>
+
+#include <plog/Log.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#define SESSION_CHECK(x)                                                       \
+  if (!(x)) {                                                                  \
+    fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #x);                    \
+    return false;                                                              \
+  }
+
+// Swapchain slots reused after a destroy are destroyed with the session.
+static bool
+ReuseSwapchainSlot()
+{
+  XrfwSwapchains swapchains{};
+  auto session = xrfwCreateSessionLinuxEGL(
+    &swapchains, EGL_NO_DISPLAY, nullptr, EGL_NO_CONTEXT);
+  SESSION_CHECK(session);
+
+  XrViewConfigurationView views[2]{
+    { .type = XR_TYPE_VIEW_CONFIGURATION_VIEW },
+    { .type = XR_TYPE_VIEW_CONFIGURATION_VIEW },
+  };
+  SESSION_CHECK(xrfwGetViewConfigurationViews(views, 2));
+  auto& view = views[0];
+  uint64_t format;
+  int width;
+  int height;
+  uint32_t first;
+  SESSION_CHECK(xrfwCreateSwapchain(view, &format, &width, &height, 1, 0,
+                                    &first));
+  xrfwDestroySwapchain(first);
+  uint32_t reused;
+  SESSION_CHECK(xrfwCreateSwapchain(view, &format, &width, &height, 1, 0,
+                                    &reused));
+  // the same slot, a new handle
+  SESSION_CHECK(reused != first);
+  // the stale handle does not reach the new swapchain
+  xrfwDestroySwapchain(first);
+  SESSION_CHECK(xrfwAcquireSwapchainSlot(reused));
+  xrfwReleaseSwapchainSlot(reused);
+
+  // the mock runtime aborts on a leaked swapchain
+  xrfwDestroySession(session);
+  return true;
+}
+
+// xrfwSession for a number of rendered frames with late latch. The mock
+// runtime refines the head pose of the second xrLocateViews, so the latched
+// view differs from the rendered one, and xrEndFrame checks that the
+// projection views carry it.
+struct LateLatchSession
+{
+  uint32_t frames;
+  uint32_t rendered = 0;
+  uint32_t latched = 0;
+  uint32_t unchanged = 0;
+  float view[16];
+
+  XrSession CreateSession(XrfwSwapchains* swapchains)
+  {
+    return xrfwCreateSessionLinuxEGL(
+      swapchains, EGL_NO_DISPLAY, nullptr, EGL_NO_CONTEXT);
+  }
+
+  bool BeginFrame() { return rendered < frames; }
+
+  void EndFrame(RenderFunc render, void* user) {}
+
+  void WaitEvent(std::chrono::milliseconds timeout)
+  {
+    std::this_thread::sleep_for(timeout);
+  }
+
+  static const XrCompositionLayerBaseHeader* Render(
+    XrTime time,
+    const XrSwapchainImageBaseHeader* leftOrVrptSwapchainImage,
+    const XrSwapchainImageBaseHeader* rightSwapchainImage,
+    const XrfwSwapchains& info,
+    const float projection[16],
+    const float view[16],
+    const float rightProjection[16],
+    const float rightView[16],
+    void* user)
+  {
+    auto self = (LateLatchSession*)user;
+    ++self->rendered;
+    memcpy(self->view, view, sizeof(self->view));
+    return nullptr;
+  }
+
+  static void OnLateLatch(const XrfwViewMatrices& viewMatrix, void* user)
+  {
+    auto self = (LateLatchSession*)user;
+    ++self->latched;
+    if (memcmp(viewMatrix.views[0].view, self->view, sizeof(self->view)) ==
+        0) {
+      ++self->unchanged;
+    }
+  }
+};
+
+static bool
+LateLatch()
+{
+  LateLatchSession session{ .frames = 8 };
+  SESSION_CHECK(
+    xrfwSetLateLatch(true, &LateLatchSession::OnLateLatch, &session));
+  auto ret = xrfwSession(session, &LateLatchSession::Render, &session);
+  xrfwSetLateLatch(false);
+  SESSION_CHECK(ret == 0);
+  SESSION_CHECK(session.rendered == session.frames);
+  SESSION_CHECK(session.latched == session.frames);
+  SESSION_CHECK(session.unchanged == 0);
+  return true;
+}
+
+int
+main(int argc, char** argv)
+{
+#ifdef XRFW_BENCH_RUNTIME_JSON
+  setenv("XR_RUNTIME_JSON", XRFW_BENCH_RUNTIME_JSON, 0);
+#endif
+  setenv("XRFW_MOCK_THROTTLE", "0", 0);
+  setenv("XRFW_MOCK_VALIDATE", "1", 0);
+
+  XrGraphicsRequirementsOpenGLESKHR graphicsRequirements = {
+    .type = XR_TYPE_GRAPHICS_REQUIREMENTS_OPENGL_ES_KHR,
+  };
+  xrfwInitExtensionsLinuxEGL(&graphicsRequirements);
+  if (!xrfwCreateInstance()) {
+    return 1;
+  }
+  plog::get()->setMaxSeverity(plog::warning);
+
+  struct
+  {
+    const char* name;
+    bool (*run)();
+  } cases[] = {
+    { "ReuseSwapchainSlot", &ReuseSwapchainSlot },
+    { "LateLatch", &LateLatch },
+  };
+  int failed = 0;
+  for (auto& c : cases) {
+    auto ok = c.run();
+    printf("%s %s\n", ok ? "ok" : "FAILED", c.name);
+    if (!ok) {
+      ++failed;
+    }
+  }
+  xrfwDestroyInstance();
+  return failed ? 1 : 0;
+}
@@ -1,10 +1,15 @@
 #pragma once
+#include "xrfw_dispatch.h"
+#include "xrfw_extensions.h"
 #include "xrfw_func.h"
+#include <algorithm>
+#include <assert.h>
 #include <chrono>
 #include <ostream>
 #include <span>
 #include <stdint.h>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
 #ifdef XR_USE_PLATFORM_WIN32
@@ -23,6 +28,23 @@
 
 XRFW_API void
 xrfwInitLogger();
+
+// Session and frame loop state. The session, swapchain, layer and frame
+// functions use the current context of the calling thread, the default context
+// until xrfwMakeContextCurrent. Run one session per thread, each with its own
+// context. The instance is shared, the OpenXR loader allows one XrInstance per
+// process.
+struct XrfwContext;
+XRFW_API XrfwContext*
+xrfwCreateContext();
+// after xrfwDestroySession. the default context is not destroyed.
+XRFW_API void
+xrfwDestroyContext(XrfwContext* context);
+// nullptr: the default context
+XRFW_API void
+xrfwMakeContextCurrent(XrfwContext* context);
+XRFW_API XrfwContext*
+xrfwGetCurrentContext();
 XRFW_API XrInstance
 xrfwCreateInstance(const char* const* extensionNames = nullptr,
                    uint32_t extensionCount = 0,
@@ -33,23 +55,109 @@ XRFW_API void
 xrfwDestroyInstance();
 XRFW_API XrInstance
 xrfwGetInstance();
+// runtime entry points of the frame loop, valid after xrfwCreateInstance.
+// apps can locate spaces and submit through it too.
+XRFW_API const XrfwDispatchTable*
+xrfwGetDispatchTable();
+// extensions of the current instance, requested by the app or enabled by
+// xrfwCreateInstance
+XRFW_API XrBool32
+xrfwIsExtensionEnabled(XrfwExtension extension);
 
 XRFW_API XrSession
 xrfwCreateSession(XrfwSwapchains* swapchains, const void* next, bool useVrpt);
 XRFW_API void
 xrfwDestroySession(void* session);
+// call before xrfwCreateInstance. default PRIMARY_STEREO.
+// PRIMARY_QUAD_VARJO enables XR_VARJO_quad_views. xrfwCreateInstance falls
+// back to PRIMARY_STEREO if the runtime does not have the extension, and
+// xrfwCreateSession if the system does not have the view configuration.
+XRFW_API void
+xrfwSetViewConfiguration(XrViewConfigurationType viewConfigurationType);
+// call before xrfwCreateInstance. default false.
+// XR_KHR_composition_layer_depth is enabled if the runtime has it and the
+// platform selects a depth format (OpenGL, OpenGL ES). Each color swapchain
+// gets a depth swapchain and the projection views submit it for positional
+// reprojection. Enable it only when the renderer draws into the depth image
+// (xrfwGetDepthSwapchainImage), the runtime reprojects with whatever it
+// holds.
+XRFW_API void
+xrfwSetCompositionLayerDepth(XrBool32 enable);
 XRFW_API XrSpace
 xrfwAppSpace();
+// xrLocateSpace memoized per (space, baseSpace, time) until the next
+// xrfwBeginFrame. Prefer it over xrLocateSpace for poses at
+// predictedDisplayTime, every caller after the first gets the same pose
+// without a runtime call. location->next is not cached.
+XRFW_API XrResult
+xrfwLocateSpace(XrSpace space,
+                XrSpace baseSpace,
+                XrTime time,
+                XrSpaceLocation* location);
+struct XrfwSpaceLocationCacheStats
+{
+  // since xrfwCreateContext
+  uint64_t hitCount;
+  // xrLocateSpace calls
+  uint64_t missCount;
+};
+XRFW_API void
+xrfwGetSpaceLocationCacheStats(XrfwSpaceLocationCacheStats* stats);
+// locations[i] of spaces[i] in one xrLocateSpacesKHR call (xrLocateSpaces on
+// OpenXR 1.1). xrfwCreateInstance enables XR_KHR_locate_spaces if the runtime
+// has it, otherwise xrfwLocateSpace is called for each space.
+// locations[i].next is not filled by the batched call.
+XRFW_API XrResult
+xrfwLocateSpaces(const XrSpace* spaces,
+                 uint32_t spaceCount,
+                 XrSpace baseSpace,
+                 XrTime time,
+                 XrSpaceLocation* locations);
+inline XrResult
+xrfwLocateSpaces(std::span<const XrSpace> spaces,
+                 XrSpace baseSpace,
+                 XrTime time,
+                 std::span<XrSpaceLocation> locations)
+{
+  assert(locations.size() >= spaces.size());
+  return xrfwLocateSpaces(spaces.data(),
+                          static_cast<uint32_t>(spaces.size()),
+                          baseSpace,
+                          time,
+                          locations.data());
+}
 
 XRFW_API XrBool32
 xrfwGetViewConfigurationViews(XrViewConfigurationView* viewConfigurationViews,
                               uint32_t viewCount);
+// viewIndex: first projection view the swapchain is submitted to.
+// outSlot: slot for xrfwAcquireSwapchainSlot, xrfwReleaseSwapchainSlot and
+// xrfwDestroySwapchain. slots of destroyed swapchains are reused, and the old
+// slot handle no longer matches.
+// outDepthSwapchain, outDepthSlot: the depth swapchain of the same size, if
+// enabled (xrfwSetCompositionLayerDepth). It is acquired, released and
+// destroyed with the color slot.
 XRFW_API XrSwapchain
 xrfwCreateSwapchain(const XrViewConfigurationView& viewConfigurationView,
                     uint64_t* format,
                     int* width,
                     int* height,
-                    uint32_t arraySize);
+                    uint32_t arraySize,
+                    uint32_t viewIndex = 0,
+                    uint32_t* outSlot = nullptr,
+                    XrSwapchain* outDepthSwapchain = nullptr,
+                    uint32_t* outDepthSlot = nullptr);
+XRFW_API void
+xrfwDestroySwapchain(uint32_t slot);
+XRFW_API const XrSwapchainImageBaseHeader*
+xrfwAcquireSwapchainSlot(uint32_t slot);
+XRFW_API void
+xrfwReleaseSwapchainSlot(uint32_t slot);
+// depth image acquired with the color swapchain of the view in this frame.
+// nullptr without depth swapchains.
+XRFW_API const XrSwapchainImageBaseHeader*
+xrfwGetDepthSwapchainImage(uint32_t viewIndex);
+// searches the slot by handle
 XRFW_API const XrSwapchainImageBaseHeader*
 xrfwAcquireSwapchain(XrSwapchain swapchain);
 XRFW_API void
@@ -59,34 +167,470 @@ XRFW_API XrBool32
 xrfwPollEventsIsSessionActive(SessionBeginFunc begin,
                               SessionEndFunc end,
                               void* user);
+// latest state from XrEventDataSessionStateChanged
+XRFW_API XrSessionState
+xrfwGetSessionState();
 
+struct XrfwViewMatrix
+{
+  float projection[16];
+  float view[16];
+};
+// views[0] left, views[1] right, views[2..3] foveated insets.
+// XrfwSwapchains::viewCount are valid.
 struct XrfwViewMatrices
 {
-  float leftProjection[16];
-  float leftView[16];
-  float rightProjection[16];
-  float rightView[16];
+  XrfwViewMatrix views[XRFW_MAX_VIEW_COUNT];
 };
 XRFW_API const XrCompositionLayerBaseHeader*
 xrfwBeginFrame(XrTime* outtime, XrfwViewMatrices* viewMatrix);
+// xrfwBeginFrame split in two. xrWaitFrame only
+XRFW_API XrBool32
+xrfwWaitFrame(XrFrameState* outFrameState);
+// xrBeginFrame and xrLocateViews for a frameState from xrfwWaitFrame
+XRFW_API const XrCompositionLayerBaseHeader*
+xrfwBeginFrameWithState(const XrFrameState* frameState,
+                        XrTime* outtime,
+                        XrfwViewMatrices* viewMatrix);
 XRFW_API XrBool32
 xrfwEndFrame(const XrCompositionLayerBaseHeader* const* layers,
              uint32_t layerCount);
 
+// Composition layers owned by xrfw. xrfwRenderFrame submits them after the
+// projection layer. A layer is rendered only while it is dirty, otherwise the
+// compositor keeps sampling the last released image.
+enum XrfwLayerShape
+{
+  XRFW_LAYER_QUAD,
+  // XR_KHR_composition_layer_cylinder
+  XRFW_LAYER_CYLINDER,
+};
+struct XrfwLayerCreateInfo
+{
+  XrfwLayerShape shape = XRFW_LAYER_QUAD;
+  // swapchain pixels
+  int width = 0;
+  int height = 0;
+  // XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT. rendered once, xrfwInvalidateLayer
+  // is ignored.
+  XrBool32 staticImage = false;
+  // pose in xrfwAppSpace, or in the view space if headLocked
+  XrBool32 headLocked = false;
+  XrPosef pose = { { 0, 0, 0, 1 }, { 0, 0, 0 } };
+  XrCompositionLayerFlags layerFlags = 0;
+  // quad. meters
+  XrExtent2Df size = { 1, 1 };
+  // cylinder
+  float radius = 1;
+  float centralAngle = 1;
+  float aspectRatio = 1;
+  XrfwLayerRenderFunc render = nullptr;
+  void* user = nullptr;
+};
+// after xrfwCreateSession. XRFW_INVALID_LAYER if failed.
+XRFW_API uint32_t
+xrfwCreateLayer(const XrfwLayerCreateInfo* createInfo);
+XRFW_API void
+xrfwDestroyLayer(uint32_t layer);
+XRFW_API void
+xrfwSetLayerPose(uint32_t layer, const XrPosef* pose);
+XRFW_API void
+xrfwSetLayerVisible(uint32_t layer, XrBool32 visible);
+// render again in the next frame
+XRFW_API void
+xrfwInvalidateLayer(uint32_t layer);
+// render the dirty layers and append the visible ones to layers[layerCount].
+// returns the new layer count, up to capacity and maxLayerCount.
+XRFW_API uint32_t
+xrfwUpdateLayers(const XrCompositionLayerBaseHeader** layers,
+                 uint32_t layerCount,
+                 uint32_t capacity);
+
+// Late latch.
+// xrfwEndFrame locates the views again just before xrEndFrame and submits the
+// fresher poses with the projection layer. callback receives the view matrices
+// for the new poses and must write them into a uniform buffer that the queued
+// GPU work has not read yet (see xrfw_late_latch_ubo.h). Otherwise the image
+// would not match the submitted poses, so enable without a callback fails.
+using XrfwLateLatchFunc = void (*)(const XrfwViewMatrices& viewMatrix,
+                                   void* user);
+XRFW_API XrBool32
+xrfwSetLateLatch(XrBool32 enable,
+                 XrfwLateLatchFunc callback = nullptr,
+                 void* user = nullptr);
+
+// Per frame timestamps. steady_clock nanoseconds
+struct XrfwFrameRecord
+{
+  int64_t waitFrameBegin;
+  int64_t waitFrameEnd;
+  int64_t beginFrameBegin;
+  int64_t beginFrameEnd;
+  // first xrfwAcquireSwapchain .. last xrfwAcquireSwapchain
+  int64_t acquireBegin;
+  int64_t acquireEnd;
+  // first xrfwReleaseSwapchain .. last xrfwReleaseSwapchain
+  int64_t releaseBegin;
+  int64_t releaseEnd;
+  int64_t endFrameBegin;
+  int64_t endFrameEnd;
+  XrTime predictedDisplayTime;
+  XrDuration predictedDisplayPeriod;
+  XrBool32 shouldRender;
+};
+// nanoseconds
+struct XrfwPhaseStats
+{
+  int64_t p50;
+  int64_t p95;
+  int64_t p99;
+};
+struct XrfwFrameStats
+{
+  uint32_t frameCount;
+  // predictedDisplayTime advanced more than 1.5 predictedDisplayPeriod
+  uint32_t missedDeadlineCount;
+  XrfwPhaseStats waitFrame;
+  XrfwPhaseStats beginFrame;
+  XrfwPhaseStats acquire;
+  // acquireEnd .. releaseBegin. RenderFunc
+  XrfwPhaseStats render;
+  XrfwPhaseStats release;
+  XrfwPhaseStats endFrame;
+  // waitFrameBegin .. endFrameEnd
+  XrfwPhaseStats total;
+};
+// copy the latest frame records, oldest first. returns the copied count.
+// call from the render thread.
+XRFW_API uint32_t
+xrfwGetFrameRecords(XrfwFrameRecord* records, uint32_t capacity);
+// summary of the latest frame records
+XRFW_API XrBool32
+xrfwGetFrameStats(XrfwFrameStats* stats);
+
+// Frame trace. xrfw marks xrfwPollEventsIsSessionActive, xrfwWaitFrame,
+// xrfwBeginFrameWithState, xrfwAcquireSwapchainSlot, the render callback,
+// xrfwReleaseSwapchainSlot and xrfwEndFrame. Apps add their own scopes with
+// XRFW_TRACE_SCOPE. Each thread records into its own buffer, the latest 8192
+// events are kept. Disabled by default, a disabled marker is one atomic load.
+XRFW_API void
+xrfwSetTraceEnabled(XrBool32 enable);
+// name of the calling thread in the trace. a literal
+XRFW_API void
+xrfwSetTraceThreadName(const char* name);
+// timestamp for xrfwTraceEnd. 0 while disabled
+XRFW_API int64_t
+xrfwTraceBegin();
+// name: a literal, it is written to the trace as is
+XRFW_API void
+xrfwTraceEnd(const char* name, int64_t begin);
+// Chrome trace event JSON of every thread. open it in chrome://tracing or
+// https://ui.perfetto.dev. can be called while the frame loop runs.
+XRFW_API XrBool32
+xrfwWriteTrace(const char* path);
+
+// Capture. Records what the runtime returns to the current context, frame by
+// frame: XrFrameState, the located views and the session state changes, and
+// the joints passed to xrfwCaptureHandJoints and xrfwCaptureBodyJoints, into
+// a mapped file (xrfw_capture.h). mock_runtime replays it without a headset
+// (XRFW_MOCK_REPLAY). Off until xrfwStartCapture.
+XRFW_API XrBool32
+xrfwStartCapture(const char* path);
+// writes the frame index. also by xrfwDestroySession
+XRFW_API void
+xrfwStopCapture();
+// ExtHandTracker and FbBodyTracker pass each located set
+XRFW_API void
+xrfwCaptureHandJoints(XrHandEXT hand,
+                      XrTime time,
+                      const XrHandJointLocationsEXT* locations);
+XRFW_API void
+xrfwCaptureBodyJoints(XrTime time, const XrBodyJointLocationsFB* locations);
+
+struct XrfwTraceScope
+{
+  const char* name;
+  int64_t begin;
+  XrfwTraceScope(const char* name)
+    : name(name)
+    , begin(xrfwTraceBegin())
+  {
+  }
+  ~XrfwTraceScope() { xrfwTraceEnd(name, begin); }
+  XrfwTraceScope(const XrfwTraceScope&) = delete;
+  XrfwTraceScope& operator=(const XrfwTraceScope&) = delete;
+};
+#define XRFW_TRACE_CONCAT_(a, b) a##b
+#define XRFW_TRACE_CONCAT(a, b) XRFW_TRACE_CONCAT_(a, b)
+#define XRFW_TRACE_SCOPE(name)                                                 \
+  XrfwTraceScope XRFW_TRACE_CONCAT(xrfwTraceScope, __LINE__)(name)
+
 #ifdef XR_USE_PLATFORM_WIN32
 #include "xrfw_win32.h"
 #elif XR_USE_PLATFORM_ANDROID
 #include "xrfw_android.h"
+#elif XR_USE_PLATFORM_EGL
+#include "xrfw_linux.h"
 #else
 #error "XR_USE_PLATFORM required"
 #endif
 
 //
 
-template<typename T>
+inline void
+xrfwRenderFrame(const XrfwSwapchains& swapchains,
+                XrTime frameTime,
+                const XrfwViewMatrices& viewMatrix,
+                const XrCompositionLayerBaseHeader* projectionLayer,
+                RenderViewsFunc render,
+                void* user);
+
+// RenderFunc for more than two views. The views go to it in pairs (quad
+// views: left, right, then the left, right insets), each call with an info
+// that describes the pair. The first layer it returns is submitted.
+struct XrfwStereoPairRender
+{
+  RenderFunc render;
+  void* user;
+
+  static const XrCompositionLayerBaseHeader* Render(
+    XrTime time,
+    uint32_t viewCount,
+    const XrfwViewImage* images,
+    const XrfwSwapchains& info,
+    void* user)
+  {
+    auto self = (XrfwStereoPairRender*)user;
+    const XrCompositionLayerBaseHeader* renderLayer = nullptr;
+    for (uint32_t i = 0; i < viewCount; i += 2) {
+      auto& left = images[i];
+      auto right = i + 1 < viewCount ? &images[i + 1] : nullptr;
+      XrfwSwapchains pair = info;
+      pair.firstView = i;
+      pair.viewCount = right ? 2 : 1;
+      pair.views[0] = *left.swapchain;
+      pair.leftOrVrpt = left.swapchain->swapchain;
+      pair.leftOrVrptSlot = left.swapchain->slot;
+      pair.width = left.swapchain->width;
+      pair.height = left.swapchain->height;
+      pair.right = nullptr;
+      pair.rightSlot = XRFW_INVALID_SWAPCHAIN_SLOT;
+      const XrSwapchainImageBaseHeader* rightImage = nullptr;
+      if (right) {
+        pair.views[1] = *right->swapchain;
+        // otherwise VPRT. the next layer of the left image
+        if (right->swapchain->imageArrayIndex == 0) {
+          pair.right = right->swapchain->swapchain;
+          pair.rightSlot = right->swapchain->slot;
+          rightImage = right->swapchainImage;
+        }
+      }
+      auto layer = self->render(time,
+                                left.swapchainImage,
+                                rightImage,
+                                pair,
+                                left.projection,
+                                left.view,
+                                right ? right->projection : nullptr,
+                                right ? right->view : nullptr,
+                                self->user);
+      if (!renderLayer) {
+        renderLayer = layer;
+      }
+    }
+    return renderLayer;
+  }
+};
+
+// acquire, render, release and submit one begun frame.
+// RenderFunc takes mono or stereo. More views are rendered in pairs
+// (XrfwStereoPairRender), RenderViewsFunc takes them all at once.
+inline void
+xrfwRenderFrame(const XrfwSwapchains& swapchains,
+                XrTime frameTime,
+                const XrfwViewMatrices& viewMatrix,
+                const XrCompositionLayerBaseHeader* projectionLayer,
+                RenderFunc render,
+                void* user)
+{
+  if (swapchains.viewCount > 2) {
+    // every view of the projection layer is acquired and rendered
+    XrfwStereoPairRender pairs{ render, user };
+    xrfwRenderFrame(swapchains,
+                    frameTime,
+                    viewMatrix,
+                    projectionLayer,
+                    &XrfwStereoPairRender::Render,
+                    &pairs);
+    return;
+  }
+  if (!projectionLayer) {
+    xrfwEndFrame({}, {});
+    return;
+  }
+
+  const XrCompositionLayerBaseHeader* layers[XRFW_MAX_LAYER_COUNT] = {
+    projectionLayer,
+  };
+  uint32_t layerCount = 1;
+  const XrCompositionLayerBaseHeader* renderLayer = nullptr;
+  auto use_vrpt = swapchains.right == nullptr;
+  if (swapchains.viewCount == 1) {
+    if (auto swapchainImage =
+          xrfwAcquireSwapchainSlot(swapchains.leftOrVrptSlot)) {
+      auto renderBegin = xrfwTraceBegin();
+      renderLayer = render(frameTime,
+                         swapchainImage,
+                         nullptr,
+                         swapchains,
+                         viewMatrix.views[0].projection,
+                         viewMatrix.views[0].view,
+                         nullptr,
+                         nullptr,
+                         user);
+      xrfwTraceEnd("render", renderBegin);
+      xrfwReleaseSwapchainSlot(swapchains.leftOrVrptSlot);
+    }
+  } else if (use_vrpt) {
+    if (auto swapchainImage =
+          xrfwAcquireSwapchainSlot(swapchains.leftOrVrptSlot)) {
+      auto renderBegin = xrfwTraceBegin();
+      renderLayer = render(frameTime,
+                         swapchainImage,
+                         nullptr,
+                         swapchains,
+                         viewMatrix.views[0].projection,
+                         viewMatrix.views[0].view,
+                         viewMatrix.views[1].projection,
+                         viewMatrix.views[1].view,
+                         user);
+      xrfwTraceEnd("render", renderBegin);
+      xrfwReleaseSwapchainSlot(swapchains.leftOrVrptSlot);
+    }
+  } else {
+    if (auto leftSwapchainImage =
+          xrfwAcquireSwapchainSlot(swapchains.leftOrVrptSlot)) {
+      if (auto rightSwapchainImage =
+            xrfwAcquireSwapchainSlot(swapchains.rightSlot)) {
+        auto renderBegin = xrfwTraceBegin();
+        renderLayer = render(frameTime,
+                           leftSwapchainImage,
+                           rightSwapchainImage,
+                           swapchains,
+                           viewMatrix.views[0].projection,
+                           viewMatrix.views[0].view,
+                           viewMatrix.views[1].projection,
+                           viewMatrix.views[1].view,
+                           user);
+        xrfwTraceEnd("render", renderBegin);
+        xrfwReleaseSwapchainSlot(swapchains.rightSlot);
+      }
+      xrfwReleaseSwapchainSlot(swapchains.leftOrVrptSlot);
+    }
+  }
+  if (renderLayer) {
+    layers[layerCount++] = renderLayer;
+  }
+  layerCount = xrfwUpdateLayers(layers, layerCount, std::size(layers));
+  xrfwEndFrame(layers, layerCount);
+}
+
+// any view count. VPRT views share the image of their array swapchain.
+inline void
+xrfwRenderFrame(const XrfwSwapchains& swapchains,
+                XrTime frameTime,
+                const XrfwViewMatrices& viewMatrix,
+                const XrCompositionLayerBaseHeader* projectionLayer,
+                RenderViewsFunc render,
+                void* user)
+{
+  if (!projectionLayer) {
+    xrfwEndFrame({}, {});
+    return;
+  }
+
+  const XrCompositionLayerBaseHeader* layers[XRFW_MAX_LAYER_COUNT] = {
+    projectionLayer,
+  };
+  uint32_t layerCount = 1;
+  const XrCompositionLayerBaseHeader* renderLayer = nullptr;
+  XrfwViewImage images[XRFW_MAX_VIEW_COUNT];
+  uint32_t acquired = 0;
+  for (; acquired < swapchains.viewCount; ++acquired) {
+    auto& view = swapchains.views[acquired];
+    auto swapchainImage = view.imageArrayIndex == 0
+                            ? xrfwAcquireSwapchainSlot(view.slot)
+                            : images[acquired - 1].swapchainImage;
+    if (!swapchainImage) {
+      break;
+    }
+    images[acquired] = {
+      .swapchainImage = swapchainImage,
+      .depthSwapchainImage = xrfwGetDepthSwapchainImage(acquired),
+      .swapchain = &view,
+      .projection = viewMatrix.views[acquired].projection,
+      .view = viewMatrix.views[acquired].view,
+    };
+  }
+  if (acquired == swapchains.viewCount) {
+    auto renderBegin = xrfwTraceBegin();
+    renderLayer = render(frameTime, acquired, images, swapchains, user);
+    xrfwTraceEnd("render", renderBegin);
+  }
+  for (uint32_t i = acquired; i-- > 0;) {
+    if (swapchains.views[i].imageArrayIndex == 0) {
+      xrfwReleaseSwapchainSlot(swapchains.views[i].slot);
+    }
+  }
+  if (renderLayer) {
+    layers[layerCount++] = renderLayer;
+  }
+  layerCount = xrfwUpdateLayers(layers, layerCount, std::size(layers));
+  xrfwEndFrame(layers, layerCount);
+}
+
+// the desktop mirror of platform.EndFrame takes RenderFunc only. lambdas
+// without captures convert to it.
+template<typename T, typename F>
+inline void
+xrfwPlatformEndFrame(T& platform, F render, void* user)
+{
+  if constexpr (std::is_convertible_v<F, RenderFunc>) {
+    platform.EndFrame(static_cast<RenderFunc>(render), user);
+  } else {
+    platform.EndFrame(nullptr, user);
+  }
+}
+
+// Wait between xrfwPollEventsIsSessionActive while the session is not
+// running. OpenXR has no blocking event wait, so xrPollEvent is retried at
+// 1, 2, 4 .. 32 ms. A session state change starts over from 1 ms, so the
+// READY => SYNCHRONIZED => FOCUSED burst is picked up right away.
+struct XrfwIdleBackoff
+{
+  static constexpr std::chrono::milliseconds MIN_WAIT{ 1 };
+  static constexpr std::chrono::milliseconds MAX_WAIT{ 32 };
+  XrSessionState state = XR_SESSION_STATE_UNKNOWN;
+  std::chrono::milliseconds wait = MIN_WAIT;
+
+  std::chrono::milliseconds Next()
+  {
+    auto current = xrfwGetSessionState();
+    if (current != state) {
+      state = current;
+      wait = MIN_WAIT;
+    } else {
+      wait = std::min(wait * 2, MAX_WAIT);
+    }
+    return wait;
+  }
+};
+
+// F: RenderFunc or RenderViewsFunc
+template<typename T, typename F>
 inline int
 xrfwSession(T& platform,
-            RenderFunc render,
+            F render,
             void* user,
             SessionBeginFunc begin = nullptr,
             SessionEndFunc end = nullptr)
@@ -97,8 +641,8 @@ xrfwSession(T& platform,
   if (!session) {
     return 3;
   }
-  auto use_vrpt = swapchains.right == nullptr;
 
+  XrfwIdleBackoff backoff;
   // glfw mainloop
   while (platform.BeginFrame()) {
 
@@ -106,61 +650,15 @@ xrfwSession(T& platform,
     if (xrfwPollEventsIsSessionActive(begin, end, user)) {
       XrTime frameTime;
       XrfwViewMatrices viewMatrix;
-      if (auto projectionLayer = xrfwBeginFrame(&frameTime, &viewMatrix)) {
-        const XrCompositionLayerBaseHeader* layers[2] = { projectionLayer,
-                                                          nullptr };
-        if (use_vrpt) {
-          if (auto swapchainImage =
-                xrfwAcquireSwapchain(swapchains.leftOrVrpt)) {
-            layers[1] = render(frameTime,
-                               swapchainImage,
-                               nullptr,
-                               swapchains,
-                               viewMatrix.leftProjection,
-                               viewMatrix.leftView,
-                               viewMatrix.rightProjection,
-                               viewMatrix.rightView,
-                               user);
-            xrfwReleaseSwapchain(swapchains.leftOrVrpt);
-          }
-        } else {
-          if (auto leftSwapchainImage =
-                xrfwAcquireSwapchain(swapchains.leftOrVrpt)) {
-            if (auto rightSwapchainImage =
-                  xrfwAcquireSwapchain(swapchains.right)) {
-              layers[1] = render(frameTime,
-                                 leftSwapchainImage,
-                                 rightSwapchainImage,
-                                 swapchains,
-                                 viewMatrix.leftProjection,
-                                 viewMatrix.leftView,
-                                 viewMatrix.rightProjection,
-                                 viewMatrix.rightView,
-                                 user);
-              xrfwReleaseSwapchain(swapchains.right);
-            }
-            xrfwReleaseSwapchain(swapchains.leftOrVrpt);
-          }
-        }
-        xrfwEndFrame(layers, layers[1] ? 2 : 1);
-        //   const XrCompositionLayerBaseHeader* layers[] = { (
-        //     const XrCompositionLayerBaseHeader*)&g_projection };
-        //   frameEndInfo = {
-        //     .type = XR_TYPE_FRAME_END_INFO,
-        //     .displayTime = g_frameState.predictedDisplayTime,
-        //     .environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE,
-        //     .layerCount = layerCount,
-        //     .layers = layers,
-        //   };
-      } else {
-        xrfwEndFrame({}, {});
-      }
+      auto projectionLayer = xrfwBeginFrame(&frameTime, &viewMatrix);
+      xrfwRenderFrame(
+        swapchains, frameTime, viewMatrix, projectionLayer, render, user);
     } else {
-      // XrSession is not active
-      platform.Sleep(std::chrono::milliseconds(30));
+      // XrSession is not active. a platform event wakes up early
+      platform.WaitEvent(backoff.Next());
     }
 
-    platform.EndFrame(render, user);
+    xrfwPlatformEndFrame(platform, render, user);
   }
 
   xrfwDestroySession(session);
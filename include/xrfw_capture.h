@@ -0,0 +1,342 @@
+#pragma once
+#include <openxr/openxr.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Capture file of xrfwStartCapture, replayed by mock_runtime
+// (XRFW_MOCK_REPLAY).
+//
+//   XrfwCaptureFileHeader
+//   records. XrfwCaptureRecordHeader + payload, 8 byte aligned
+//   uint64_t frameOffsets[frameCount]. the FrameState record of each frame
+//
+// The file is mapped, a record is read in place. Only depends on the OpenXR
+// headers, so the runtime can include it.
+static const char XRFW_CAPTURE_MAGIC[8] = {
+  'X', 'R', 'F', 'W', 'C', 'A', 'P', 0,
+};
+static const uint32_t XRFW_CAPTURE_VERSION = 1;
+
+struct XrfwCaptureFileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t frameCount;
+  // end of the records
+  uint64_t indexOffset;
+};
+
+enum XrfwCaptureRecordType : uint32_t
+{
+  // opens a frame. xrWaitFrame
+  XRFW_CAPTURE_FRAME_STATE = 1,
+  // xrLocateViews. twice in a frame with late latch
+  XRFW_CAPTURE_VIEWS,
+  XRFW_CAPTURE_SESSION_STATE,
+  XRFW_CAPTURE_HAND_JOINTS,
+  XRFW_CAPTURE_BODY_JOINTS,
+};
+
+struct XrfwCaptureRecordHeader
+{
+  XrfwCaptureRecordType type;
+  // payload bytes
+  uint32_t size;
+  // the frame of the record, FrameState records before the one of its frame.
+  // With xrfwSessionPipelined a record of frame N may follow the FrameState of
+  // frame N+1
+  uint64_t frame;
+};
+
+struct XrfwCaptureFrameState
+{
+  XrTime predictedDisplayTime;
+  XrDuration predictedDisplayPeriod;
+  XrBool32 shouldRender;
+};
+
+struct XrfwCaptureView
+{
+  XrPosef pose;
+  XrFovf fov;
+};
+// followed by XrfwCaptureView[viewCount]
+struct XrfwCaptureViews
+{
+  XrTime displayTime;
+  XrViewStateFlags viewStateFlags;
+  uint32_t viewCount;
+};
+
+struct XrfwCaptureSessionState
+{
+  XrSessionState state;
+  XrTime time;
+};
+
+// followed by XrHandJointLocationEXT[jointCount]
+struct XrfwCaptureHandJoints
+{
+  XrTime time;
+  XrHandEXT hand;
+  XrBool32 isActive;
+  uint32_t jointCount;
+};
+
+// followed by XrBodyJointLocationFB[jointCount]
+struct XrfwCaptureBodyJoints
+{
+  XrTime time;
+  XrBool32 isActive;
+  float confidence;
+  uint32_t skeletonChangedCount;
+  uint32_t jointCount;
+};
+
+inline constexpr uint64_t
+xrfwCaptureAlign(uint64_t size)
+{
+  return (size + 7) & ~uint64_t(7);
+}
+
+// A file mapped read only, or read write and resized by Map.
+struct XrfwMappedFile
+{
+#ifdef _WIN32
+  HANDLE m_file = INVALID_HANDLE_VALUE;
+  HANDLE m_mapping = nullptr;
+#else
+  int m_fd = -1;
+#endif
+  uint8_t* m_data = nullptr;
+  uint64_t m_size = 0;
+  bool m_writable = false;
+
+  XrfwMappedFile() = default;
+  XrfwMappedFile(const XrfwMappedFile&) = delete;
+  XrfwMappedFile& operator=(const XrfwMappedFile&) = delete;
+  ~XrfwMappedFile() { Close(); }
+
+  bool IsOpen() const { return m_data != nullptr; }
+
+  // the whole file, read only
+  bool OpenRead(const char* path)
+  {
+    Close();
+#ifdef _WIN32
+    m_file = CreateFileA(path,
+                         GENERIC_READ,
+                         FILE_SHARE_READ,
+                         nullptr,
+                         OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL,
+                         nullptr);
+    LARGE_INTEGER size;
+    if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size)) {
+      Close();
+      return false;
+    }
+    return Map(static_cast<uint64_t>(size.QuadPart));
+#else
+    m_fd = open(path, O_RDONLY);
+    struct stat st;
+    if (m_fd < 0 || fstat(m_fd, &st) != 0) {
+      Close();
+      return false;
+    }
+    return Map(static_cast<uint64_t>(st.st_size));
+#endif
+  }
+
+  // created or truncated, then mapped with size bytes
+  bool OpenWrite(const char* path, uint64_t size)
+  {
+    Close();
+    m_writable = true;
+#ifdef _WIN32
+    m_file = CreateFileA(path,
+                         GENERIC_READ | GENERIC_WRITE,
+                         0,
+                         nullptr,
+                         CREATE_ALWAYS,
+                         FILE_ATTRIBUTE_NORMAL,
+                         nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+      Close();
+      return false;
+    }
+#else
+    m_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) {
+      Close();
+      return false;
+    }
+#endif
+    return Map(size);
+  }
+
+  // remap with size bytes. a writable file grows or shrinks to size, the
+  // mapped pointer changes.
+  bool Map(uint64_t size)
+  {
+    Unmap();
+    if (size == 0) {
+      return false;
+    }
+#ifdef _WIN32
+    m_mapping = CreateFileMappingA(m_file,
+                                   nullptr,
+                                   m_writable ? PAGE_READWRITE : PAGE_READONLY,
+                                   static_cast<DWORD>(size >> 32),
+                                   static_cast<DWORD>(size),
+                                   nullptr);
+    if (!m_mapping) {
+      return false;
+    }
+    m_data = static_cast<uint8_t*>(MapViewOfFile(
+      m_mapping, m_writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size));
+#else
+    if (m_writable && ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+      return false;
+    }
+    auto data = mmap(nullptr,
+                     size,
+                     m_writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                     MAP_SHARED,
+                     m_fd,
+                     0);
+    m_data = data == MAP_FAILED ? nullptr : static_cast<uint8_t*>(data);
+#endif
+    if (!m_data) {
+      return false;
+    }
+    m_size = size;
+    return true;
+  }
+
+  // a writable file is cut to size bytes
+  void Close(uint64_t size = 0)
+  {
+    Unmap();
+#ifdef _WIN32
+    if (m_file != INVALID_HANDLE_VALUE) {
+      if (m_writable && size) {
+        LARGE_INTEGER end;
+        end.QuadPart = static_cast<LONGLONG>(size);
+        SetFilePointerEx(m_file, end, nullptr, FILE_BEGIN);
+        SetEndOfFile(m_file);
+      }
+      CloseHandle(m_file);
+      m_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_fd >= 0) {
+      if (m_writable && size) {
+        (void)ftruncate(m_fd, static_cast<off_t>(size));
+      }
+      ::close(m_fd);
+      m_fd = -1;
+    }
+#endif
+    m_writable = false;
+  }
+
+private:
+  void Unmap()
+  {
+#ifdef _WIN32
+    if (m_data) {
+      UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+      CloseHandle(m_mapping);
+      m_mapping = nullptr;
+    }
+#else
+    if (m_data) {
+      munmap(m_data, m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+  }
+};
+
+// Records of a mapped capture file.
+struct XrfwCaptureReader
+{
+  const uint8_t* m_data = nullptr;
+  const XrfwCaptureFileHeader* m_header = nullptr;
+  const uint64_t* m_frameOffsets = nullptr;
+
+  bool Load(const uint8_t* data, uint64_t size)
+  {
+    if (size < sizeof(XrfwCaptureFileHeader)) {
+      return false;
+    }
+    auto header = reinterpret_cast<const XrfwCaptureFileHeader*>(data);
+    if (memcmp(header->magic, XRFW_CAPTURE_MAGIC, sizeof(header->magic)) ||
+        header->version != XRFW_CAPTURE_VERSION ||
+        header->indexOffset < sizeof(XrfwCaptureFileHeader) ||
+        header->indexOffset + header->frameCount * sizeof(uint64_t) > size) {
+      return false;
+    }
+    m_data = data;
+    m_header = header;
+    m_frameOffsets =
+      reinterpret_cast<const uint64_t*>(data + header->indexOffset);
+    return true;
+  }
+
+  uint64_t FrameCount() const { return m_header ? m_header->frameCount : 0; }
+
+  const XrfwCaptureRecordHeader* At(uint64_t offset) const
+  {
+    if (offset + sizeof(XrfwCaptureRecordHeader) > m_header->indexOffset) {
+      return nullptr;
+    }
+    return reinterpret_cast<const XrfwCaptureRecordHeader*>(m_data + offset);
+  }
+
+  // the first record
+  const XrfwCaptureRecordHeader* First() const
+  {
+    return m_header ? At(sizeof(XrfwCaptureFileHeader)) : nullptr;
+  }
+
+  // the FrameState record of frame
+  const XrfwCaptureRecordHeader* Frame(uint64_t frame) const
+  {
+    return frame < FrameCount() ? At(m_frameOffsets[frame]) : nullptr;
+  }
+
+  const XrfwCaptureRecordHeader* Next(
+    const XrfwCaptureRecordHeader* record) const
+  {
+    auto offset = reinterpret_cast<const uint8_t*>(record) - m_data;
+    return At(offset + sizeof(XrfwCaptureRecordHeader) +
+              xrfwCaptureAlign(record->size));
+  }
+
+  template<typename T>
+  static const T* Payload(const XrfwCaptureRecordHeader* record)
+  {
+    return record->size >= sizeof(T)
+             ? reinterpret_cast<const T*>(record + 1)
+             : nullptr;
+  }
+};
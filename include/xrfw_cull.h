@@ -0,0 +1,274 @@
+#pragma once
+#include "xrfw.h"
+#include "xrfw_simd.h"
+#include <bit>
+#include <math.h>
+#include <openxr/openxr.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Frustum culling of many bounds for both eyes at once.
+//
+//   XrfwCullFrustum frustum;
+//   frustum.Set(projection, view, rightProjection, rightView);
+//   visible.resize(boxes.count);
+//   visible.resize(xrfwCullBoxes(frustum, boxes, visible.data()));
+//
+// A bound is visible when it touches the left or the right frustum, the union
+// of both eyes. A lane of bounds (xrfw_simd.h) is tested against the planes of
+// both eyes per instruction, and the visible ones are written as a compacted
+// index list. Like XrMatrix4x4f_CullBounds the test is conservative: a bound
+// outside near a frustum edge may pass.
+struct XrfwCullFrustum
+{
+  // [eye][left, right, bottom, top, near, far] = (a, b, c, d), inside is
+  // a * x + b * y + c * z + d >= 0. normalized, d is a distance.
+  float planes[2][6][4];
+
+  // column major, world to clip. The near plane is the OpenGL one
+  // (z >= -w), conservative for a D3D projection (z >= 0).
+  void Set(const float leftViewProjection[16],
+           const float rightViewProjection[16])
+  {
+    SetPlanes(planes[0], leftViewProjection);
+    SetPlanes(planes[1], rightViewProjection);
+  }
+
+  // the matrices of the render callback. a mono view passes the left ones
+  // twice.
+  void Set(const float leftProjection[16],
+           const float leftView[16],
+           const float rightProjection[16],
+           const float rightView[16])
+  {
+    float left[16];
+    Multiply(left, leftProjection, leftView);
+    float right[16];
+    Multiply(right, rightProjection, rightView);
+    Set(left, right);
+  }
+
+  void Set(const XrfwViewMatrices& viewMatrix)
+  {
+    Set(viewMatrix.views[0].projection,
+        viewMatrix.views[0].view,
+        viewMatrix.views[1].projection,
+        viewMatrix.views[1].view);
+  }
+
+private:
+  static void Multiply(float* result, const float* a, const float* b)
+  {
+    for (int c = 0; c < 4; ++c) {
+      for (int r = 0; r < 4; ++r) {
+        result[c * 4 + r] = a[r] * b[c * 4] + a[4 + r] * b[c * 4 + 1] +
+                            a[8 + r] * b[c * 4 + 2] + a[12 + r] * b[c * 4 + 3];
+      }
+    }
+  }
+
+  // Gribb and Hartmann. row 3 +- row 0, 1, 2 of the clip matrix
+  static void SetPlanes(float (*planes)[4], const float* m)
+  {
+    for (int i = 0; i < 6; ++i) {
+      auto row = i / 2;
+      auto sign = (i % 2) ? -1.0f : 1.0f;
+      auto plane = planes[i];
+      for (int j = 0; j < 4; ++j) {
+        plane[j] = m[j * 4 + 3] + sign * m[j * 4 + row];
+      }
+      auto length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] +
+                          plane[2] * plane[2]);
+      if (length > 0) {
+        // the far plane of an infinite projection has no normal, d >= 0
+        for (int j = 0; j < 4; ++j) {
+          plane[j] /= length;
+        }
+      }
+    }
+  }
+};
+
+// structure of arrays of count bounds, the arrays padded to whole lanes
+template<size_t M>
+struct XrfwCullSoA
+{
+  std::vector<float> arrays[M];
+  size_t count = 0;
+
+  void Clear()
+  {
+    count = 0;
+    for (auto& a : arrays) {
+      a.clear();
+    }
+  }
+
+  void Reserve(size_t capacity)
+  {
+    for (auto& a : arrays) {
+      a.reserve(xrfwLaneCeil(capacity));
+    }
+  }
+
+protected:
+  // index of a new bound
+  size_t Add()
+  {
+    if (count % XRFW_SIMD_WIDTH == 0) {
+      for (auto& a : arrays) {
+        a.resize(count + XRFW_SIMD_WIDTH);
+      }
+    }
+    return count++;
+  }
+};
+
+// axis aligned boxes. center and half extent
+struct XrfwCullBoxes : XrfwCullSoA<6>
+{
+  enum
+  {
+    CX,
+    CY,
+    CZ,
+    EX,
+    EY,
+    EZ,
+  };
+
+  void Push(const XrVector3f& mins, const XrVector3f& maxs)
+  {
+    auto i = Add();
+    arrays[CX][i] = (mins.x + maxs.x) * 0.5f;
+    arrays[CY][i] = (mins.y + maxs.y) * 0.5f;
+    arrays[CZ][i] = (mins.z + maxs.z) * 0.5f;
+    arrays[EX][i] = (maxs.x - mins.x) * 0.5f;
+    arrays[EY][i] = (maxs.y - mins.y) * 0.5f;
+    arrays[EZ][i] = (maxs.z - mins.z) * 0.5f;
+  }
+};
+
+struct XrfwCullSpheres : XrfwCullSoA<4>
+{
+  enum
+  {
+    CX,
+    CY,
+    CZ,
+    RADIUS,
+  };
+
+  void Push(const XrVector3f& center, float radius)
+  {
+    auto i = Add();
+    arrays[CX][i] = center.x;
+    arrays[CY][i] = center.y;
+    arrays[CZ][i] = center.z;
+    arrays[RADIUS][i] = radius;
+  }
+};
+
+// Appends the set bits of a lane group starting at first
+inline size_t
+xrfwCullAppendIndices(uint32_t bits,
+                      size_t first,
+                      uint32_t* visible,
+                      size_t visibleCount)
+{
+  while (bits) {
+    visible[visibleCount++] =
+      static_cast<uint32_t>(first + std::countr_zero(bits));
+    bits &= bits - 1;
+  }
+  return visibleCount;
+}
+
+// bits of the lanes in use from first
+inline uint32_t
+xrfwCullLaneBits(size_t count, size_t first)
+{
+  auto lanes = count - first;
+  return lanes >= XRFW_SIMD_WIDTH ? (1u << XRFW_SIMD_WIDTH) - 1
+                                  : (1u << lanes) - 1;
+}
+
+// a * x + b * y + c * z + d of a lane of points
+inline XrfwLane
+xrfwCullPlaneDistance(const float plane[4], XrfwLane x, XrfwLane y, XrfwLane z)
+{
+  return xrfwLaneAdd(xrfwLaneAdd(xrfwLaneMul(xrfwLaneSplat(plane[0]), x),
+                                 xrfwLaneMul(xrfwLaneSplat(plane[1]), y)),
+                     xrfwLaneAdd(xrfwLaneMul(xrfwLaneSplat(plane[2]), z),
+                                 xrfwLaneSplat(plane[3])));
+}
+
+// Writes the indices of the visible boxes to visible, which holds
+// boxes.count. Returns the visible count.
+inline size_t
+xrfwCullBoxes(const XrfwCullFrustum& frustum,
+              const XrfwCullBoxes& boxes,
+              uint32_t* visible)
+{
+  auto zero = xrfwLaneSplat(0.0f);
+  size_t visibleCount = 0;
+  auto& a = boxes.arrays;
+  for (size_t i = 0; i < boxes.count; i += XRFW_SIMD_WIDTH) {
+    auto cx = xrfwLaneLoadUnaligned(&a[XrfwCullBoxes::CX][i]);
+    auto cy = xrfwLaneLoadUnaligned(&a[XrfwCullBoxes::CY][i]);
+    auto cz = xrfwLaneLoadUnaligned(&a[XrfwCullBoxes::CZ][i]);
+    auto ex = xrfwLaneLoadUnaligned(&a[XrfwCullBoxes::EX][i]);
+    auto ey = xrfwLaneLoadUnaligned(&a[XrfwCullBoxes::EY][i]);
+    auto ez = xrfwLaneLoadUnaligned(&a[XrfwCullBoxes::EZ][i]);
+    XrfwLaneMask culled[2];
+    for (int eye = 0; eye < 2; ++eye) {
+      for (int p = 0; p < 6; ++p) {
+        auto plane = frustum.planes[eye][p];
+        // the center distance plus the extent projected to the normal
+        auto distance = xrfwCullPlaneDistance(plane, cx, cy, cz);
+        auto extent = xrfwLaneAdd(
+          xrfwLaneAdd(xrfwLaneMul(xrfwLaneSplat(fabsf(plane[0])), ex),
+                      xrfwLaneMul(xrfwLaneSplat(fabsf(plane[1])), ey)),
+          xrfwLaneMul(xrfwLaneSplat(fabsf(plane[2])), ez));
+        auto outside = xrfwLaneLess(xrfwLaneAdd(distance, extent), zero);
+        culled[eye] = p == 0 ? outside : xrfwLaneMaskOr(culled[eye], outside);
+      }
+    }
+    auto bits = ~xrfwLaneMaskBits(xrfwLaneMaskAnd(culled[0], culled[1])) &
+                xrfwCullLaneBits(boxes.count, i);
+    visibleCount = xrfwCullAppendIndices(bits, i, visible, visibleCount);
+  }
+  return visibleCount;
+}
+
+// Writes the indices of the visible spheres to visible, which holds
+// spheres.count. Returns the visible count.
+inline size_t
+xrfwCullSpheres(const XrfwCullFrustum& frustum,
+                const XrfwCullSpheres& spheres,
+                uint32_t* visible)
+{
+  auto zero = xrfwLaneSplat(0.0f);
+  size_t visibleCount = 0;
+  auto& a = spheres.arrays;
+  for (size_t i = 0; i < spheres.count; i += XRFW_SIMD_WIDTH) {
+    auto cx = xrfwLaneLoadUnaligned(&a[XrfwCullSpheres::CX][i]);
+    auto cy = xrfwLaneLoadUnaligned(&a[XrfwCullSpheres::CY][i]);
+    auto cz = xrfwLaneLoadUnaligned(&a[XrfwCullSpheres::CZ][i]);
+    auto radius = xrfwLaneLoadUnaligned(&a[XrfwCullSpheres::RADIUS][i]);
+    XrfwLaneMask culled[2];
+    for (int eye = 0; eye < 2; ++eye) {
+      for (int p = 0; p < 6; ++p) {
+        auto plane = frustum.planes[eye][p];
+        auto distance = xrfwCullPlaneDistance(plane, cx, cy, cz);
+        auto outside = xrfwLaneLess(xrfwLaneAdd(distance, radius), zero);
+        culled[eye] = p == 0 ? outside : xrfwLaneMaskOr(culled[eye], outside);
+      }
+    }
+    auto bits = ~xrfwLaneMaskBits(xrfwLaneMaskAnd(culled[0], culled[1])) &
+                xrfwCullLaneBits(spheres.count, i);
+    visibleCount = xrfwCullAppendIndices(bits, i, visible, visibleCount);
+  }
+  return visibleCount;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <openxr/openxr.h>
+#include <plog/Log.h>
+
+// The per frame calls. Resolved once through xrGetInstanceProcAddr, so the
+// frame loop calls the runtime without the loader's exported trampolines
+// (handle lookup and dispatch per call).
+#define XRFW_DISPATCH_FUNCTIONS(_)                                             \
+  _(xrPollEvent)                                                               \
+  _(xrWaitFrame)                                                               \
+  _(xrBeginFrame)                                                              \
+  _(xrLocateViews)                                                             \
+  _(xrLocateSpace)                                                             \
+  _(xrAcquireSwapchainImage)                                                   \
+  _(xrWaitSwapchainImage)                                                      \
+  _(xrReleaseSwapchainImage)                                                   \
+  _(xrEndFrame)
+
+struct XrfwDispatchTable
+{
+#define XRFW_DISPATCH_MEMBER(name) PFN_##name name = nullptr;
+  XRFW_DISPATCH_FUNCTIONS(XRFW_DISPATCH_MEMBER)
+#undef XRFW_DISPATCH_MEMBER
+
+  bool Initialize(XrInstance instance)
+  {
+    bool success = true;
+#define XRFW_DISPATCH_GET_PROC_ADDRESS(name)                                   \
+  if (XR_FAILED(                                                               \
+        xrGetInstanceProcAddr(instance, #name, (PFN_xrVoidFunction*)&name))) { \
+    PLOG_FATAL << "xrGetInstanceProcAddr: " #name;                             \
+    success = false;                                                           \
+  }
+    XRFW_DISPATCH_FUNCTIONS(XRFW_DISPATCH_GET_PROC_ADDRESS)
+#undef XRFW_DISPATCH_GET_PROC_ADDRESS
+    return success;
+  }
+};
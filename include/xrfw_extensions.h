@@ -0,0 +1,73 @@
+#pragma once
+#include <bitset>
+#include <iterator>
+#include <stdint.h>
+#include <string_view>
+
+// Instance extensions known to xrfw and the functions each one adds.
+// xrfwCreateInstance records the enabled ones in a XrfwExtensionSet, so
+// xrfwIsExtensionEnabled is a bit test instead of a name scan.
+#define XRFW_EXTENSIONS(_)                                                     \
+  _(EXT_hand_tracking)                                                         \
+  _(FB_body_tracking)                                                          \
+  _(FB_passthrough)                                                            \
+  _(FB_triangle_mesh)                                                          \
+  _(KHR_composition_layer_depth)                                               \
+  _(KHR_composition_layer_cylinder)                                            \
+  _(KHR_locate_spaces)                                                         \
+  _(VARJO_quad_views)
+
+// member lists for XRFW_PROC
+#define XRFW_EXT_HAND_TRACKING_FUNCTIONS(_)                                    \
+  _(xrCreateHandTrackerEXT)                                                    \
+  _(xrDestroyHandTrackerEXT)                                                   \
+  _(xrLocateHandJointsEXT)
+#define XRFW_FB_BODY_TRACKING_FUNCTIONS(_)                                     \
+  _(xrCreateBodyTrackerFB)                                                     \
+  _(xrDestroyBodyTrackerFB)                                                    \
+  _(xrLocateBodyJointsFB)                                                      \
+  _(xrGetBodySkeletonFB)
+#define XRFW_FB_PASSTHROUGH_FUNCTIONS(_)                                       \
+  _(xrCreatePassthroughFB)                                                     \
+  _(xrCreatePassthroughLayerFB)                                                \
+  _(xrPassthroughLayerSetStyleFB)
+
+enum class XrfwExtension : uint32_t
+{
+#define XRFW_EXTENSION_ENUM(name) name,
+  XRFW_EXTENSIONS(XRFW_EXTENSION_ENUM)
+#undef XRFW_EXTENSION_ENUM
+  Count,
+};
+
+inline constexpr std::string_view XRFW_EXTENSION_NAMES[] = {
+#define XRFW_EXTENSION_NAME(name) "XR_" #name,
+  XRFW_EXTENSIONS(XRFW_EXTENSION_NAME)
+#undef XRFW_EXTENSION_NAME
+};
+static_assert(std::size(XRFW_EXTENSION_NAMES) ==
+              static_cast<size_t>(XrfwExtension::Count));
+
+using XrfwExtensionSet = std::bitset<static_cast<size_t>(XrfwExtension::Count)>;
+
+constexpr std::string_view
+xrfwExtensionName(XrfwExtension extension)
+{
+  return XRFW_EXTENSION_NAMES[static_cast<size_t>(extension)];
+}
+
+// XrfwExtension::Count if xrfw does not know the name
+constexpr XrfwExtension
+xrfwFindExtension(std::string_view name)
+{
+  for (size_t i = 0; i < std::size(XRFW_EXTENSION_NAMES); ++i) {
+    if (XRFW_EXTENSION_NAMES[i] == name) {
+      return static_cast<XrfwExtension>(i);
+    }
+  }
+  return XrfwExtension::Count;
+}
+
+static_assert(xrfwFindExtension("XR_KHR_composition_layer_depth") ==
+              XrfwExtension::KHR_composition_layer_depth);
+static_assert(xrfwFindExtension("XR_KHR_unknown") == XrfwExtension::Count);
@@ -0,0 +1,197 @@
+#pragma once
+#include "xrfw.h"
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Fixed capacity blocking queue.
+// push blocks while full, pop blocks while empty. close wakes up both sides.
+template<typename T, size_t N>
+class XrfwBoundedQueue
+{
+  std::array<T, N> m_items;
+  size_t m_head = 0;
+  size_t m_size = 0;
+  bool m_closed = false;
+  std::mutex m_mutex;
+  std::condition_variable m_notFull;
+  std::condition_variable m_notEmpty;
+
+public:
+  bool Push(const T& item)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notFull.wait(lock, [this] { return m_closed || m_size < N; });
+    if (m_closed) {
+      return false;
+    }
+    m_items[(m_head + m_size) % N] = item;
+    ++m_size;
+    m_notEmpty.notify_one();
+    return true;
+  }
+
+  bool Pop(T* item)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notEmpty.wait(lock, [this] { return m_closed || m_size > 0; });
+    if (m_size == 0) {
+      return false;
+    }
+    *item = m_items[m_head];
+    m_head = (m_head + 1) % N;
+    --m_size;
+    m_notFull.notify_one();
+    return true;
+  }
+
+  void Close()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+    m_notFull.notify_all();
+    m_notEmpty.notify_all();
+  }
+
+  void Reset()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_head = 0;
+    m_size = 0;
+    m_closed = false;
+  }
+};
+
+// Result of xrWaitFrame + xrBeginFrame + xrLocateViews for one frame
+struct XrfwFrameTicket
+{
+  XrTime time = 0;
+  XrfwViewMatrices viewMatrix;
+  const XrCompositionLayerBaseHeader* projectionLayer = nullptr;
+};
+
+// Runs xrWaitFrame for frame N+1 on a dedicated thread while the render
+// thread is rendering frame N.
+//
+// xrBeginFrame of N+1 must follow xrEndFrame of N, so the pacing thread only
+// begins a frame when the render thread asks for the next ticket (Pop). That
+// also keeps xrBeginFrame out of xrfwPollEventsIsSessionActive, which may call
+// xrEndSession.
+class XrfwFramePacer
+{
+  XrfwBoundedQueue<XrfwFrameTicket, 1> m_tickets;
+  XrfwBoundedQueue<bool, 1> m_beginPermits;
+  std::thread m_thread;
+
+  // context: the session of the thread that started the pacer
+  void Run(XrfwContext* context)
+  {
+    xrfwMakeContextCurrent(context);
+    for (;;) {
+      XrFrameState frameState;
+      if (!xrfwWaitFrame(&frameState)) {
+        break;
+      }
+      bool permit;
+      if (!m_beginPermits.Pop(&permit)) {
+        break;
+      }
+      XrfwFrameTicket ticket;
+      ticket.projectionLayer = xrfwBeginFrameWithState(
+        &frameState, &ticket.time, &ticket.viewMatrix);
+      if (!m_tickets.Push(ticket)) {
+        break;
+      }
+    }
+    m_tickets.Close();
+    xrfwMakeContextCurrent(nullptr);
+  }
+
+public:
+  ~XrfwFramePacer() { Stop(); }
+
+  bool IsRunning() const { return m_thread.joinable(); }
+
+  void Start()
+  {
+    if (IsRunning()) {
+      return;
+    }
+    m_tickets.Reset();
+    m_beginPermits.Reset();
+    m_thread =
+      std::thread([this, context = xrfwGetCurrentContext()] { Run(context); });
+  }
+
+  void Stop()
+  {
+    if (!IsRunning()) {
+      return;
+    }
+    m_beginPermits.Close();
+    m_tickets.Close();
+    m_thread.join();
+  }
+
+  // allow the pacing thread to begin the next frame and wait for it
+  bool Pop(XrfwFrameTicket* ticket)
+  {
+    if (!m_beginPermits.Push(true)) {
+      return false;
+    }
+    return m_tickets.Pop(ticket);
+  }
+};
+
+// Same as xrfwSession, but overlaps xrWaitFrame with rendering.
+// RenderFunc is still called on the calling thread.
+template<typename T, typename F>
+inline int
+xrfwSessionPipelined(T& platform,
+                     F render,
+                     void* user,
+                     SessionBeginFunc begin = nullptr,
+                     SessionEndFunc end = nullptr)
+{
+  // session and swapchains from graphics
+  XrfwSwapchains swapchains = {};
+  auto session = platform.CreateSession(&swapchains);
+  if (!session) {
+    return 3;
+  }
+
+  XrfwFramePacer pacer;
+  XrfwIdleBackoff backoff;
+  while (platform.BeginFrame()) {
+
+    // OpenXR handling
+    if (xrfwPollEventsIsSessionActive(begin, end, user)) {
+      pacer.Start();
+      XrfwFrameTicket ticket;
+      if (pacer.Pop(&ticket)) {
+        xrfwRenderFrame(swapchains,
+                        ticket.time,
+                        ticket.viewMatrix,
+                        ticket.projectionLayer,
+                        render,
+                        user);
+      } else {
+        // xrWaitFrame failed. back off before the pacer restarts, a
+        // persistent failure would spin up a thread per frame
+        pacer.Stop();
+        platform.WaitEvent(backoff.Next());
+      }
+    } else {
+      // XrSession is not active
+      pacer.Stop();
+      platform.WaitEvent(backoff.Next());
+    }
+
+    xrfwPlatformEndFrame(platform, render, user);
+  }
+
+  pacer.Stop();
+  xrfwDestroySession(session);
+  return 0;
+}
@@ -1,15 +1,55 @@
 #pragma once
 #include <openxr/openxr.h>
+#include <stdint.h>
+
+#define XRFW_INVALID_SWAPCHAIN_SLOT UINT32_MAX
+#define XRFW_INVALID_LAYER UINT32_MAX
+// projection layer, RenderFunc layer and xrfwCreateLayer layers. also capped
+// by XrSystemGraphicsProperties::maxLayerCount
+#define XRFW_MAX_LAYER_COUNT 16
+// mono 1, stereo 2, quad views (stereo + foveated insets) 4
+#define XRFW_MAX_VIEW_COUNT 4
+
+struct XrfwSwapchainView
+{
+  XrSwapchain swapchain = nullptr;
+  uint32_t slot = XRFW_INVALID_SWAPCHAIN_SLOT;
+  // VPRT views share the swapchain
+  uint32_t imageArrayIndex = 0;
+  int width = 0;
+  int height = 0;
+  // XR_KHR_composition_layer_depth. acquired and released with the color
+  // swapchain. nullptr if the platform or the runtime has no depth.
+  XrSwapchain depthSwapchain = nullptr;
+  uint32_t depthSlot = XRFW_INVALID_SWAPCHAIN_SLOT;
+};
 
 struct XrfwSwapchains
 {
   XrSwapchain leftOrVrpt = nullptr;
   XrSwapchain right = nullptr;
   uint64_t format = 0;
+  // 0 without depth swapchains
+  uint64_t depthFormat = 0;
   int width = 0;
   int height = 0;
+  // xrfwAcquireSwapchainSlot / xrfwReleaseSwapchainSlot
+  uint32_t leftOrVrptSlot = XRFW_INVALID_SWAPCHAIN_SLOT;
+  uint32_t rightSlot = XRFW_INVALID_SWAPCHAIN_SLOT;
+  // all views of the view configuration. views[0], views[1] are the
+  // leftOrVrpt, right above. QUAD_VARJO views[2], views[3] are the left and
+  // right foveated insets.
+  XrViewConfigurationType viewConfigurationType =
+    XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+  uint32_t viewCount = 0;
+  XrfwSwapchainView views[XRFW_MAX_VIEW_COUNT];
+  // view index of views[0]. 2 while a RenderFunc renders the QUAD_VARJO
+  // insets (XrfwStereoPairRender)
+  uint32_t firstView = 0;
 };
 
+// depth images: xrfwGetDepthSwapchainImage(info.firstView),
+// xrfwGetDepthSwapchainImage(info.firstView + 1)
 using RenderFunc =
   const XrCompositionLayerBaseHeader* (*)(XrTime time,
                                           const XrSwapchainImageBaseHeader*
@@ -23,6 +63,33 @@ using RenderFunc =
                                           const float rightView[16],
                                           void* user);
 
+// acquired image and matrices of one view
+struct XrfwViewImage
+{
+  const XrSwapchainImageBaseHeader* swapchainImage;
+  // nullptr without depth swapchains
+  const XrSwapchainImageBaseHeader* depthSwapchainImage;
+  const XrfwSwapchainView* swapchain;
+  const float* projection;
+  const float* view;
+};
+
+// RenderFunc for any view configuration. images[viewCount]
+using RenderViewsFunc =
+  const XrCompositionLayerBaseHeader* (*)(XrTime time,
+                                          uint32_t viewCount,
+                                          const XrfwViewImage* images,
+                                          const XrfwSwapchains& info,
+                                          void* user);
+
+// draw the content of a xrfwCreateLayer layer. called with the acquired image
+// while the layer is dirty.
+using XrfwLayerRenderFunc =
+  void (*)(const XrSwapchainImageBaseHeader* swapchainImage,
+           int width,
+           int height,
+           void* user);
+
 using SessionBeginFunc = void (*)(XrSession session, void* user);
 
 using SessionEndFunc = void (*)(XrSession session, void* user);
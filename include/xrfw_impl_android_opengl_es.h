@@ -13,5 +13,6 @@ struct XrfwPlatformAndroidOpenGLES {
   bool BeginFrame();
   void EndFrame(RenderFunc render, void *user);
   uint32_t CastTexture(const XrSwapchainImageBaseHeader *swapchainImage);
-  void Sleep(std::chrono::milliseconds ms);
+  // blocks until an android_app command or the timeout
+  void WaitEvent(std::chrono::milliseconds timeout);
 };
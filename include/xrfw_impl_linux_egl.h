@@ -0,0 +1,24 @@
+#pragma once
+
+#include "xrfw_func.h"
+#include <chrono>
+
+// Headless. EGL pbuffer context bound with XR_MNDX_egl_enable.
+struct XrfwPlatformLinuxEGL
+{
+  struct PlatformLinuxEGLImpl* impl_ = nullptr;
+  XrfwPlatformLinuxEGL(struct android_app* state = nullptr);
+  ~XrfwPlatformLinuxEGL();
+  bool InitializeLoader();
+  XrInstance CreateInstance();
+  bool InitializeGraphics();
+  XrSession CreateSession(struct XrfwSwapchains* swapchains);
+  bool BeginFrame();
+  void EndFrame(RenderFunc render, void* user);
+  uint32_t CastTexture(const XrSwapchainImageBaseHeader* swapchainImage);
+  // blocks until a platform event or the timeout
+  void WaitEvent(std::chrono::milliseconds timeout);
+  // there is no window to close. BeginFrame returns false after this.
+  // thread safe, wakes up WaitEvent.
+  void RequestExit();
+};
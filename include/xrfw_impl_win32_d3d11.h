@@ -17,5 +17,6 @@ struct XrfwPlatformWin32D3D11
   XrSession CreateSession(struct XrfwSwapchains* swapchains);
   bool BeginFrame();
   void EndFrame(RenderFunc render, void* user);
-  void Sleep(std::chrono::milliseconds ms);
+  // blocks until a platform event or the timeout
+  void WaitEvent(std::chrono::milliseconds timeout);
 };
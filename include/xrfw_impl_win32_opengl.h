@@ -15,5 +15,6 @@ struct XrfwPlatformWin32OpenGL
   bool BeginFrame();
   void EndFrame(RenderFunc render, void* user);
   uint32_t CastTexture(const XrSwapchainImageBaseHeader* swapchainImage);
-  void Sleep(std::chrono::milliseconds ms);
+  // blocks until a platform event or the timeout
+  void WaitEvent(std::chrono::milliseconds timeout);
 };
@@ -0,0 +1,111 @@
+#pragma once
+#ifdef XR_USE_PLATFORM_ANDROID
+#include <EGL/egl.h>
+#include <GLES3/gl32.h>
+// after gl32.h, which defines GL_APIENTRYP
+#include <GLES2/gl2ext.h>
+#elif XR_USE_PLATFORM_WIN32
+#include <GL/glew.h>
+#elif XR_USE_PLATFORM_EGL
+#include <EGL/egl.h>
+#include <GLES3/gl32.h>
+// after gl32.h, which defines GL_APIENTRYP
+#include <GLES2/gl2ext.h>
+#else
+error("no XR_USE")
+#endif
+#include <stdint.h>
+#include <string.h>
+#include <xrfw.h>
+
+// Persistently mapped uniform block holding XrfwViewMatrices (std140, 128
+// bytes per view). Bind() publishes the xrfwBeginFrame matrices for the frame
+// being rendered, and the late latch callback overwrites them just before
+// xrEndFrame. GPU work that has not run yet reads the fresher view.
+//
+//   struct XrfwViewMatrix { mat4 projection; mat4 view; };
+//   layout(std140) uniform XrfwViewMatrices {
+//     XrfwViewMatrix views[4]; // 0: left, 1: right, 2, 3: foveated insets
+//   };
+class XrfwLateLatchUbo {
+  // frames in flight. a slot is not overwritten while the GPU may read it.
+  static const uint32_t SLOT_COUNT = 3;
+  uint32_t m_buffer{0};
+  uint8_t *m_mapped{nullptr};
+  uint32_t m_slotSize{0};
+  uint32_t m_frame{0};
+
+public:
+  XrfwLateLatchUbo() {
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    m_slotSize = sizeof(XrfwViewMatrices);
+    if (alignment > 0) {
+      m_slotSize = (m_slotSize + alignment - 1) / alignment * alignment;
+    }
+
+#if XR_USE_PLATFORM_WIN32
+    const GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+#else
+    const GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT_EXT | GL_MAP_COHERENT_BIT_EXT;
+#endif
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+#if XR_USE_PLATFORM_WIN32
+    glBufferStorage(GL_UNIFORM_BUFFER, m_slotSize * SLOT_COUNT, nullptr,
+                    flags);
+#else
+    // GL_EXT_buffer_storage
+    auto glBufferStorageEXT = (PFNGLBUFFERSTORAGEEXTPROC)eglGetProcAddress(
+        "glBufferStorageEXT");
+    glBufferStorageEXT(GL_UNIFORM_BUFFER, m_slotSize * SLOT_COUNT, nullptr,
+                       flags);
+#endif
+    m_mapped = (uint8_t *)glMapBufferRange(GL_UNIFORM_BUFFER, 0,
+                                           m_slotSize * SLOT_COUNT, flags);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    xrfwSetLateLatch(true, &XrfwLateLatchUbo::OnLateLatch, this);
+  }
+  ~XrfwLateLatchUbo() {
+    xrfwSetLateLatch(false);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glDeleteBuffers(1, &m_buffer);
+  }
+
+  // call once per frame in RenderFunc before drawing
+  void Bind(uint32_t bindingPoint, const float projection[16],
+            const float view[16], const float rightProjection[16],
+            const float rightView[16]) {
+    m_frame = (m_frame + 1) % SLOT_COUNT;
+    auto dst = (XrfwViewMatrices *)(m_mapped + m_slotSize * m_frame);
+    memcpy(dst->views[0].projection, projection, sizeof(float) * 16);
+    memcpy(dst->views[0].view, view, sizeof(float) * 16);
+    if (rightProjection) {
+      memcpy(dst->views[1].projection, rightProjection, sizeof(float) * 16);
+      memcpy(dst->views[1].view, rightView, sizeof(float) * 16);
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, m_buffer,
+                      m_slotSize * m_frame, sizeof(XrfwViewMatrices));
+  }
+
+  // RenderViewsFunc. all views at once
+  void Bind(uint32_t bindingPoint, const XrfwViewMatrices &viewMatrices) {
+    m_frame = (m_frame + 1) % SLOT_COUNT;
+    memcpy(m_mapped + m_slotSize * m_frame, &viewMatrices,
+           sizeof(XrfwViewMatrices));
+    glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, m_buffer,
+                      m_slotSize * m_frame, sizeof(XrfwViewMatrices));
+  }
+
+private:
+  static void OnLateLatch(const XrfwViewMatrices &viewMatrix, void *user) {
+    auto self = (XrfwLateLatchUbo *)user;
+    memcpy(self->m_mapped + self->m_slotSize * self->m_frame, &viewMatrix,
+           sizeof(XrfwViewMatrices));
+  }
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include "xrfw.h"
+#include <EGL/egl.h>
+
+#include <openxr/openxr_platform.h>
+
+#ifdef XR_USE_GRAPHICS_API_OPENGL_ES
+XRFW_API void xrfwInitExtensionsLinuxEGL(
+    XrGraphicsRequirementsOpenGLESKHR *graphicsRequirements);
+XRFW_API XrSession xrfwCreateSessionLinuxEGL(XrfwSwapchains *swapchains,
+                                             EGLDisplay display,
+                                             EGLConfig config,
+                                             EGLContext context);
+XRFW_API uint32_t
+xrfwCastTextureLinuxEGL(const XrSwapchainImageBaseHeader *swapchainImage);
+#endif
@@ -0,0 +1,346 @@
+#pragma once
+#include "xrfw_simd.h"
+#include <openxr/openxr.h>
+#include <span>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Poses of a joint array as structure of arrays, converted a lane of joints
+// at a time (xrfw_simd.h) instead of a matrix call chain per joint.
+//
+//   XrfwPoseBatch<XR_HAND_JOINT_COUNT_EXT * 2> hands;
+//   hands.Clear();
+//   // scale is the joint diameter
+//   hands.Append(trackerL->Update(time, space), 2.0f);
+//   hands.Append(trackerR->Update(time, space), 2.0f);
+//   instances.resize(hands.count);
+//   hands.StoreMatrix4x4(&instances[0].Matrix, sizeof(cuber::Instance));
+//
+// A matrix is translation * rotation * scale, column major with column
+// vectors. That is the memory layout of XrMatrix4x4f and of a row vector
+// DirectX::XMFLOAT4X4 (s * r * t). The scale is per axis, Compose and Invert
+// are exact for a uniform scale. Orientations must be normalized.
+template<size_t N>
+struct XrfwPoseBatch
+{
+  static constexpr size_t CAPACITY = xrfwLaneCeil(N);
+
+  alignas(32) float px[CAPACITY] = {};
+  alignas(32) float py[CAPACITY] = {};
+  alignas(32) float pz[CAPACITY] = {};
+  alignas(32) float qx[CAPACITY] = {};
+  alignas(32) float qy[CAPACITY] = {};
+  alignas(32) float qz[CAPACITY] = {};
+  alignas(32) float qw[CAPACITY] = {};
+  alignas(32) float sx[CAPACITY] = {};
+  alignas(32) float sy[CAPACITY] = {};
+  alignas(32) float sz[CAPACITY] = {};
+  // copied from the joint locations. not used by the math
+  XrSpaceLocationFlags flags[CAPACITY] = {};
+  size_t count = 0;
+
+  void Clear() { count = 0; }
+
+  // joints over the capacity are dropped
+  void Push(const XrPosef& pose,
+            float scale = 1.0f,
+            XrSpaceLocationFlags locationFlags =
+              XR_SPACE_LOCATION_ORIENTATION_VALID_BIT |
+              XR_SPACE_LOCATION_POSITION_VALID_BIT)
+  {
+    if (count >= N) {
+      return;
+    }
+    auto i = count++;
+    px[i] = pose.position.x;
+    py[i] = pose.position.y;
+    pz[i] = pose.position.z;
+    qx[i] = pose.orientation.x;
+    qy[i] = pose.orientation.y;
+    qz[i] = pose.orientation.z;
+    qw[i] = pose.orientation.w;
+    sx[i] = scale;
+    sy[i] = scale;
+    sz[i] = scale;
+    flags[i] = locationFlags;
+  }
+
+  // scale = radius * radiusScale
+  void Append(std::span<const XrHandJointLocationEXT> joints,
+              float radiusScale = 1.0f)
+  {
+    for (auto& joint : joints) {
+      Push(joint.pose, joint.radius * radiusScale, joint.locationFlags);
+    }
+  }
+
+  void Append(std::span<const XrBodyJointLocationFB> joints,
+              float scale = 1.0f)
+  {
+    for (auto& joint : joints) {
+      Push(joint.pose, scale, joint.locationFlags);
+    }
+  }
+
+  void Append(std::span<const XrBodySkeletonJointFB> joints,
+              float scale = 1.0f)
+  {
+    for (auto& joint : joints) {
+      Push(joint.pose, scale);
+    }
+  }
+
+  void Append(std::span<const XrPosef> poses, float scale = 1.0f)
+  {
+    for (auto& pose : poses) {
+      Push(pose, scale);
+    }
+  }
+
+  XrPosef Pose(size_t i) const
+  {
+    return { { qx[i], qy[i], qz[i], qw[i] }, { px[i], py[i], pz[i] } };
+  }
+
+  // this[i] = parent * child[i]. child may be this
+  void Compose(const XrPosef& parent, const XrfwPoseBatch& child)
+  {
+    Lanes a{
+      .px = xrfwLaneSplat(parent.position.x),
+      .py = xrfwLaneSplat(parent.position.y),
+      .pz = xrfwLaneSplat(parent.position.z),
+      .qx = xrfwLaneSplat(parent.orientation.x),
+      .qy = xrfwLaneSplat(parent.orientation.y),
+      .qz = xrfwLaneSplat(parent.orientation.z),
+      .qw = xrfwLaneSplat(parent.orientation.w),
+      .sx = xrfwLaneSplat(1.0f),
+      .sy = xrfwLaneSplat(1.0f),
+      .sz = xrfwLaneSplat(1.0f),
+    };
+    for (size_t i = 0; i < child.count; i += XRFW_SIMD_WIDTH) {
+      StoreLanes(i, ComposeLanes(a, child.LoadLanes(i)));
+    }
+    CopyFlags(child, child.count);
+  }
+
+  // this[i] = parent[i] * child[i]. parent or child may be this. The count is
+  // the smaller one, the lanes past a count are stale
+  void Compose(const XrfwPoseBatch& parent, const XrfwPoseBatch& child)
+  {
+    auto n = parent.count < child.count ? parent.count : child.count;
+    for (size_t i = 0; i < n; i += XRFW_SIMD_WIDTH) {
+      StoreLanes(i, ComposeLanes(parent.LoadLanes(i), child.LoadLanes(i)));
+    }
+    CopyFlags(child, n);
+  }
+
+  // this[i] = inverse(src[i]). src may be this
+  void Invert(const XrfwPoseBatch& src)
+  {
+    auto one = xrfwLaneSplat(1.0f);
+    for (size_t i = 0; i < src.count; i += XRFW_SIMD_WIDTH) {
+      auto s = src.LoadLanes(i);
+      Lanes r;
+      r.qx = xrfwLaneSub(xrfwLaneSplat(0.0f), s.qx);
+      r.qy = xrfwLaneSub(xrfwLaneSplat(0.0f), s.qy);
+      r.qz = xrfwLaneSub(xrfwLaneSplat(0.0f), s.qz);
+      r.qw = s.qw;
+      r.sx = xrfwLaneDiv(one, s.sx);
+      r.sy = xrfwLaneDiv(one, s.sy);
+      r.sz = xrfwLaneDiv(one, s.sz);
+      // -(S^-1 * R^-1 * p)
+      Rotate(r, &s.px, &s.py, &s.pz);
+      r.px = xrfwLaneSub(xrfwLaneSplat(0.0f), xrfwLaneMul(s.px, r.sx));
+      r.py = xrfwLaneSub(xrfwLaneSplat(0.0f), xrfwLaneMul(s.py, r.sy));
+      r.pz = xrfwLaneSub(xrfwLaneSplat(0.0f), xrfwLaneMul(s.pz, r.sz));
+      StoreLanes(i, r);
+    }
+    CopyFlags(src, src.count);
+  }
+
+  // dst is the matrix of the first joint, stride the bytes to the next one
+  void StoreMatrix4x4(void* dst, size_t stride = 16 * sizeof(float)) const
+  {
+    StoreMatrices(dst, stride, false);
+  }
+
+  // the upper three rows, row major. a float3x4 of HLSL
+  void StoreMatrix3x4(void* dst, size_t stride = 12 * sizeof(float)) const
+  {
+    StoreMatrices(dst, stride, true);
+  }
+
+private:
+  struct Lanes
+  {
+    XrfwLane px, py, pz;
+    XrfwLane qx, qy, qz, qw;
+    XrfwLane sx, sy, sz;
+  };
+
+  Lanes LoadLanes(size_t i) const
+  {
+    return {
+      .px = xrfwLaneLoad(px + i),
+      .py = xrfwLaneLoad(py + i),
+      .pz = xrfwLaneLoad(pz + i),
+      .qx = xrfwLaneLoad(qx + i),
+      .qy = xrfwLaneLoad(qy + i),
+      .qz = xrfwLaneLoad(qz + i),
+      .qw = xrfwLaneLoad(qw + i),
+      .sx = xrfwLaneLoad(sx + i),
+      .sy = xrfwLaneLoad(sy + i),
+      .sz = xrfwLaneLoad(sz + i),
+    };
+  }
+
+  void StoreLanes(size_t i, const Lanes& l)
+  {
+    xrfwLaneStore(px + i, l.px);
+    xrfwLaneStore(py + i, l.py);
+    xrfwLaneStore(pz + i, l.pz);
+    xrfwLaneStore(qx + i, l.qx);
+    xrfwLaneStore(qy + i, l.qy);
+    xrfwLaneStore(qz + i, l.qz);
+    xrfwLaneStore(qw + i, l.qw);
+    xrfwLaneStore(sx + i, l.sx);
+    xrfwLaneStore(sy + i, l.sy);
+    xrfwLaneStore(sz + i, l.sz);
+  }
+
+  // the first n of src
+  void CopyFlags(const XrfwPoseBatch& src, size_t n)
+  {
+    if (&src != this) {
+      memcpy(flags, src.flags, n * sizeof(flags[0]));
+    }
+    count = n;
+  }
+
+  // v = q * v * conj(q)
+  static void Rotate(const Lanes& q, XrfwLane* x, XrfwLane* y, XrfwLane* z)
+  {
+    // t = 2 * cross(q.xyz, v)
+    auto tx = xrfwLaneSub(xrfwLaneMul(q.qy, *z), xrfwLaneMul(q.qz, *y));
+    auto ty = xrfwLaneSub(xrfwLaneMul(q.qz, *x), xrfwLaneMul(q.qx, *z));
+    auto tz = xrfwLaneSub(xrfwLaneMul(q.qx, *y), xrfwLaneMul(q.qy, *x));
+    tx = xrfwLaneAdd(tx, tx);
+    ty = xrfwLaneAdd(ty, ty);
+    tz = xrfwLaneAdd(tz, tz);
+    // v + w * t + cross(q.xyz, t)
+    *x = xrfwLaneAdd(
+      xrfwLaneAdd(*x, xrfwLaneMul(q.qw, tx)),
+      xrfwLaneSub(xrfwLaneMul(q.qy, tz), xrfwLaneMul(q.qz, ty)));
+    *y = xrfwLaneAdd(
+      xrfwLaneAdd(*y, xrfwLaneMul(q.qw, ty)),
+      xrfwLaneSub(xrfwLaneMul(q.qz, tx), xrfwLaneMul(q.qx, tz)));
+    *z = xrfwLaneAdd(
+      xrfwLaneAdd(*z, xrfwLaneMul(q.qw, tz)),
+      xrfwLaneSub(xrfwLaneMul(q.qx, ty), xrfwLaneMul(q.qy, tx)));
+  }
+
+  static Lanes ComposeLanes(const Lanes& a, const Lanes& b)
+  {
+    Lanes r;
+    // a.q * b.q
+    r.qw = xrfwLaneSub(
+      xrfwLaneSub(xrfwLaneMul(a.qw, b.qw), xrfwLaneMul(a.qx, b.qx)),
+      xrfwLaneAdd(xrfwLaneMul(a.qy, b.qy), xrfwLaneMul(a.qz, b.qz)));
+    r.qx = xrfwLaneAdd(
+      xrfwLaneAdd(xrfwLaneMul(a.qw, b.qx), xrfwLaneMul(a.qx, b.qw)),
+      xrfwLaneSub(xrfwLaneMul(a.qy, b.qz), xrfwLaneMul(a.qz, b.qy)));
+    r.qy = xrfwLaneAdd(
+      xrfwLaneSub(xrfwLaneMul(a.qw, b.qy), xrfwLaneMul(a.qx, b.qz)),
+      xrfwLaneAdd(xrfwLaneMul(a.qy, b.qw), xrfwLaneMul(a.qz, b.qx)));
+    r.qz = xrfwLaneAdd(
+      xrfwLaneSub(xrfwLaneMul(a.qw, b.qz), xrfwLaneMul(a.qy, b.qx)),
+      xrfwLaneAdd(xrfwLaneMul(a.qx, b.qy), xrfwLaneMul(a.qz, b.qw)));
+    // a.p + a.q * (a.s * b.p)
+    r.px = xrfwLaneMul(a.sx, b.px);
+    r.py = xrfwLaneMul(a.sy, b.py);
+    r.pz = xrfwLaneMul(a.sz, b.pz);
+    Rotate(a, &r.px, &r.py, &r.pz);
+    r.px = xrfwLaneAdd(a.px, r.px);
+    r.py = xrfwLaneAdd(a.py, r.py);
+    r.pz = xrfwLaneAdd(a.pz, r.pz);
+    r.sx = xrfwLaneMul(a.sx, b.sx);
+    r.sy = xrfwLaneMul(a.sy, b.sy);
+    r.sz = xrfwLaneMul(a.sz, b.sz);
+    return r;
+  }
+
+  void StoreMatrices(void* dst, size_t stride, bool rows3x4) const
+  {
+    auto one = xrfwLaneSplat(1.0f);
+    auto out = static_cast<uint8_t*>(dst);
+    for (size_t i = 0; i < count; i += XRFW_SIMD_WIDTH) {
+      auto l = LoadLanes(i);
+      auto x2 = xrfwLaneAdd(l.qx, l.qx);
+      auto y2 = xrfwLaneAdd(l.qy, l.qy);
+      auto z2 = xrfwLaneAdd(l.qz, l.qz);
+      auto xx2 = xrfwLaneMul(l.qx, x2);
+      auto yy2 = xrfwLaneMul(l.qy, y2);
+      auto zz2 = xrfwLaneMul(l.qz, z2);
+      auto yz2 = xrfwLaneMul(l.qy, z2);
+      auto wx2 = xrfwLaneMul(l.qw, x2);
+      auto xy2 = xrfwLaneMul(l.qx, y2);
+      auto wz2 = xrfwLaneMul(l.qw, z2);
+      auto xz2 = xrfwLaneMul(l.qx, z2);
+      auto wy2 = xrfwLaneMul(l.qw, y2);
+
+      // column major elements of the lanes. the same as
+      // XrMatrix4x4f_CreateFromQuaternion, the columns scaled
+      alignas(32) float m[12][XRFW_SIMD_WIDTH];
+      auto store = [&m](int e, XrfwLane v) { xrfwLaneStore(m[e], v); };
+      store(0, xrfwLaneMul(xrfwLaneSub(xrfwLaneSub(one, yy2), zz2), l.sx));
+      store(1, xrfwLaneMul(xrfwLaneAdd(xy2, wz2), l.sx));
+      store(2, xrfwLaneMul(xrfwLaneSub(xz2, wy2), l.sx));
+      store(3, xrfwLaneMul(xrfwLaneSub(xy2, wz2), l.sy));
+      store(4, xrfwLaneMul(xrfwLaneSub(xrfwLaneSub(one, xx2), zz2), l.sy));
+      store(5, xrfwLaneMul(xrfwLaneAdd(yz2, wx2), l.sy));
+      store(6, xrfwLaneMul(xrfwLaneAdd(xz2, wy2), l.sz));
+      store(7, xrfwLaneMul(xrfwLaneSub(yz2, wx2), l.sz));
+      store(8, xrfwLaneMul(xrfwLaneSub(xrfwLaneSub(one, xx2), yy2), l.sz));
+      store(9, l.px);
+      store(10, l.py);
+      store(11, l.pz);
+
+      auto lanes = count - i < XRFW_SIMD_WIDTH ? count - i : XRFW_SIMD_WIDTH;
+      for (size_t j = 0; j < lanes; ++j, out += stride) {
+        auto f = reinterpret_cast<float*>(out);
+        if (rows3x4) {
+          f[0] = m[0][j];
+          f[1] = m[3][j];
+          f[2] = m[6][j];
+          f[3] = m[9][j];
+          f[4] = m[1][j];
+          f[5] = m[4][j];
+          f[6] = m[7][j];
+          f[7] = m[10][j];
+          f[8] = m[2][j];
+          f[9] = m[5][j];
+          f[10] = m[8][j];
+          f[11] = m[11][j];
+        } else {
+          f[0] = m[0][j];
+          f[1] = m[1][j];
+          f[2] = m[2][j];
+          f[3] = 0.0f;
+          f[4] = m[3][j];
+          f[5] = m[4][j];
+          f[6] = m[5][j];
+          f[7] = 0.0f;
+          f[8] = m[6][j];
+          f[9] = m[7][j];
+          f[10] = m[8][j];
+          f[11] = 0.0f;
+          f[12] = m[9][j];
+          f[13] = m[10][j];
+          f[14] = m[11][j];
+          f[15] = 1.0f;
+        }
+      }
+    }
+  }
+};
@@ -1,7 +1,10 @@
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <openxr/openxr.h>
 #include <plog/Log.h>
+#include <utility>
+#include <xrfw.h>
 
 template<size_t N>
 struct XrFwStringLiteral
@@ -13,21 +16,36 @@ struct XrFwStringLiteral
   char value[N];
 };
 
+// Resolved by the first call against xrfwGetInstance() and cached, so
+// constructing a wrapper costs no xrGetInstanceProcAddr and an unused
+// function is never looked up.
 template<typename PFN, XrFwStringLiteral NAME>
 struct XrFwInstanceProc
 {
-  PFN Proc = nullptr;
-  XrFwInstanceProc(XrInstance instance)
+  mutable std::atomic<PFN> Proc = nullptr;
+
+  PFN Get() const
   {
-    if (XR_FAILED(xrGetInstanceProcAddr(
-          instance, NAME.value, (PFN_xrVoidFunction*)&Proc))) {
-      PLOG_ERROR << "xrGetInstanceProcAddr: " << (const char*)NAME.value;
+    auto proc = Proc.load(std::memory_order_relaxed);
+    if (!proc) {
+      if (XR_FAILED(xrGetInstanceProcAddr(
+            xrfwGetInstance(), NAME.value, (PFN_xrVoidFunction*)&proc))) {
+        PLOG_ERROR << "xrGetInstanceProcAddr: " << (const char*)NAME.value;
+        return nullptr;
+      }
+      Proc.store(proc, std::memory_order_relaxed);
     }
+    return proc;
   }
+
   template<typename... ARGS>
-  auto operator()(ARGS... args) const
+  XrResult operator()(ARGS&&... args) const
   {
-    return Proc(args...);
+    auto proc = Get();
+    if (!proc) {
+      return XR_ERROR_FUNCTION_UNSUPPORTED;
+    }
+    return proc(std::forward<ARGS>(args)...);
   }
 };
 
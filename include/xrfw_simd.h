@@ -0,0 +1,299 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Lanes of floats for the batch math over structure of arrays
+// (xrfw_pose_batch.h, xrfw_cull.h). A loop handles XRFW_SIMD_WIDTH elements
+// per iteration: 8 with AVX, 4 with SSE2 or NEON, 1 otherwise. Arrays are
+// padded to whole lanes. xrfwLaneLoad needs 32 byte alignment. A comparison
+// gives a XrfwLaneMask, xrfwLaneMaskBits packs it to one bit per lane.
+// XRFW_NO_SIMD selects the scalar lane.
+#if !defined(XRFW_NO_SIMD) && defined(__AVX__)
+#include <immintrin.h>
+#define XRFW_SIMD_WIDTH 8
+using XrfwLane = __m256;
+
+inline XrfwLane
+xrfwLaneLoad(const float* p)
+{
+  return _mm256_load_ps(p);
+}
+inline void
+xrfwLaneStore(float* p, XrfwLane v)
+{
+  _mm256_store_ps(p, v);
+}
+inline XrfwLane
+xrfwLaneSplat(float v)
+{
+  return _mm256_set1_ps(v);
+}
+inline XrfwLane
+xrfwLaneAdd(XrfwLane a, XrfwLane b)
+{
+  return _mm256_add_ps(a, b);
+}
+inline XrfwLane
+xrfwLaneSub(XrfwLane a, XrfwLane b)
+{
+  return _mm256_sub_ps(a, b);
+}
+inline XrfwLane
+xrfwLaneMul(XrfwLane a, XrfwLane b)
+{
+  return _mm256_mul_ps(a, b);
+}
+inline XrfwLane
+xrfwLaneDiv(XrfwLane a, XrfwLane b)
+{
+  return _mm256_div_ps(a, b);
+}
+inline XrfwLane
+xrfwLaneLoadUnaligned(const float* p)
+{
+  return _mm256_loadu_ps(p);
+}
+using XrfwLaneMask = __m256;
+inline XrfwLaneMask
+xrfwLaneLess(XrfwLane a, XrfwLane b)
+{
+  return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+}
+inline XrfwLaneMask
+xrfwLaneMaskOr(XrfwLaneMask a, XrfwLaneMask b)
+{
+  return _mm256_or_ps(a, b);
+}
+inline XrfwLaneMask
+xrfwLaneMaskAnd(XrfwLaneMask a, XrfwLaneMask b)
+{
+  return _mm256_and_ps(a, b);
+}
+inline uint32_t
+xrfwLaneMaskBits(XrfwLaneMask m)
+{
+  return static_cast<uint32_t>(_mm256_movemask_ps(m));
+}
+#elif !defined(XRFW_NO_SIMD) &&                                                \
+  (defined(__SSE2__) || defined(_M_X64) ||                                     \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define XRFW_SIMD_WIDTH 4
+using XrfwLane = __m128;
+
+inline XrfwLane
+xrfwLaneLoad(const float* p)
+{
+  return _mm_load_ps(p);
+}
+inline void
+xrfwLaneStore(float* p, XrfwLane v)
+{
+  _mm_store_ps(p, v);
+}
+inline XrfwLane
+xrfwLaneSplat(float v)
+{
+  return _mm_set1_ps(v);
+}
+inline XrfwLane
+xrfwLaneAdd(XrfwLane a, XrfwLane b)
+{
+  return _mm_add_ps(a, b);
+}
+inline XrfwLane
+xrfwLaneSub(XrfwLane a, XrfwLane b)
+{
+  return _mm_sub_ps(a, b);
+}
+inline XrfwLane
+xrfwLaneMul(XrfwLane a, XrfwLane b)
+{
+  return _mm_mul_ps(a, b);
+}
+inline XrfwLane
+xrfwLaneDiv(XrfwLane a, XrfwLane b)
+{
+  return _mm_div_ps(a, b);
+}
+inline XrfwLane
+xrfwLaneLoadUnaligned(const float* p)
+{
+  return _mm_loadu_ps(p);
+}
+using XrfwLaneMask = __m128;
+inline XrfwLaneMask
+xrfwLaneLess(XrfwLane a, XrfwLane b)
+{
+  return _mm_cmplt_ps(a, b);
+}
+inline XrfwLaneMask
+xrfwLaneMaskOr(XrfwLaneMask a, XrfwLaneMask b)
+{
+  return _mm_or_ps(a, b);
+}
+inline XrfwLaneMask
+xrfwLaneMaskAnd(XrfwLaneMask a, XrfwLaneMask b)
+{
+  return _mm_and_ps(a, b);
+}
+inline uint32_t
+xrfwLaneMaskBits(XrfwLaneMask m)
+{
+  return static_cast<uint32_t>(_mm_movemask_ps(m));
+}
+#elif !defined(XRFW_NO_SIMD) &&                                                \
+  (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define XRFW_SIMD_WIDTH 4
+using XrfwLane = float32x4_t;
+
+inline XrfwLane
+xrfwLaneLoad(const float* p)
+{
+  return vld1q_f32(p);
+}
+inline void
+xrfwLaneStore(float* p, XrfwLane v)
+{
+  vst1q_f32(p, v);
+}
+inline XrfwLane
+xrfwLaneSplat(float v)
+{
+  return vdupq_n_f32(v);
+}
+inline XrfwLane
+xrfwLaneAdd(XrfwLane a, XrfwLane b)
+{
+  return vaddq_f32(a, b);
+}
+inline XrfwLane
+xrfwLaneSub(XrfwLane a, XrfwLane b)
+{
+  return vsubq_f32(a, b);
+}
+inline XrfwLane
+xrfwLaneMul(XrfwLane a, XrfwLane b)
+{
+  return vmulq_f32(a, b);
+}
+inline XrfwLane
+xrfwLaneDiv(XrfwLane a, XrfwLane b)
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+  return vdivq_f32(a, b);
+#else
+  // ARMv7 has no divide. two Newton-Raphson steps of the reciprocal
+  auto r = vrecpeq_f32(b);
+  r = vmulq_f32(vrecpsq_f32(b, r), r);
+  r = vmulq_f32(vrecpsq_f32(b, r), r);
+  return vmulq_f32(a, r);
+#endif
+}
+inline XrfwLane
+xrfwLaneLoadUnaligned(const float* p)
+{
+  return vld1q_f32(p);
+}
+using XrfwLaneMask = uint32x4_t;
+inline XrfwLaneMask
+xrfwLaneLess(XrfwLane a, XrfwLane b)
+{
+  return vcltq_f32(a, b);
+}
+inline XrfwLaneMask
+xrfwLaneMaskOr(XrfwLaneMask a, XrfwLaneMask b)
+{
+  return vorrq_u32(a, b);
+}
+inline XrfwLaneMask
+xrfwLaneMaskAnd(XrfwLaneMask a, XrfwLaneMask b)
+{
+  return vandq_u32(a, b);
+}
+inline uint32_t
+xrfwLaneMaskBits(XrfwLaneMask m)
+{
+  static const uint32_t bits[4] = { 1, 2, 4, 8 };
+  auto b = vandq_u32(m, vld1q_u32(bits));
+#if defined(__aarch64__) || defined(_M_ARM64)
+  return vaddvq_u32(b);
+#else
+  return vgetq_lane_u32(b, 0) | vgetq_lane_u32(b, 1) | vgetq_lane_u32(b, 2) |
+         vgetq_lane_u32(b, 3);
+#endif
+}
+#else
+#define XRFW_SIMD_WIDTH 1
+using XrfwLane = float;
+
+inline XrfwLane
+xrfwLaneLoad(const float* p)
+{
+  return *p;
+}
+inline void
+xrfwLaneStore(float* p, XrfwLane v)
+{
+  *p = v;
+}
+inline XrfwLane
+xrfwLaneSplat(float v)
+{
+  return v;
+}
+inline XrfwLane
+xrfwLaneAdd(XrfwLane a, XrfwLane b)
+{
+  return a + b;
+}
+inline XrfwLane
+xrfwLaneSub(XrfwLane a, XrfwLane b)
+{
+  return a - b;
+}
+inline XrfwLane
+xrfwLaneMul(XrfwLane a, XrfwLane b)
+{
+  return a * b;
+}
+inline XrfwLane
+xrfwLaneDiv(XrfwLane a, XrfwLane b)
+{
+  return a / b;
+}
+inline XrfwLane
+xrfwLaneLoadUnaligned(const float* p)
+{
+  return *p;
+}
+using XrfwLaneMask = bool;
+inline XrfwLaneMask
+xrfwLaneLess(XrfwLane a, XrfwLane b)
+{
+  return a < b;
+}
+inline XrfwLaneMask
+xrfwLaneMaskOr(XrfwLaneMask a, XrfwLaneMask b)
+{
+  return a || b;
+}
+inline XrfwLaneMask
+xrfwLaneMaskAnd(XrfwLaneMask a, XrfwLaneMask b)
+{
+  return a && b;
+}
+inline uint32_t
+xrfwLaneMaskBits(XrfwLaneMask m)
+{
+  return m ? 1 : 0;
+}
+#endif
+
+// the element count rounded up to whole lanes
+inline constexpr size_t
+xrfwLaneCeil(size_t count)
+{
+  return (count + XRFW_SIMD_WIDTH - 1) / XRFW_SIMD_WIDTH * XRFW_SIMD_WIDTH;
+}
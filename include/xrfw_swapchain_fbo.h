@@ -3,6 +3,8 @@
 #include <GLES3/gl32.h>
 #elif XR_USE_PLATFORM_WIN32
 #include <GL/glew.h>
+#elif XR_USE_PLATFORM_EGL
+#include <GLES3/gl32.h>
 #else
 error("no XR_USE")
 #endif
@@ -29,11 +31,16 @@ public:
     }
   }
 
+  // depthTexture: the depth swapchain image from xrfwGetDepthSwapchainImage,
+  // submitted with XR_KHR_composition_layer_depth. 0 uses a private depth
+  // texture.
   void Begin(uint32_t colorTexture, int width, int height,
-             const float clearColor[4]) {
+             const float clearColor[4], uint32_t depthTexture = 0) {
     if (colorTexture) {
       glBindFramebuffer(GL_FRAMEBUFFER, m_swapchainFramebuffer);
-      const uint32_t depthTexture = GetDepthTexture(colorTexture);
+      if (!depthTexture) {
+        depthTexture = GetDepthTexture(colorTexture);
+      }
       glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
                              GL_TEXTURE_2D, colorTexture, 0);
       glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
@@ -47,7 +54,7 @@ public:
     glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
 #if XR_USE_PLATFORM_WIN32
     glClearDepth(1.0f);
-#elif XR_USE_PLATFORM_ANDROID
+#elif XR_USE_PLATFORM_ANDROID || XR_USE_PLATFORM_EGL
     glClearDepthf(1.0f);
 #else
     error("no XR_USE")
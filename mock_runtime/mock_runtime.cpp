@@ -0,0 +1,1701 @@
+// xrfw mock OpenXR runtime.
+//
+// A stand-in for a headset runtime, loaded by the OpenXR loader through
+// xrNegotiateLoaderRuntimeInterface (XR_RUNTIME_JSON=xrfw_mock_runtime.json).
+// Deterministic frame pacing, scripted head and hand motion and scripted
+// session state changes. Swapchain images are plain CPU memory, nothing is
+// presented.
+//
+// Configured by environment variables, read at xrCreateInstance.
+//
+//   XRFW_MOCK_REFRESH_RATE    display refresh rate in Hz. default 90
+//   XRFW_MOCK_THROTTLE        0: xrWaitFrame never sleeps. default 1
+//   XRFW_MOCK_JITTER_US       random delay added to each xrWaitFrame wakeup
+//   XRFW_MOCK_SEED            seed of the jitter. default 1
+//   XRFW_MOCK_EXIT_AFTER      frame count after which the session stops
+//   XRFW_MOCK_SESSION_SCRIPT  "frame:state,..." session state changes.
+//                             state is idle, synchronized, visible, focused,
+//                             stopping. e.g. "300:visible,360:focused"
+//   XRFW_MOCK_HEAD_YAW_DEG    head yaw amplitude. default 15
+//   XRFW_MOCK_HEAD_HZ         head yaw frequency. default 0.25
+//   XRFW_MOCK_WIDTH           recommended image width. default 1440
+//   XRFW_MOCK_HEIGHT          recommended image height. default 1584
+//   XRFW_MOCK_REPLAY          capture file of xrfwStartCapture. frame states,
+//                             views, hand and body joints and the session
+//                             state changes of the capture replace the
+//                             scripted ones. the session stops at its end
+//   XRFW_MOCK_REPLAY_FROM     first frame of the capture to replay. default 0
+//   XRFW_MOCK_VALIDATE        1: for the tests. aborts when a session is
+//                             destroyed with swapchains left, or when
+//                             xrEndFrame gets projection views that are not
+//                             the last located ones of the display time. a
+//                             repeated xrLocateViews of a display time
+//                             returns a refined head pose
+#define XR_USE_GRAPHICS_API_OPENGL
+#define XR_USE_GRAPHICS_API_OPENGL_ES
+#include <openxr/openxr.h>
+#include <openxr/openxr_loader_negotiation.h>
+#include <openxr/openxr_platform.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <random>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <xrfw_capture.h>
+
+#ifdef _WIN32
+#define MOCK_EXPORT extern "C" __declspec(dllexport)
+#else
+#define MOCK_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+static const uint32_t MOCK_MAX_LAYER_COUNT = 16;
+static const uint32_t MOCK_MAX_VIEW_COUNT = 4;
+static const float MOCK_IPD = 0.064f;
+static const float MOCK_HEAD_HEIGHT = 1.6f;
+// XRFW_MOCK_VALIDATE. head yaw added by each repeated xrLocateViews
+static const float MOCK_RELOCATE_YAW_DEG = 0.1f;
+static const XrSystemId MOCK_SYSTEM_ID = 1;
+
+// GL_RGBA8, GL_SRGB8_ALPHA8, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT32F
+static const int64_t MOCK_SWAPCHAIN_FORMATS[] = {
+  0x8058,
+  0x8C43,
+  0x81A6,
+  0x8CAC,
+};
+
+static const char* MOCK_EXTENSIONS[] = {
+  XR_KHR_OPENGL_ENABLE_EXTENSION_NAME,
+  XR_KHR_OPENGL_ES_ENABLE_EXTENSION_NAME,
+  // XR_MNDX_EGL_ENABLE_EXTENSION_NAME needs EGL headers
+  "XR_MNDX_egl_enable",
+  XR_EXT_HAND_TRACKING_EXTENSION_NAME,
+  XR_FB_BODY_TRACKING_EXTENSION_NAME,
+  XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME,
+  XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME,
+  XR_VARJO_QUAD_VIEWS_EXTENSION_NAME,
+#ifdef XR_KHR_locate_spaces
+  XR_KHR_LOCATE_SPACES_EXTENSION_NAME,
+#endif
+};
+
+static const XrViewConfigurationType MOCK_VIEW_CONFIGURATIONS[] = {
+  XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO,
+  XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO,
+  XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO,
+};
+
+// 0 for unsupported
+static uint32_t
+MockViewCount(XrViewConfigurationType viewConfigurationType)
+{
+  switch (viewConfigurationType) {
+    case XR_VIEW_CONFIGURATION_TYPE_PRIMARY_MONO:
+      return 1;
+    case XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO:
+      return 2;
+    case XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+//
+// config
+//
+struct MockScriptEntry
+{
+  uint64_t frame;
+  XrSessionState state;
+};
+
+struct MockConfig
+{
+  double refreshRate = 90;
+  bool throttle = true;
+  int64_t jitterNs = 0;
+  uint32_t seed = 1;
+  float headYawDeg = 15;
+  float headHz = 0.25f;
+  uint32_t width = 1440;
+  uint32_t height = 1584;
+  std::vector<MockScriptEntry> script;
+  const char* replay = nullptr;
+  uint64_t replayFrom = 0;
+  bool validate = false;
+
+  static const char* Env(const char* name)
+  {
+    auto value = getenv(name);
+    return (value && value[0]) ? value : nullptr;
+  }
+
+  static XrSessionState ParseState(std::string_view name)
+  {
+    if (name == "idle") {
+      return XR_SESSION_STATE_IDLE;
+    }
+    if (name == "synchronized") {
+      return XR_SESSION_STATE_SYNCHRONIZED;
+    }
+    if (name == "visible") {
+      return XR_SESSION_STATE_VISIBLE;
+    }
+    if (name == "focused") {
+      return XR_SESSION_STATE_FOCUSED;
+    }
+    if (name == "stopping") {
+      return XR_SESSION_STATE_STOPPING;
+    }
+    return XR_SESSION_STATE_UNKNOWN;
+  }
+
+  void ParseScript(std::string_view src)
+  {
+    while (!src.empty()) {
+      auto comma = src.find(',');
+      auto entry = src.substr(0, comma);
+      auto colon = entry.find(':');
+      if (colon != std::string_view::npos) {
+        auto frame = strtoull(std::string(entry.substr(0, colon)).c_str(),
+                              nullptr,
+                              10);
+        auto state = ParseState(entry.substr(colon + 1));
+        if (state != XR_SESSION_STATE_UNKNOWN) {
+          script.push_back({ frame, state });
+        }
+      }
+      if (comma == std::string_view::npos) {
+        break;
+      }
+      src = src.substr(comma + 1);
+    }
+  }
+
+  static MockConfig FromEnvironment()
+  {
+    MockConfig config;
+    if (auto value = Env("XRFW_MOCK_REFRESH_RATE")) {
+      config.refreshRate = std::max(1.0, atof(value));
+    }
+    if (auto value = Env("XRFW_MOCK_THROTTLE")) {
+      config.throttle = atoi(value) != 0;
+    }
+    if (auto value = Env("XRFW_MOCK_JITTER_US")) {
+      config.jitterNs = atoll(value) * 1000;
+    }
+    if (auto value = Env("XRFW_MOCK_SEED")) {
+      config.seed = static_cast<uint32_t>(atoll(value));
+    }
+    if (auto value = Env("XRFW_MOCK_HEAD_YAW_DEG")) {
+      config.headYawDeg = static_cast<float>(atof(value));
+    }
+    if (auto value = Env("XRFW_MOCK_HEAD_HZ")) {
+      config.headHz = static_cast<float>(atof(value));
+    }
+    if (auto value = Env("XRFW_MOCK_WIDTH")) {
+      config.width = static_cast<uint32_t>(atoi(value));
+    }
+    if (auto value = Env("XRFW_MOCK_HEIGHT")) {
+      config.height = static_cast<uint32_t>(atoi(value));
+    }
+    if (auto value = Env("XRFW_MOCK_SESSION_SCRIPT")) {
+      config.ParseScript(value);
+    }
+    if (auto value = Env("XRFW_MOCK_EXIT_AFTER")) {
+      config.script.push_back(
+        { strtoull(value, nullptr, 10), XR_SESSION_STATE_STOPPING });
+    }
+    config.replay = Env("XRFW_MOCK_REPLAY");
+    if (auto value = Env("XRFW_MOCK_REPLAY_FROM")) {
+      config.replayFrom = strtoull(value, nullptr, 10);
+    }
+    if (auto value = Env("XRFW_MOCK_VALIDATE")) {
+      config.validate = atoi(value) != 0;
+    }
+    config.SortScript();
+    return config;
+  }
+
+  void SortScript()
+  {
+    std::sort(
+      script.begin(), script.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.frame < rhs.frame;
+      });
+  }
+};
+
+//
+// pose math
+//
+static XrQuaternionf
+QuatMultiply(const XrQuaternionf& a, const XrQuaternionf& b)
+{
+  return {
+    a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+    a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+    a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+    a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+  };
+}
+
+static XrQuaternionf
+QuatConjugate(const XrQuaternionf& q)
+{
+  return { -q.x, -q.y, -q.z, q.w };
+}
+
+static XrVector3f
+QuatRotate(const XrQuaternionf& q, const XrVector3f& v)
+{
+  auto r = QuatMultiply(QuatMultiply(q, { v.x, v.y, v.z, 0 }),
+                        QuatConjugate(q));
+  return { r.x, r.y, r.z };
+}
+
+static XrQuaternionf
+QuatFromYaw(float radians)
+{
+  return { 0, sinf(radians / 2), 0, cosf(radians / 2) };
+}
+
+static XrPosef
+PoseMultiply(const XrPosef& parent, const XrPosef& child)
+{
+  auto p = QuatRotate(parent.orientation, child.position);
+  return {
+    QuatMultiply(parent.orientation, child.orientation),
+    {
+      parent.position.x + p.x,
+      parent.position.y + p.y,
+      parent.position.z + p.z,
+    },
+  };
+}
+
+static XrPosef
+PoseInvert(const XrPosef& pose)
+{
+  auto q = QuatConjugate(pose.orientation);
+  auto p = QuatRotate(q, pose.position);
+  return { q, { -p.x, -p.y, -p.z } };
+}
+
+static const XrPosef IDENTITY_POSE = { { 0, 0, 0, 1 }, { 0, 0, 0 } };
+
+static XrTime
+NowNanoseconds()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+
+//
+// handles
+//
+// XRFW_MOCK_REPLAY
+struct MockReplay
+{
+  XrfwMappedFile file;
+  XrfwCaptureReader reader;
+  bool hasHandJoints = false;
+  bool hasBodyJoints = false;
+
+  bool Load(MockConfig* config)
+  {
+    if (!file.OpenRead(config->replay) ||
+        !reader.Load(file.m_data, file.m_size)) {
+      fprintf(stderr, "XRFW_MOCK_REPLAY: can not load %s\n", config->replay);
+      return false;
+    }
+    if (config->replayFrom >= reader.FrameCount()) {
+      fprintf(stderr,
+              "XRFW_MOCK_REPLAY_FROM: %llu frames in %s\n",
+              (unsigned long long)reader.FrameCount(),
+              config->replay);
+      return false;
+    }
+
+    // xrBeginSession stops at synchronized, the later changes are replayed
+    // at their frame like XRFW_MOCK_SESSION_SCRIPT.
+    config->script.clear();
+    bool synchronized = false;
+    bool stopping = false;
+    // the state at replayFrom
+    auto initialState = XR_SESSION_STATE_SYNCHRONIZED;
+    for (auto record = reader.First(); record; record = reader.Next(record)) {
+      if (record->type == XRFW_CAPTURE_HAND_JOINTS) {
+        hasHandJoints = true;
+      } else if (record->type == XRFW_CAPTURE_BODY_JOINTS) {
+        hasBodyJoints = true;
+      } else if (record->type == XRFW_CAPTURE_SESSION_STATE) {
+        auto state =
+          XrfwCaptureReader::Payload<XrfwCaptureSessionState>(record);
+        if (!state) {
+          continue;
+        }
+        switch (state->state) {
+          case XR_SESSION_STATE_SYNCHRONIZED:
+            if (!synchronized) {
+              // by xrBeginSession
+              synchronized = true;
+              break;
+            }
+            [[fallthrough]];
+          case XR_SESSION_STATE_VISIBLE:
+          case XR_SESSION_STATE_FOCUSED:
+          case XR_SESSION_STATE_STOPPING:
+            stopping = state->state == XR_SESSION_STATE_STOPPING;
+            if (record->frame <= config->replayFrom) {
+              initialState = state->state;
+            } else {
+              config->script.push_back(
+                { record->frame - config->replayFrom, state->state });
+            }
+            break;
+          default:
+            // idle, ready, exiting and loss follow from the others
+            break;
+        }
+      }
+    }
+    if (initialState != XR_SESSION_STATE_SYNCHRONIZED) {
+      config->script.push_back({ 0, initialState });
+    }
+    if (!stopping) {
+      config->script.push_back({ reader.FrameCount() - config->replayFrom,
+                                 XR_SESSION_STATE_STOPPING });
+    }
+    config->SortScript();
+    return true;
+  }
+
+  // the n-th record of type in frame. A pipelined capture has records of
+  // frame N after the FrameState of N+1
+  const XrfwCaptureRecordHeader* Find(uint64_t frame,
+                                      XrfwCaptureRecordType type,
+                                      uint32_t n = 0) const
+  {
+    auto record = reader.Frame(frame);
+    if (!record) {
+      return nullptr;
+    }
+    for (record = reader.Next(record); record; record = reader.Next(record)) {
+      if (record->type == XRFW_CAPTURE_FRAME_STATE &&
+          record->frame > frame + 1) {
+        break;
+      }
+      if (record->frame == frame && record->type == type && n-- == 0) {
+        return record;
+      }
+    }
+    return nullptr;
+  }
+};
+
+struct MockInstance
+{
+  MockConfig config;
+  // XRFW_MOCK_REPLAY. nullptr for the scripted motion
+  std::unique_ptr<MockReplay> replay;
+  std::mutex eventMutex;
+  std::deque<XrEventDataBuffer> events;
+
+  void PushEvent(const void* event, size_t size)
+  {
+    XrEventDataBuffer buffer{};
+    memcpy(&buffer, event, size);
+    std::lock_guard<std::mutex> lock(eventMutex);
+    events.push_back(buffer);
+  }
+};
+
+struct MockSession
+{
+  MockInstance* instance;
+  std::mt19937 rng;
+  std::mutex frameMutex;
+  XrSessionState state = XR_SESSION_STATE_UNKNOWN;
+  bool running = false;
+  bool exitRequested = false;
+  XrTime epoch = 0;
+  XrDuration period = 0;
+  uint64_t waitedFrames = 0;
+  uint64_t endedFrames = 0;
+  // not destroyed by xrDestroySwapchain
+  std::atomic<uint32_t> swapchainCount = 0;
+  size_t scriptIndex = 0;
+  XrTime lastDisplayTime = 0;
+  bool frameBegun = false;
+  // XRFW_MOCK_REPLAY. the capture frames of the last xrWaitFrames. A pipelined
+  // app locates frame N after xrWaitFrame of N+1, found by display time
+  struct ReplayFrame
+  {
+    XrTime displayTime = 0;
+    uint64_t frame = 0;
+    uint32_t views = 0;
+  };
+  std::array<ReplayFrame, 4> replayFrames;
+  XrTime replayEpoch = 0;
+  XrTime replayFirstDisplayTime = 0;
+  // XRFW_MOCK_VALIDATE. the last xrLocateViews of the recent display times
+  struct LocatedViews
+  {
+    XrTime displayTime = 0;
+    uint32_t locateCount = 0;
+    XrPosef poses[MOCK_MAX_VIEW_COUNT];
+  };
+  std::array<LocatedViews, 4> locatedViews;
+  size_t nextLocatedViews = 0;
+
+  // frameMutex
+  LocatedViews* FindLocatedViews(XrTime time)
+  {
+    for (auto& located : locatedViews) {
+      if (located.locateCount > 0 && located.displayTime == time) {
+        return &located;
+      }
+    }
+    return nullptr;
+  }
+
+  // the waited frame displayed at time, the last one otherwise. frameMutex
+  ReplayFrame& ReplayFrameAt(XrTime time)
+  {
+    for (auto& replayFrame : replayFrames) {
+      if (replayFrame.displayTime == time) {
+        return replayFrame;
+      }
+    }
+    return replayFrames[(waitedFrames + replayFrames.size() - 1) %
+                        replayFrames.size()];
+  }
+
+  uint64_t ReplayFrameIndexAt(XrTime time)
+  {
+    std::lock_guard<std::mutex> lock(frameMutex);
+    return ReplayFrameAt(time).frame;
+  }
+
+  void SetState(XrSessionState newState)
+  {
+    state = newState;
+    XrEventDataSessionStateChanged event{
+      .type = XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED,
+      .session = (XrSession)this,
+      .state = newState,
+      .time = NowNanoseconds(),
+    };
+    instance->PushEvent(&event, sizeof(event));
+  }
+
+  // head in STAGE space. sways left and right
+  XrPosef HeadPose(XrTime time) const
+  {
+    auto seconds = static_cast<double>(time - epoch) * 1e-9;
+    auto yaw = instance->config.headYawDeg * std::numbers::pi_v<float> /
+               180.0f *
+               static_cast<float>(sin(2 * std::numbers::pi *
+                                      instance->config.headHz * seconds));
+    return {
+      QuatFromYaw(yaw),
+      { 0, MOCK_HEAD_HEIGHT, 0 },
+    };
+  }
+};
+
+struct MockSpace
+{
+  MockSession* session;
+  XrReferenceSpaceType type;
+  XrPosef poseInReferenceSpace;
+
+  XrPosef PoseInStage(XrTime time) const
+  {
+    switch (type) {
+      case XR_REFERENCE_SPACE_TYPE_VIEW:
+        return PoseMultiply(session->HeadPose(time), poseInReferenceSpace);
+      case XR_REFERENCE_SPACE_TYPE_LOCAL:
+        return PoseMultiply({ { 0, 0, 0, 1 }, { 0, MOCK_HEAD_HEIGHT, 0 } },
+                            poseInReferenceSpace);
+      default:
+        return poseInReferenceSpace;
+    }
+  }
+};
+
+struct MockSwapchain
+{
+  MockSession* session;
+  XrSwapchainCreateInfo info;
+  std::vector<std::vector<uint8_t>> images;
+  uint32_t nextImage = 0;
+  std::deque<uint32_t> acquired;
+  bool waited = false;
+  // a layer can sample the swapchain after the first release
+  uint32_t releaseCount = 0;
+};
+
+struct MockHandTracker
+{
+  MockSession* session;
+  XrHandEXT hand;
+};
+
+struct MockBodyTracker
+{
+  MockSession* session;
+};
+
+//
+// instance
+//
+static XrResult XRAPI_CALL
+mock_xrGetInstanceProcAddr(XrInstance instance,
+                           const char* name,
+                           PFN_xrVoidFunction* function);
+
+static XrResult XRAPI_CALL
+mock_xrEnumerateInstanceExtensionProperties(const char* layerName,
+                                            uint32_t propertyCapacityInput,
+                                            uint32_t* propertyCountOutput,
+                                            XrExtensionProperties* properties)
+{
+  if (layerName) {
+    return XR_ERROR_API_LAYER_NOT_PRESENT;
+  }
+  *propertyCountOutput = static_cast<uint32_t>(std::size(MOCK_EXTENSIONS));
+  if (propertyCapacityInput == 0) {
+    return XR_SUCCESS;
+  }
+  if (propertyCapacityInput < std::size(MOCK_EXTENSIONS)) {
+    return XR_ERROR_SIZE_INSUFFICIENT;
+  }
+  for (size_t i = 0; i < std::size(MOCK_EXTENSIONS); ++i) {
+    strncpy(properties[i].extensionName,
+            MOCK_EXTENSIONS[i],
+            XR_MAX_EXTENSION_NAME_SIZE - 1);
+    properties[i].extensionVersion = 1;
+  }
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrCreateInstance(const XrInstanceCreateInfo* createInfo,
+                      XrInstance* instance)
+{
+  for (uint32_t i = 0; i < createInfo->enabledExtensionCount; ++i) {
+    auto found = std::find_if(std::begin(MOCK_EXTENSIONS),
+                              std::end(MOCK_EXTENSIONS),
+                              [name = createInfo->enabledExtensionNames[i]](
+                                const char* ext) { return !strcmp(ext, name); });
+    if (found == std::end(MOCK_EXTENSIONS)) {
+      return XR_ERROR_EXTENSION_NOT_PRESENT;
+    }
+  }
+  auto mock = new MockInstance;
+  mock->config = MockConfig::FromEnvironment();
+  if (mock->config.replay) {
+    mock->replay = std::make_unique<MockReplay>();
+    if (!mock->replay->Load(&mock->config)) {
+      delete mock;
+      return XR_ERROR_INITIALIZATION_FAILED;
+    }
+  }
+  *instance = (XrInstance)mock;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrDestroyInstance(XrInstance instance)
+{
+  delete (MockInstance*)instance;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrGetInstanceProperties(XrInstance instance,
+                             XrInstanceProperties* properties)
+{
+  properties->runtimeVersion = XR_MAKE_VERSION(0, 1, 0);
+  strncpy(properties->runtimeName,
+          "xrfw mock runtime",
+          XR_MAX_RUNTIME_NAME_SIZE - 1);
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrPollEvent(XrInstance instance, XrEventDataBuffer* eventData)
+{
+  auto mock = (MockInstance*)instance;
+  std::lock_guard<std::mutex> lock(mock->eventMutex);
+  if (mock->events.empty()) {
+    return XR_EVENT_UNAVAILABLE;
+  }
+  *eventData = mock->events.front();
+  mock->events.pop_front();
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrResultToString(XrInstance instance,
+                      XrResult value,
+                      char buffer[XR_MAX_RESULT_STRING_SIZE])
+{
+  snprintf(buffer, XR_MAX_RESULT_STRING_SIZE, "XR_RESULT_%d", (int)value);
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrStructureTypeToString(XrInstance instance,
+                             XrStructureType value,
+                             char buffer[XR_MAX_STRUCTURE_NAME_SIZE])
+{
+  snprintf(buffer, XR_MAX_STRUCTURE_NAME_SIZE, "XR_TYPE_%d", (int)value);
+  return XR_SUCCESS;
+}
+
+//
+// system
+//
+static XrResult XRAPI_CALL
+mock_xrGetSystem(XrInstance instance,
+                 const XrSystemGetInfo* getInfo,
+                 XrSystemId* systemId)
+{
+  if (getInfo->formFactor != XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY) {
+    return XR_ERROR_FORM_FACTOR_UNSUPPORTED;
+  }
+  *systemId = MOCK_SYSTEM_ID;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrGetSystemProperties(XrInstance instance,
+                           XrSystemId systemId,
+                           XrSystemProperties* properties)
+{
+  auto mock = (MockInstance*)instance;
+  properties->systemId = systemId;
+  properties->vendorId = 0;
+  strncpy(properties->systemName, "xrfw mock hmd", XR_MAX_SYSTEM_NAME_SIZE - 1);
+  properties->graphicsProperties = {
+    .maxSwapchainImageHeight = mock->config.height * 2,
+    .maxSwapchainImageWidth = mock->config.width * 2,
+    .maxLayerCount = MOCK_MAX_LAYER_COUNT,
+  };
+  properties->trackingProperties = {
+    .orientationTracking = XR_TRUE,
+    .positionTracking = XR_TRUE,
+  };
+  for (auto next = (XrBaseOutStructure*)properties->next; next;
+       next = next->next) {
+    if (next->type == XR_TYPE_SYSTEM_HAND_TRACKING_PROPERTIES_EXT) {
+      ((XrSystemHandTrackingPropertiesEXT*)next)->supportsHandTracking =
+        XR_TRUE;
+    }
+  }
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrEnumerateViewConfigurations(XrInstance instance,
+                                   XrSystemId systemId,
+                                   uint32_t capacityInput,
+                                   uint32_t* countOutput,
+                                   XrViewConfigurationType* types)
+{
+  *countOutput = static_cast<uint32_t>(std::size(MOCK_VIEW_CONFIGURATIONS));
+  if (capacityInput == 0) {
+    return XR_SUCCESS;
+  }
+  if (capacityInput < std::size(MOCK_VIEW_CONFIGURATIONS)) {
+    return XR_ERROR_SIZE_INSUFFICIENT;
+  }
+  std::copy(std::begin(MOCK_VIEW_CONFIGURATIONS),
+            std::end(MOCK_VIEW_CONFIGURATIONS),
+            types);
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrGetViewConfigurationProperties(
+  XrInstance instance,
+  XrSystemId systemId,
+  XrViewConfigurationType viewConfigurationType,
+  XrViewConfigurationProperties* properties)
+{
+  if (!MockViewCount(viewConfigurationType)) {
+    return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+  }
+  properties->viewConfigurationType = viewConfigurationType;
+  properties->fovMutable = XR_FALSE;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrEnumerateViewConfigurationViews(
+  XrInstance instance,
+  XrSystemId systemId,
+  XrViewConfigurationType viewConfigurationType,
+  uint32_t capacityInput,
+  uint32_t* countOutput,
+  XrViewConfigurationView* views)
+{
+  auto viewCount = MockViewCount(viewConfigurationType);
+  if (!viewCount) {
+    return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+  }
+  auto mock = (MockInstance*)instance;
+  *countOutput = viewCount;
+  if (capacityInput == 0) {
+    return XR_SUCCESS;
+  }
+  if (capacityInput < viewCount) {
+    return XR_ERROR_SIZE_INSUFFICIENT;
+  }
+  for (uint32_t i = 0; i < viewCount; ++i) {
+    // quad views. the insets are smaller
+    auto width = i < 2 ? mock->config.width : mock->config.width * 2 / 3;
+    auto height = i < 2 ? mock->config.height : mock->config.height * 2 / 3;
+    views[i].recommendedImageRectWidth = width;
+    views[i].maxImageRectWidth = width * 2;
+    views[i].recommendedImageRectHeight = height;
+    views[i].maxImageRectHeight = height * 2;
+    views[i].recommendedSwapchainSampleCount = 1;
+    views[i].maxSwapchainSampleCount = 1;
+  }
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrEnumerateEnvironmentBlendModes(
+  XrInstance instance,
+  XrSystemId systemId,
+  XrViewConfigurationType viewConfigurationType,
+  uint32_t capacityInput,
+  uint32_t* countOutput,
+  XrEnvironmentBlendMode* modes)
+{
+  *countOutput = 1;
+  if (capacityInput == 0) {
+    return XR_SUCCESS;
+  }
+  modes[0] = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrGetOpenGLGraphicsRequirementsKHR(
+  XrInstance instance,
+  XrSystemId systemId,
+  XrGraphicsRequirementsOpenGLKHR* requirements)
+{
+  requirements->minApiVersionSupported = XR_MAKE_VERSION(1, 0, 0);
+  requirements->maxApiVersionSupported = XR_MAKE_VERSION(4, 6, 0);
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrGetOpenGLESGraphicsRequirementsKHR(
+  XrInstance instance,
+  XrSystemId systemId,
+  XrGraphicsRequirementsOpenGLESKHR* requirements)
+{
+  requirements->minApiVersionSupported = XR_MAKE_VERSION(2, 0, 0);
+  requirements->maxApiVersionSupported = XR_MAKE_VERSION(3, 2, 0);
+  return XR_SUCCESS;
+}
+
+//
+// session
+//
+static XrResult XRAPI_CALL
+mock_xrCreateSession(XrInstance instance,
+                     const XrSessionCreateInfo* createInfo,
+                     XrSession* session)
+{
+  if (createInfo->systemId != MOCK_SYSTEM_ID) {
+    return XR_ERROR_SYSTEM_INVALID;
+  }
+  auto mock = new MockSession;
+  mock->instance = (MockInstance*)instance;
+  mock->rng.seed(mock->instance->config.seed);
+  mock->epoch = NowNanoseconds();
+  mock->period =
+    static_cast<XrDuration>(1e9 / mock->instance->config.refreshRate);
+  mock->SetState(XR_SESSION_STATE_IDLE);
+  mock->SetState(XR_SESSION_STATE_READY);
+  *session = (XrSession)mock;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrDestroySession(XrSession session)
+{
+  auto mock = (MockSession*)session;
+  // the runtime destroys them with the session. the app leaked them
+  if (mock->instance->config.validate && mock->swapchainCount > 0) {
+    fprintf(stderr,
+            "xrDestroySession: %u swapchains not destroyed\n",
+            mock->swapchainCount.load());
+    abort();
+  }
+  delete mock;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo)
+{
+  auto mock = (MockSession*)session;
+  if (mock->running) {
+    return XR_ERROR_SESSION_RUNNING;
+  }
+  if (mock->state != XR_SESSION_STATE_READY) {
+    return XR_ERROR_SESSION_NOT_READY;
+  }
+  mock->running = true;
+  mock->SetState(XR_SESSION_STATE_SYNCHRONIZED);
+  if (mock->instance->replay) {
+    // visible and focused come from the capture
+    return XR_SUCCESS;
+  }
+  mock->SetState(XR_SESSION_STATE_VISIBLE);
+  mock->SetState(XR_SESSION_STATE_FOCUSED);
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrEndSession(XrSession session)
+{
+  auto mock = (MockSession*)session;
+  if (!mock->running) {
+    return XR_ERROR_SESSION_NOT_RUNNING;
+  }
+  if (mock->state != XR_SESSION_STATE_STOPPING) {
+    return XR_ERROR_SESSION_NOT_STOPPING;
+  }
+  mock->running = false;
+  mock->SetState(XR_SESSION_STATE_IDLE);
+  if (mock->exitRequested) {
+    mock->SetState(XR_SESSION_STATE_EXITING);
+  }
+  return XR_SUCCESS;
+}
+
+static void
+MockStopSession(MockSession* mock)
+{
+  mock->exitRequested = true;
+  if (mock->state == XR_SESSION_STATE_FOCUSED) {
+    mock->SetState(XR_SESSION_STATE_VISIBLE);
+  }
+  if (mock->state == XR_SESSION_STATE_VISIBLE) {
+    mock->SetState(XR_SESSION_STATE_SYNCHRONIZED);
+  }
+  mock->SetState(XR_SESSION_STATE_STOPPING);
+}
+
+static XrResult XRAPI_CALL
+mock_xrRequestExitSession(XrSession session)
+{
+  auto mock = (MockSession*)session;
+  if (!mock->running) {
+    return XR_ERROR_SESSION_NOT_RUNNING;
+  }
+  MockStopSession(mock);
+  return XR_SUCCESS;
+}
+
+//
+// space
+//
+static XrResult XRAPI_CALL
+mock_xrEnumerateReferenceSpaces(XrSession session,
+                                uint32_t capacityInput,
+                                uint32_t* countOutput,
+                                XrReferenceSpaceType* spaces)
+{
+  static const XrReferenceSpaceType types[] = {
+    XR_REFERENCE_SPACE_TYPE_VIEW,
+    XR_REFERENCE_SPACE_TYPE_LOCAL,
+    XR_REFERENCE_SPACE_TYPE_STAGE,
+  };
+  *countOutput = static_cast<uint32_t>(std::size(types));
+  if (capacityInput == 0) {
+    return XR_SUCCESS;
+  }
+  if (capacityInput < std::size(types)) {
+    return XR_ERROR_SIZE_INSUFFICIENT;
+  }
+  std::copy(std::begin(types), std::end(types), spaces);
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrCreateReferenceSpace(XrSession session,
+                            const XrReferenceSpaceCreateInfo* createInfo,
+                            XrSpace* space)
+{
+  *space = (XrSpace) new MockSpace{
+    .session = (MockSession*)session,
+    .type = createInfo->referenceSpaceType,
+    .poseInReferenceSpace = createInfo->poseInReferenceSpace,
+  };
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrDestroySpace(XrSpace space)
+{
+  delete (MockSpace*)space;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrLocateSpace(XrSpace space,
+                   XrSpace baseSpace,
+                   XrTime time,
+                   XrSpaceLocation* location)
+{
+  auto mockSpace = (MockSpace*)space;
+  auto mockBase = (MockSpace*)baseSpace;
+  location->pose = PoseMultiply(PoseInvert(mockBase->PoseInStage(time)),
+                                mockSpace->PoseInStage(time));
+  location->locationFlags =
+    XR_SPACE_LOCATION_ORIENTATION_VALID_BIT |
+    XR_SPACE_LOCATION_POSITION_VALID_BIT |
+    XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT |
+    XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+  return XR_SUCCESS;
+}
+
+#ifdef XR_KHR_locate_spaces
+static XrResult XRAPI_CALL
+mock_xrLocateSpacesKHR(XrSession session,
+                       const XrSpacesLocateInfoKHR* locateInfo,
+                       XrSpaceLocationsKHR* spaceLocations)
+{
+  if (spaceLocations->locationCount < locateInfo->spaceCount) {
+    return XR_ERROR_VALIDATION_FAILURE;
+  }
+  for (uint32_t i = 0; i < locateInfo->spaceCount; ++i) {
+    XrSpaceLocation location{ XR_TYPE_SPACE_LOCATION };
+    mock_xrLocateSpace(locateInfo->spaces[i],
+                       locateInfo->baseSpace,
+                       locateInfo->time,
+                       &location);
+    spaceLocations->locations[i] = {
+      .locationFlags = location.locationFlags,
+      .pose = location.pose,
+    };
+  }
+  return XR_SUCCESS;
+}
+#endif
+
+//
+// swapchain
+//
+static XrResult XRAPI_CALL
+mock_xrEnumerateSwapchainFormats(XrSession session,
+                                 uint32_t capacityInput,
+                                 uint32_t* countOutput,
+                                 int64_t* formats)
+{
+  *countOutput = static_cast<uint32_t>(std::size(MOCK_SWAPCHAIN_FORMATS));
+  if (capacityInput == 0) {
+    return XR_SUCCESS;
+  }
+  if (capacityInput < std::size(MOCK_SWAPCHAIN_FORMATS)) {
+    return XR_ERROR_SIZE_INSUFFICIENT;
+  }
+  std::copy(std::begin(MOCK_SWAPCHAIN_FORMATS),
+            std::end(MOCK_SWAPCHAIN_FORMATS),
+            formats);
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrCreateSwapchain(XrSession session,
+                       const XrSwapchainCreateInfo* createInfo,
+                       XrSwapchain* swapchain)
+{
+  auto found = std::find(std::begin(MOCK_SWAPCHAIN_FORMATS),
+                         std::end(MOCK_SWAPCHAIN_FORMATS),
+                         createInfo->format);
+  if (found == std::end(MOCK_SWAPCHAIN_FORMATS)) {
+    return XR_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
+  }
+  auto mock = new MockSwapchain{
+    .session = (MockSession*)session,
+    .info = *createInfo,
+  };
+  // static images have a single image
+  auto imageCount =
+    (createInfo->createFlags & XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT) ? 1 : 3;
+  size_t imageSize = size_t(createInfo->width) * createInfo->height *
+                     createInfo->arraySize * createInfo->faceCount * 4;
+  mock->images.resize(imageCount, std::vector<uint8_t>(imageSize));
+  ++mock->session->swapchainCount;
+  *swapchain = (XrSwapchain)mock;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrDestroySwapchain(XrSwapchain swapchain)
+{
+  auto mock = (MockSwapchain*)swapchain;
+  --mock->session->swapchainCount;
+  delete mock;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrEnumerateSwapchainImages(XrSwapchain swapchain,
+                                uint32_t capacityInput,
+                                uint32_t* countOutput,
+                                XrSwapchainImageBaseHeader* images)
+{
+  auto mock = (MockSwapchain*)swapchain;
+  *countOutput = static_cast<uint32_t>(mock->images.size());
+  if (capacityInput == 0) {
+    return XR_SUCCESS;
+  }
+  if (capacityInput < mock->images.size()) {
+    return XR_ERROR_SIZE_INSUFFICIENT;
+  }
+  // The images are CPU memory. There is no graphics API texture behind them.
+  switch (images->type) {
+    case XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_KHR: {
+      auto gl = (XrSwapchainImageOpenGLKHR*)images;
+      for (uint32_t i = 0; i < mock->images.size(); ++i) {
+        gl[i].image = 0;
+      }
+      break;
+    }
+    case XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR: {
+      auto gles = (XrSwapchainImageOpenGLESKHR*)images;
+      for (uint32_t i = 0; i < mock->images.size(); ++i) {
+        gles[i].image = 0;
+      }
+      break;
+    }
+    default:
+      return XR_ERROR_VALIDATION_FAILURE;
+  }
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrAcquireSwapchainImage(XrSwapchain swapchain,
+                             const XrSwapchainImageAcquireInfo* acquireInfo,
+                             uint32_t* index)
+{
+  auto mock = (MockSwapchain*)swapchain;
+  if (mock->acquired.size() >= mock->images.size()) {
+    return XR_ERROR_CALL_ORDER_INVALID;
+  }
+  if ((mock->info.createFlags & XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT) &&
+      mock->releaseCount > 0) {
+    // static images are acquired once
+    return XR_ERROR_CALL_ORDER_INVALID;
+  }
+  *index = mock->nextImage;
+  mock->acquired.push_back(mock->nextImage);
+  mock->nextImage =
+    (mock->nextImage + 1) % static_cast<uint32_t>(mock->images.size());
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrWaitSwapchainImage(XrSwapchain swapchain,
+                          const XrSwapchainImageWaitInfo* waitInfo)
+{
+  auto mock = (MockSwapchain*)swapchain;
+  if (mock->acquired.empty() || mock->waited) {
+    return XR_ERROR_CALL_ORDER_INVALID;
+  }
+  mock->waited = true;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrReleaseSwapchainImage(XrSwapchain swapchain,
+                             const XrSwapchainImageReleaseInfo* releaseInfo)
+{
+  auto mock = (MockSwapchain*)swapchain;
+  if (!mock->waited) {
+    return XR_ERROR_CALL_ORDER_INVALID;
+  }
+  mock->acquired.pop_front();
+  mock->waited = false;
+  ++mock->releaseCount;
+  return XR_SUCCESS;
+}
+
+//
+// frame
+//
+
+// the frame state of the next capture frame. paced by its display times
+static XrResult
+MockReplayWaitFrame(MockSession* mock,
+                    const MockReplay& replay,
+                    XrFrameState* frameState)
+{
+  auto& config = mock->instance->config;
+  auto frame = config.replayFrom + mock->waitedFrames;
+  auto record = replay.reader.Frame(frame);
+  auto captured =
+    record ? XrfwCaptureReader::Payload<XrfwCaptureFrameState>(record)
+           : nullptr;
+  if (!captured) {
+    // past the end. the script stops the session
+    frameState->predictedDisplayTime = mock->lastDisplayTime + mock->period;
+    frameState->predictedDisplayPeriod = mock->period;
+    frameState->shouldRender = XR_FALSE;
+  } else {
+    if (mock->waitedFrames == 0) {
+      mock->replayEpoch = NowNanoseconds();
+      mock->replayFirstDisplayTime = captured->predictedDisplayTime;
+    } else if (config.throttle) {
+      auto wakeup = mock->replayEpoch + (captured->predictedDisplayTime -
+                                         mock->replayFirstDisplayTime);
+      auto now = NowNanoseconds();
+      if (wakeup > now) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(wakeup - now));
+      }
+    }
+    *frameState = {
+      .type = frameState->type,
+      .next = frameState->next,
+      .predictedDisplayTime = captured->predictedDisplayTime,
+      .predictedDisplayPeriod = captured->predictedDisplayPeriod,
+      .shouldRender = captured->shouldRender,
+    };
+  }
+
+  std::lock_guard<std::mutex> lock(mock->frameMutex);
+  mock->replayFrames[mock->waitedFrames % mock->replayFrames.size()] = {
+    .displayTime = frameState->predictedDisplayTime,
+    .frame = frame,
+  };
+  ++mock->waitedFrames;
+  mock->lastDisplayTime = frameState->predictedDisplayTime;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrWaitFrame(XrSession session,
+                 const XrFrameWaitInfo* frameWaitInfo,
+                 XrFrameState* frameState)
+{
+  auto mock = (MockSession*)session;
+  if (!mock->running) {
+    return XR_ERROR_SESSION_NOT_RUNNING;
+  }
+  auto& config = mock->instance->config;
+
+  if (auto& replay = mock->instance->replay) {
+    return MockReplayWaitFrame(mock, *replay, frameState);
+  }
+
+  XrTime displayTime;
+  if (config.throttle) {
+    // sleep until the next vsync
+    auto now = NowNanoseconds();
+    auto vsync =
+      mock->epoch + ((now - mock->epoch) / mock->period + 1) * mock->period;
+    if (config.jitterNs > 0) {
+      std::uniform_int_distribution<int64_t> jitter(0, config.jitterNs);
+      vsync += jitter(mock->rng);
+    }
+    std::this_thread::sleep_for(std::chrono::nanoseconds(vsync - now));
+    displayTime = vsync + mock->period;
+  } else {
+    displayTime = mock->epoch + (mock->waitedFrames + 1) * mock->period;
+  }
+
+  std::lock_guard<std::mutex> lock(mock->frameMutex);
+  ++mock->waitedFrames;
+  mock->lastDisplayTime = displayTime;
+  frameState->predictedDisplayTime = displayTime;
+  frameState->predictedDisplayPeriod = mock->period;
+  frameState->shouldRender = mock->state == XR_SESSION_STATE_VISIBLE ||
+                             mock->state == XR_SESSION_STATE_FOCUSED;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrBeginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo)
+{
+  auto mock = (MockSession*)session;
+  std::lock_guard<std::mutex> lock(mock->frameMutex);
+  if (!mock->running) {
+    return XR_ERROR_SESSION_NOT_RUNNING;
+  }
+  auto discarded = mock->frameBegun;
+  mock->frameBegun = true;
+  return discarded ? XR_FRAME_DISCARDED : XR_SUCCESS;
+}
+
+static bool
+MockIsReleased(const XrSwapchainSubImage& subImage)
+{
+  return subImage.swapchain &&
+         ((MockSwapchain*)subImage.swapchain)->releaseCount > 0;
+}
+
+// every swapchain of the layer has a released image
+static bool
+MockIsLayerValid(const XrCompositionLayerBaseHeader* layer)
+{
+  switch (layer->type) {
+    case XR_TYPE_COMPOSITION_LAYER_PROJECTION: {
+      auto projection = (const XrCompositionLayerProjection*)layer;
+      for (uint32_t i = 0; i < projection->viewCount; ++i) {
+        auto& view = projection->views[i];
+        if (!MockIsReleased(view.subImage)) {
+          return false;
+        }
+        for (auto next = (const XrBaseInStructure*)view.next; next;
+             next = next->next) {
+          if (next->type == XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR &&
+              !MockIsReleased(
+                ((const XrCompositionLayerDepthInfoKHR*)next)->subImage)) {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+    case XR_TYPE_COMPOSITION_LAYER_QUAD:
+      return MockIsReleased(((const XrCompositionLayerQuad*)layer)->subImage);
+    case XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR:
+      return MockIsReleased(
+        ((const XrCompositionLayerCylinderKHR*)layer)->subImage);
+    default:
+      return true;
+  }
+}
+
+// the projection views carry the poses of the last xrLocateViews, which a late
+// latch repeated just before xrEndFrame. frameMutex
+static void
+MockValidateProjectionPoses(MockSession* mock,
+                            const XrFrameEndInfo* frameEndInfo)
+{
+  auto located = mock->FindLocatedViews(frameEndInfo->displayTime);
+  if (!located) {
+    return;
+  }
+  for (uint32_t i = 0; i < frameEndInfo->layerCount; ++i) {
+    if (frameEndInfo->layers[i]->type != XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+      continue;
+    }
+    auto projection =
+      (const XrCompositionLayerProjection*)frameEndInfo->layers[i];
+    for (uint32_t j = 0;
+         j < std::min(projection->viewCount, MOCK_MAX_VIEW_COUNT);
+         ++j) {
+      if (memcmp(&projection->views[j].pose,
+                 &located->poses[j],
+                 sizeof(XrPosef)) != 0) {
+        fprintf(stderr,
+                "xrEndFrame: view %u is not the pose of the last "
+                "xrLocateViews (%u locates)\n",
+                j,
+                located->locateCount);
+        abort();
+      }
+    }
+  }
+}
+
+static XrResult XRAPI_CALL
+mock_xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo)
+{
+  auto mock = (MockSession*)session;
+  std::lock_guard<std::mutex> lock(mock->frameMutex);
+  if (!mock->running) {
+    return XR_ERROR_SESSION_NOT_RUNNING;
+  }
+  if (!mock->frameBegun) {
+    return XR_ERROR_CALL_ORDER_INVALID;
+  }
+  if (frameEndInfo->layerCount > MOCK_MAX_LAYER_COUNT) {
+    return XR_ERROR_LAYER_LIMIT_EXCEEDED;
+  }
+  for (uint32_t i = 0; i < frameEndInfo->layerCount; ++i) {
+    if (!frameEndInfo->layers[i] ||
+        !MockIsLayerValid(frameEndInfo->layers[i])) {
+      return XR_ERROR_LAYER_INVALID;
+    }
+  }
+  if (mock->instance->config.validate) {
+    MockValidateProjectionPoses(mock, frameEndInfo);
+  }
+  mock->frameBegun = false;
+  ++mock->endedFrames;
+
+  // scripted session state
+  auto& script = mock->instance->config.script;
+  while (mock->scriptIndex < script.size() &&
+         script[mock->scriptIndex].frame <= mock->endedFrames) {
+    auto state = script[mock->scriptIndex++].state;
+    if (state == XR_SESSION_STATE_STOPPING) {
+      MockStopSession(mock);
+    } else if (state != mock->state) {
+      mock->SetState(state);
+    }
+  }
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrLocateViews(XrSession session,
+                   const XrViewLocateInfo* viewLocateInfo,
+                   XrViewState* viewState,
+                   uint32_t viewCapacityInput,
+                   uint32_t* viewCountOutput,
+                   XrView* views)
+{
+  auto viewCount = MockViewCount(viewLocateInfo->viewConfigurationType);
+  if (!viewCount) {
+    return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+  }
+  auto mock = (MockSession*)session;
+  *viewCountOutput = viewCount;
+  if (viewCapacityInput == 0) {
+    return XR_SUCCESS;
+  }
+  if (viewCapacityInput < viewCount) {
+    return XR_ERROR_SIZE_INSUFFICIENT;
+  }
+
+  if (auto& replay = mock->instance->replay) {
+    // the views of the capture, whatever space is asked
+    uint64_t frame;
+    uint32_t n;
+    {
+      std::lock_guard<std::mutex> lock(mock->frameMutex);
+      auto& replayFrame = mock->ReplayFrameAt(viewLocateInfo->displayTime);
+      frame = replayFrame.frame;
+      n = replayFrame.views++;
+    }
+    // xrfw records the submitted views once, a late latched frame locates
+    // them twice. the last record answers the later locates
+    const XrfwCaptureRecordHeader* record = nullptr;
+    for (uint32_t i = 0; i <= n; ++i) {
+      auto found = replay->Find(frame, XRFW_CAPTURE_VIEWS, i);
+      if (!found) {
+        break;
+      }
+      record = found;
+    }
+    if (record) {
+      auto captured = XrfwCaptureReader::Payload<XrfwCaptureViews>(record);
+      auto capturedViews = (const XrfwCaptureView*)(captured + 1);
+      for (uint32_t i = 0; i < std::min(viewCount, captured->viewCount); ++i) {
+        views[i].pose = capturedViews[i].pose;
+        views[i].fov = capturedViews[i].fov;
+      }
+      viewState->viewStateFlags = captured->viewStateFlags;
+      return XR_SUCCESS;
+    }
+  }
+
+  auto time = viewLocateInfo->displayTime;
+  auto base = ((MockSpace*)viewLocateInfo->space)->PoseInStage(time);
+  auto head = PoseMultiply(PoseInvert(base), mock->HeadPose(time));
+  MockSession::LocatedViews* located = nullptr;
+  std::unique_lock<std::mutex> lock(mock->frameMutex, std::defer_lock);
+  if (mock->instance->config.validate) {
+    lock.lock();
+    located = mock->FindLocatedViews(time);
+    if (!located) {
+      located = &mock->locatedViews[mock->nextLocatedViews++ %
+                                    mock->locatedViews.size()];
+      *located = { .displayTime = time };
+    }
+    if (auto relocates = located->locateCount++) {
+      // a later prediction of the same display time
+      auto yaw = relocates * MOCK_RELOCATE_YAW_DEG *
+                 std::numbers::pi_v<float> / 180.0f;
+      head = PoseMultiply(head, { QuatFromYaw(yaw), { 0, 0, 0 } });
+    }
+  }
+  for (uint32_t i = 0; i < viewCount; ++i) {
+    // mono is centered. quad views 2, 3 are the 20 degree insets
+    float eye = viewCount == 1 ? 0 : ((i % 2 == 0 ? -0.5f : 0.5f) * MOCK_IPD);
+    float halfFov =
+      (i < 2 ? 45.0f : 20.0f) * std::numbers::pi_v<float> / 180.0f;
+    views[i].pose = PoseMultiply(head, { { 0, 0, 0, 1 }, { eye, 0, 0 } });
+    views[i].fov = { -halfFov, halfFov, halfFov, -halfFov };
+    if (located) {
+      located->poses[i] = views[i].pose;
+    }
+  }
+  viewState->viewStateFlags =
+    XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_VALID_BIT |
+    XR_VIEW_STATE_ORIENTATION_TRACKED_BIT | XR_VIEW_STATE_POSITION_TRACKED_BIT;
+  return XR_SUCCESS;
+}
+
+//
+// XR_EXT_hand_tracking
+//
+static XrResult XRAPI_CALL
+mock_xrCreateHandTrackerEXT(XrSession session,
+                            const XrHandTrackerCreateInfoEXT* createInfo,
+                            XrHandTrackerEXT* handTracker)
+{
+  *handTracker = (XrHandTrackerEXT) new MockHandTracker{
+    .session = (MockSession*)session,
+    .hand = createInfo->hand,
+  };
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrDestroyHandTrackerEXT(XrHandTrackerEXT handTracker)
+{
+  delete (MockHandTracker*)handTracker;
+  return XR_SUCCESS;
+}
+
+// Hands circle in front of the head. Joints are laid out along +Z of the
+// palm, 1cm apart.
+static XrResult XRAPI_CALL
+mock_xrLocateHandJointsEXT(XrHandTrackerEXT handTracker,
+                           const XrHandJointsLocateInfoEXT* locateInfo,
+                           XrHandJointLocationsEXT* locations)
+{
+  auto mock = (MockHandTracker*)handTracker;
+  auto session = mock->session;
+  auto& replay = session->instance->replay;
+  if (replay && replay->hasHandJoints) {
+    // inactive if the hand was not located in the frame
+    locations->isActive = XR_FALSE;
+    auto frame = session->ReplayFrameIndexAt(locateInfo->time);
+    for (uint32_t n = 0;; ++n) {
+      auto record = replay->Find(frame, XRFW_CAPTURE_HAND_JOINTS, n);
+      if (!record) {
+        break;
+      }
+      auto captured = XrfwCaptureReader::Payload<XrfwCaptureHandJoints>(record);
+      if (captured->hand != mock->hand) {
+        continue;
+      }
+      locations->isActive = captured->isActive;
+      std::copy_n((const XrHandJointLocationEXT*)(captured + 1),
+                  std::min(locations->jointCount, captured->jointCount),
+                  locations->jointLocations);
+      break;
+    }
+    return XR_SUCCESS;
+  }
+  auto seconds = static_cast<double>(locateInfo->time - session->epoch) * 1e-9;
+  auto angle = static_cast<float>(2 * std::numbers::pi * 0.5 * seconds);
+  float side = mock->hand == XR_HAND_LEFT_EXT ? -1.0f : 1.0f;
+  XrPosef palm{
+    QuatFromYaw(side * 0.3f),
+    {
+      side * 0.2f + 0.05f * cosf(angle),
+      MOCK_HEAD_HEIGHT - 0.3f + 0.05f * sinf(angle),
+      -0.4f,
+    },
+  };
+  auto base = ((MockSpace*)locateInfo->baseSpace)->PoseInStage(locateInfo->time);
+  auto inv = PoseInvert(base);
+
+  locations->isActive = XR_TRUE;
+  for (uint32_t i = 0; i < locations->jointCount; ++i) {
+    auto& joint = locations->jointLocations[i];
+    joint.pose = PoseMultiply(
+      inv,
+      PoseMultiply(palm, { { 0, 0, 0, 1 }, { 0, 0, -0.01f * float(i) } }));
+    joint.radius = 0.01f;
+    joint.locationFlags = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT |
+                          XR_SPACE_LOCATION_POSITION_VALID_BIT |
+                          XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT |
+                          XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+  }
+  return XR_SUCCESS;
+}
+
+//
+// XR_FB_body_tracking. replay only, inactive otherwise
+//
+static XrResult XRAPI_CALL
+mock_xrCreateBodyTrackerFB(XrSession session,
+                           const XrBodyTrackerCreateInfoFB* createInfo,
+                           XrBodyTrackerFB* bodyTracker)
+{
+  *bodyTracker = (XrBodyTrackerFB) new MockBodyTracker{
+    .session = (MockSession*)session,
+  };
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrDestroyBodyTrackerFB(XrBodyTrackerFB bodyTracker)
+{
+  delete (MockBodyTracker*)bodyTracker;
+  return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL
+mock_xrLocateBodyJointsFB(XrBodyTrackerFB bodyTracker,
+                          const XrBodyJointsLocateInfoFB* locateInfo,
+                          XrBodyJointLocationsFB* locations)
+{
+  auto session = ((MockBodyTracker*)bodyTracker)->session;
+  locations->isActive = XR_FALSE;
+  locations->time = locateInfo->time;
+  auto& replay = session->instance->replay;
+  if (!replay || !replay->hasBodyJoints) {
+    return XR_SUCCESS;
+  }
+  if (auto record =
+        replay->Find(session->ReplayFrameIndexAt(locateInfo->time),
+                     XRFW_CAPTURE_BODY_JOINTS)) {
+    auto captured = XrfwCaptureReader::Payload<XrfwCaptureBodyJoints>(record);
+    locations->isActive = captured->isActive;
+    locations->confidence = captured->confidence;
+    locations->skeletonChangedCount = captured->skeletonChangedCount;
+    std::copy_n((const XrBodyJointLocationFB*)(captured + 1),
+                std::min(locations->jointCount, captured->jointCount),
+                locations->jointLocations);
+  }
+  return XR_SUCCESS;
+}
+
+// the capture has no skeleton. every joint at the origin of its parent
+static XrResult XRAPI_CALL
+mock_xrGetBodySkeletonFB(XrBodyTrackerFB bodyTracker,
+                         XrBodySkeletonFB* skeleton)
+{
+  for (uint32_t i = 0; i < skeleton->jointCount; ++i) {
+    skeleton->joints[i] = {
+      .joint = static_cast<int32_t>(i),
+      .parentJoint = static_cast<int32_t>(i) - 1,
+      .pose = IDENTITY_POSE,
+    };
+  }
+  return XR_SUCCESS;
+}
+
+//
+// dispatch
+//
+#define MOCK_PROC(name)                                                        \
+  { #name, (PFN_xrVoidFunction)&mock_##name }
+
+struct MockProc
+{
+  const char* name;
+  PFN_xrVoidFunction function;
+};
+
+static const MockProc MOCK_PROCS[] = {
+  MOCK_PROC(xrGetInstanceProcAddr),
+  MOCK_PROC(xrEnumerateInstanceExtensionProperties),
+  MOCK_PROC(xrCreateInstance),
+  MOCK_PROC(xrDestroyInstance),
+  MOCK_PROC(xrGetInstanceProperties),
+  MOCK_PROC(xrPollEvent),
+  MOCK_PROC(xrResultToString),
+  MOCK_PROC(xrStructureTypeToString),
+  MOCK_PROC(xrGetSystem),
+  MOCK_PROC(xrGetSystemProperties),
+  MOCK_PROC(xrEnumerateViewConfigurations),
+  MOCK_PROC(xrGetViewConfigurationProperties),
+  MOCK_PROC(xrEnumerateViewConfigurationViews),
+  MOCK_PROC(xrEnumerateEnvironmentBlendModes),
+  MOCK_PROC(xrGetOpenGLGraphicsRequirementsKHR),
+  MOCK_PROC(xrGetOpenGLESGraphicsRequirementsKHR),
+  MOCK_PROC(xrCreateSession),
+  MOCK_PROC(xrDestroySession),
+  MOCK_PROC(xrBeginSession),
+  MOCK_PROC(xrEndSession),
+  MOCK_PROC(xrRequestExitSession),
+  MOCK_PROC(xrEnumerateReferenceSpaces),
+  MOCK_PROC(xrCreateReferenceSpace),
+  MOCK_PROC(xrDestroySpace),
+  MOCK_PROC(xrLocateSpace),
+#ifdef XR_KHR_locate_spaces
+  MOCK_PROC(xrLocateSpacesKHR),
+#endif
+  MOCK_PROC(xrEnumerateSwapchainFormats),
+  MOCK_PROC(xrCreateSwapchain),
+  MOCK_PROC(xrDestroySwapchain),
+  MOCK_PROC(xrEnumerateSwapchainImages),
+  MOCK_PROC(xrAcquireSwapchainImage),
+  MOCK_PROC(xrWaitSwapchainImage),
+  MOCK_PROC(xrReleaseSwapchainImage),
+  MOCK_PROC(xrWaitFrame),
+  MOCK_PROC(xrBeginFrame),
+  MOCK_PROC(xrEndFrame),
+  MOCK_PROC(xrLocateViews),
+  MOCK_PROC(xrCreateHandTrackerEXT),
+  MOCK_PROC(xrDestroyHandTrackerEXT),
+  MOCK_PROC(xrLocateHandJointsEXT),
+  MOCK_PROC(xrCreateBodyTrackerFB),
+  MOCK_PROC(xrDestroyBodyTrackerFB),
+  MOCK_PROC(xrLocateBodyJointsFB),
+  MOCK_PROC(xrGetBodySkeletonFB),
+};
+
+static XrResult XRAPI_CALL
+mock_xrGetInstanceProcAddr(XrInstance instance,
+                           const char* name,
+                           PFN_xrVoidFunction* function)
+{
+  for (auto& proc : MOCK_PROCS) {
+    if (!strcmp(proc.name, name)) {
+      *function = proc.function;
+      return XR_SUCCESS;
+    }
+  }
+  *function = nullptr;
+  return XR_ERROR_FUNCTION_UNSUPPORTED;
+}
+
+MOCK_EXPORT XrResult XRAPI_CALL
+xrNegotiateLoaderRuntimeInterface(const XrNegotiateLoaderInfo* loaderInfo,
+                                  XrNegotiateRuntimeRequest* runtimeRequest)
+{
+  if (!loaderInfo || !runtimeRequest ||
+      loaderInfo->structType != XR_LOADER_INTERFACE_STRUCT_LOADER_INFO ||
+      runtimeRequest->structType !=
+        XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST ||
+      loaderInfo->minInterfaceVersion > XR_CURRENT_LOADER_RUNTIME_VERSION ||
+      loaderInfo->maxInterfaceVersion < XR_CURRENT_LOADER_RUNTIME_VERSION) {
+    return XR_ERROR_INITIALIZATION_FAILED;
+  }
+  runtimeRequest->runtimeInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+  runtimeRequest->runtimeApiVersion = XR_CURRENT_API_VERSION;
+  runtimeRequest->getInstanceProcAddr = &mock_xrGetInstanceProcAddr;
+  return XR_SUCCESS;
+}
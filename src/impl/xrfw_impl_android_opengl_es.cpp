@@ -323,6 +323,16 @@ struct PlatformImpl {
     return true;
   }
 
+  void WaitEvent(std::chrono::milliseconds timeout) {
+    int events;
+    struct android_poll_source *source;
+    if (ALooper_pollAll(static_cast<int>(timeout.count()), nullptr, &events,
+                        (void **)&source) >= 0 &&
+        source) {
+      source->process(app_, source);
+    }
+  }
+
   void handle_android_cmd(struct android_app *app, int32_t cmd) {
     switch (cmd) {
     // There is no APP_CMD_CREATE. The ANativeActivity creates the
@@ -396,8 +406,13 @@ bool XrfwPlatformAndroidOpenGLES::BeginFrame() { return impl_->BeginFrame(); }
 void XrfwPlatformAndroidOpenGLES::EndFrame(RenderFunc render, void *user) {}
 uint32_t XrfwPlatformAndroidOpenGLES::CastTexture(
     const XrSwapchainImageBaseHeader *swapchainImage) {
+  if (!swapchainImage) {
+    return {};
+  }
   return reinterpret_cast<const XrSwapchainImageOpenGLESKHR *>(swapchainImage)
       ->image;
 }
-void XrfwPlatformAndroidOpenGLES::Sleep(std::chrono::milliseconds ms) {}
+void XrfwPlatformAndroidOpenGLES::WaitEvent(std::chrono::milliseconds timeout) {
+  impl_->WaitEvent(timeout);
+}
 #endif
\ No newline at end of file
@@ -0,0 +1,128 @@
+#ifdef XR_USE_PLATFORM_EGL
+#include <xrfw_impl_linux_egl.h>
+
+#include <EGL/egl.h>
+#include <GLES3/gl32.h>
+#include <openxr/openxr_platform.h>
+#include <plog/Log.h>
+#include <util_egl.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <xrfw.h>
+
+struct PlatformLinuxEGLImpl
+{
+  XrGraphicsRequirementsOpenGLESKHR graphicsRequirements_ = {
+    .type = XR_TYPE_GRAPHICS_REQUIREMENTS_OPENGL_ES_KHR,
+  };
+  bool initialized_ = false;
+  // RequestExit may come from another thread
+  std::mutex mutex_;
+  std::condition_variable exitCondition_;
+  bool exit_ = false;
+
+  ~PlatformLinuxEGLImpl()
+  {
+    if (initialized_) {
+      egl_terminate();
+    }
+  }
+
+  bool InitializeGraphics()
+  {
+    // The pbuffer is never presented. It only makes the context current,
+    // rendering goes to the swapchain images.
+    if (egl_init_with_pbuffer_surface(3, 24, 0, 0, 16, 16) != 0) {
+      PLOG_FATAL << "egl_init_with_pbuffer_surface";
+      return false;
+    }
+    initialized_ = true;
+    PLOG_INFO << glGetString(GL_VERSION);
+    return true;
+  }
+
+  XrSession CreateSession(XrfwSwapchains* swapchains)
+  {
+    return xrfwCreateSessionLinuxEGL(
+      swapchains, egl_get_display(), egl_get_config(), egl_get_context());
+  }
+
+  bool IsExitRequested()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return exit_;
+  }
+
+  // RequestExit is the only platform event
+  void WaitEvent(std::chrono::milliseconds timeout)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    exitCondition_.wait_for(lock, timeout, [this] { return exit_; });
+  }
+
+  void RequestExit()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      exit_ = true;
+    }
+    exitCondition_.notify_all();
+  }
+};
+
+XrfwPlatformLinuxEGL::XrfwPlatformLinuxEGL(struct android_app*)
+  : impl_(new PlatformLinuxEGLImpl)
+{
+}
+XrfwPlatformLinuxEGL::~XrfwPlatformLinuxEGL()
+{
+  delete impl_;
+}
+bool
+XrfwPlatformLinuxEGL::InitializeLoader()
+{
+  return true;
+}
+XrInstance
+XrfwPlatformLinuxEGL::CreateInstance()
+{
+  xrfwInitExtensionsLinuxEGL(&impl_->graphicsRequirements_);
+  return xrfwCreateInstance();
+}
+bool
+XrfwPlatformLinuxEGL::InitializeGraphics()
+{
+  return impl_->InitializeGraphics();
+}
+XrSession
+XrfwPlatformLinuxEGL::CreateSession(XrfwSwapchains* swapchains)
+{
+  return impl_->CreateSession(swapchains);
+}
+bool
+XrfwPlatformLinuxEGL::BeginFrame()
+{
+  return !impl_->IsExitRequested();
+}
+void
+XrfwPlatformLinuxEGL::EndFrame(RenderFunc render, void* user)
+{
+}
+uint32_t
+XrfwPlatformLinuxEGL::CastTexture(
+  const XrSwapchainImageBaseHeader* swapchainImage)
+{
+  return xrfwCastTextureLinuxEGL(swapchainImage);
+}
+void
+XrfwPlatformLinuxEGL::WaitEvent(std::chrono::milliseconds timeout)
+{
+  impl_->WaitEvent(timeout);
+}
+void
+XrfwPlatformLinuxEGL::RequestExit()
+{
+  impl_->RequestExit();
+}
+#endif
@@ -170,9 +170,10 @@ XrfwPlatformWin32D3D11::EndFrame(RenderFunc render, void* user)
 {
 }
 void
-XrfwPlatformWin32D3D11::Sleep(std::chrono::milliseconds ms)
+XrfwPlatformWin32D3D11::WaitEvent(std::chrono::milliseconds timeout)
 {
-  {};
+  MsgWaitForMultipleObjects(
+    0, nullptr, FALSE, static_cast<DWORD>(timeout.count()), QS_ALLINPUT);
 }
 #endif
 #endif
@@ -155,6 +155,10 @@ struct PlatformWin32OpenGLImpl
 
   void EndFrame(RenderFunc render, void* user)
   {
+    if (!render) {
+      glfwSwapBuffers(window_);
+      return;
+    }
     XrfwSwapchains info{
       .format = 0,
       .width = camera.width,
@@ -211,8 +215,8 @@ XrfwPlatformWin32OpenGL::CastTexture(
     ->image;
 }
 void
-XrfwPlatformWin32OpenGL::Sleep(std::chrono::milliseconds ms)
+XrfwPlatformWin32OpenGL::WaitEvent(std::chrono::milliseconds timeout)
 {
-  ::Sleep((uint32_t)ms.count());
+  glfwWaitEventsTimeout(timeout.count() / 1000.0);
 }
 #endif
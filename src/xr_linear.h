@@ -105,6 +105,34 @@ inline static void XrMatrix4x4f_TransformBounds(XrVector3f* resultMins, XrVector
                                                 const XrVector3f* mins, const XrVector3f* maxs);
 inline static bool XrMatrix4x4f_CullBounds(const XrMatrix4x4f* mvp, const XrVector3f* mins, const XrVector3f* maxs);
 
+SIMD
+====
+
+XrMatrix4x4f_Multiply, XrMatrix4x4f_Invert, XrMatrix4x4f_InvertRigidBody, XrMatrix4x4f_CreateFromQuaternion and
+XrMatrix4x4f_TransformVector3f use SSE2 or NEON when the target has it (XR_LINEAR_SIMD is defined). Define
+XR_LINEAR_NO_SIMD to build the scalar C versions only. The scalar versions stay available as the reference:
+
+inline static void XrMatrix4x4f_Multiply_Scalar(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b);
+inline static void XrMatrix4x4f_Invert_Scalar(XrMatrix4x4f* result, const XrMatrix4x4f* src);
+inline static void XrMatrix4x4f_InvertRigidBody_Scalar(XrMatrix4x4f* result, const XrMatrix4x4f* src);
+inline static void XrMatrix4x4f_CreateFromQuaternion_Scalar(XrMatrix4x4f* result, const XrQuaternionf* src);
+inline static void XrMatrix4x4f_TransformVector3f_Scalar(XrVector3f* result, const XrMatrix4x4f* m, const XrVector3f* v);
+
+CONSTEXPR
+=========
+
+In C++20 all functions above are constexpr (XR_LINEAR_CONSTEXPR), so fixed matrices and tables can be computed at
+compile time:
+
+    constexpr XrMatrix4x4f projection = [] {
+        XrMatrix4x4f m{};
+        XrMatrix4x4f_CreateProjectionFov(&m, GRAPHICS_OPENGL, fov, 0.05f, 100.0f);
+        return m;
+    }();
+
+At compile time the SIMD versions fall back to the scalar ones, and sqrtf, sinf, cosf, tanf and fabsf to the
+XrMath_* versions, which agree with the C library within a float ulp. At run time nothing changes.
+
 ================================================================================================
 */
 
@@ -112,6 +140,28 @@ inline static bool XrMatrix4x4f_CullBounds(const XrMatrix4x4f* mvp, const XrVect
 #include <math.h>
 #include <stdbool.h>
 
+#if !defined(XR_LINEAR_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XR_LINEAR_SIMD
+#define XR_LINEAR_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define XR_LINEAR_SIMD
+#define XR_LINEAR_NEON
+#endif
+#endif
+
+#if defined(__cplusplus) && (__cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L))
+#include <limits>
+#include <type_traits>
+#define XR_LINEAR_CONSTEXPR constexpr
+#define XR_LINEAR_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#else
+#define XR_LINEAR_CONSTEXPR
+#define XR_LINEAR_IS_CONSTANT_EVALUATED() false
+#endif
+
 #define MATH_PI 3.14159265358979323846f
 
 #define DEFAULT_NEAR_Z 0.015625f  // exact floating point representation
@@ -133,90 +183,217 @@ typedef struct XrMatrix4x4f {
     float m[16];
 } XrMatrix4x4f;
 
-inline static float XrRcpSqrt(const float x) {
+#if defined(XR_LINEAR_SIMD)
+// A column or a row of 4 floats. Only plain multiplies and adds, no fused multiply-add, so the
+// SIMD versions round like the scalar ones where they do the same operations in the same order.
+#if defined(XR_LINEAR_SSE2)
+typedef __m128 XrSimd4f;
+
+inline static XrSimd4f XrSimd4f_Load(const float* p) { return _mm_loadu_ps(p); }
+inline static void XrSimd4f_Store(float* p, const XrSimd4f v) { _mm_storeu_ps(p, v); }
+inline static XrSimd4f XrSimd4f_Set(const float x, const float y, const float z, const float w) { return _mm_setr_ps(x, y, z, w); }
+inline static XrSimd4f XrSimd4f_Splat(const float x) { return _mm_set1_ps(x); }
+inline static XrSimd4f XrSimd4f_Add(const XrSimd4f a, const XrSimd4f b) { return _mm_add_ps(a, b); }
+inline static XrSimd4f XrSimd4f_Sub(const XrSimd4f a, const XrSimd4f b) { return _mm_sub_ps(a, b); }
+inline static XrSimd4f XrSimd4f_Mul(const XrSimd4f a, const XrSimd4f b) { return _mm_mul_ps(a, b); }
+// (a[x], a[y], b[z], b[w]). The lanes are constants.
+#define XrSimd4f_Shuffle(a, b, x, y, z, w) _mm_shuffle_ps((a), (b), _MM_SHUFFLE((w), (z), (y), (x)))
+#else
+typedef float32x4_t XrSimd4f;
+
+inline static XrSimd4f XrSimd4f_Load(const float* p) { return vld1q_f32(p); }
+inline static void XrSimd4f_Store(float* p, const XrSimd4f v) { vst1q_f32(p, v); }
+inline static XrSimd4f XrSimd4f_Set(const float x, const float y, const float z, const float w) {
+    const float v[4] = {x, y, z, w};
+    return vld1q_f32(v);
+}
+inline static XrSimd4f XrSimd4f_Splat(const float x) { return vdupq_n_f32(x); }
+inline static XrSimd4f XrSimd4f_Add(const XrSimd4f a, const XrSimd4f b) { return vaddq_f32(a, b); }
+inline static XrSimd4f XrSimd4f_Sub(const XrSimd4f a, const XrSimd4f b) { return vsubq_f32(a, b); }
+inline static XrSimd4f XrSimd4f_Mul(const XrSimd4f a, const XrSimd4f b) { return vmulq_f32(a, b); }
+// (a[x], a[y], b[z], b[w]). The lanes are constants.
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 12)
+#define XrSimd4f_Shuffle(a, b, x, y, z, w) __builtin_shufflevector((a), (b), (x), (y), (z) + 4, (w) + 4)
+#else
+#define XrSimd4f_Shuffle(a, b, x, y, z, w) \
+    XrSimd4f_Set(vgetq_lane_f32((a), (x)), vgetq_lane_f32((a), (y)), vgetq_lane_f32((b), (z)), vgetq_lane_f32((b), (w)))
+#endif
+#endif
+#endif
+
+#if defined(__cplusplus) && (__cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L))
+// The C library at run time. At compile time Newton-Raphson and Taylor series in double, rounded to float.
+inline static constexpr float XrMath_Fabs(const float x) {
+    if (std::is_constant_evaluated()) {
+        return (x < 0.0f) ? -x : x;
+    }
+    return fabsf(x);
+}
+
+inline static constexpr float XrMath_Sqrt(const float x) {
+    if (std::is_constant_evaluated()) {
+        if (x < 0.0f) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+        if (x == 0.0f || x > std::numeric_limits<float>::max()) {
+            return x;
+        }
+        // Decreases monotonically from above the root until it stops changing.
+        const double d = x;
+        double root = (d > 1.0) ? d : 1.0;
+        for (;;) {
+            const double next = 0.5 * (root + d / root);
+            if (next >= root) {
+                break;
+            }
+            root = next;
+        }
+        return static_cast<float>(root);
+    }
+    return sqrtf(x);
+}
+
+// Reduced to [-pi, pi].
+inline static constexpr double XrMath_ReduceAngle(const double x) {
+    const double twoPi = 6.283185307179586476925286766559;
+    const double turns = x / twoPi;
+    const double k = static_cast<double>(static_cast<long long>(turns + ((turns < 0.0) ? -0.5 : 0.5)));
+    return x - k * twoPi;
+}
+
+inline static constexpr double XrMath_SinSeries(const double r) {
+    double term = r;
+    double sum = r;
+    for (int n = 1; n < 24; n++) {
+        term *= -r * r / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+inline static constexpr double XrMath_CosSeries(const double r) {
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 24; n++) {
+        term *= -r * r / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+inline static constexpr float XrMath_Sin(const float x) {
+    if (std::is_constant_evaluated()) {
+        return static_cast<float>(XrMath_SinSeries(XrMath_ReduceAngle(x)));
+    }
+    return sinf(x);
+}
+
+inline static constexpr float XrMath_Cos(const float x) {
+    if (std::is_constant_evaluated()) {
+        return static_cast<float>(XrMath_CosSeries(XrMath_ReduceAngle(x)));
+    }
+    return cosf(x);
+}
+
+inline static constexpr float XrMath_Tan(const float x) {
+    if (std::is_constant_evaluated()) {
+        const double r = XrMath_ReduceAngle(x);
+        return static_cast<float>(XrMath_SinSeries(r) / XrMath_CosSeries(r));
+    }
+    return tanf(x);
+}
+#else
+inline static float XrMath_Fabs(const float x) { return fabsf(x); }
+inline static float XrMath_Sqrt(const float x) { return sqrtf(x); }
+inline static float XrMath_Sin(const float x) { return sinf(x); }
+inline static float XrMath_Cos(const float x) { return cosf(x); }
+inline static float XrMath_Tan(const float x) { return tanf(x); }
+#endif
+
+inline static XR_LINEAR_CONSTEXPR float XrRcpSqrt(const float x) {
     const float SMALLEST_NON_DENORMAL = 1.1754943508222875e-038f;  // ( 1U << 23 )
-    const float rcp = (x >= SMALLEST_NON_DENORMAL) ? 1.0f / sqrtf(x) : 1.0f;
+    const float rcp = (x >= SMALLEST_NON_DENORMAL) ? 1.0f / XrMath_Sqrt(x) : 1.0f;
     return rcp;
 }
 
-inline static void XrVector3f_Set(XrVector3f* v, const float value) {
+inline static XR_LINEAR_CONSTEXPR void XrVector3f_Set(XrVector3f* v, const float value) {
     v->x = value;
     v->y = value;
     v->z = value;
 }
 
-inline static void XrVector3f_Add(XrVector3f* result, const XrVector3f* a, const XrVector3f* b) {
+inline static XR_LINEAR_CONSTEXPR void XrVector3f_Add(XrVector3f* result, const XrVector3f* a, const XrVector3f* b) {
     result->x = a->x + b->x;
     result->y = a->y + b->y;
     result->z = a->z + b->z;
 }
 
-inline static void XrVector3f_Sub(XrVector3f* result, const XrVector3f* a, const XrVector3f* b) {
+inline static XR_LINEAR_CONSTEXPR void XrVector3f_Sub(XrVector3f* result, const XrVector3f* a, const XrVector3f* b) {
     result->x = a->x - b->x;
     result->y = a->y - b->y;
     result->z = a->z - b->z;
 }
 
-inline static void XrVector3f_Min(XrVector3f* result, const XrVector3f* a, const XrVector3f* b) {
+inline static XR_LINEAR_CONSTEXPR void XrVector3f_Min(XrVector3f* result, const XrVector3f* a, const XrVector3f* b) {
     result->x = (a->x < b->x) ? a->x : b->x;
     result->y = (a->y < b->y) ? a->y : b->y;
     result->z = (a->z < b->z) ? a->z : b->z;
 }
 
-inline static void XrVector3f_Max(XrVector3f* result, const XrVector3f* a, const XrVector3f* b) {
+inline static XR_LINEAR_CONSTEXPR void XrVector3f_Max(XrVector3f* result, const XrVector3f* a, const XrVector3f* b) {
     result->x = (a->x > b->x) ? a->x : b->x;
     result->y = (a->y > b->y) ? a->y : b->y;
     result->z = (a->z > b->z) ? a->z : b->z;
 }
 
-inline static void XrVector3f_Decay(XrVector3f* result, const XrVector3f* a, const float value) {
-    result->x = (fabsf(a->x) > value) ? ((a->x > 0.0f) ? (a->x - value) : (a->x + value)) : 0.0f;
-    result->y = (fabsf(a->y) > value) ? ((a->y > 0.0f) ? (a->y - value) : (a->y + value)) : 0.0f;
-    result->z = (fabsf(a->z) > value) ? ((a->z > 0.0f) ? (a->z - value) : (a->z + value)) : 0.0f;
+inline static XR_LINEAR_CONSTEXPR void XrVector3f_Decay(XrVector3f* result, const XrVector3f* a, const float value) {
+    result->x = (XrMath_Fabs(a->x) > value) ? ((a->x > 0.0f) ? (a->x - value) : (a->x + value)) : 0.0f;
+    result->y = (XrMath_Fabs(a->y) > value) ? ((a->y > 0.0f) ? (a->y - value) : (a->y + value)) : 0.0f;
+    result->z = (XrMath_Fabs(a->z) > value) ? ((a->z > 0.0f) ? (a->z - value) : (a->z + value)) : 0.0f;
 }
 
-inline static void XrVector3f_Lerp(XrVector3f* result, const XrVector3f* a, const XrVector3f* b, const float fraction) {
+inline static XR_LINEAR_CONSTEXPR void XrVector3f_Lerp(XrVector3f* result, const XrVector3f* a, const XrVector3f* b, const float fraction) {
     result->x = a->x + fraction * (b->x - a->x);
     result->y = a->y + fraction * (b->y - a->y);
     result->z = a->z + fraction * (b->z - a->z);
 }
 
-inline static void XrVector3f_Scale(XrVector3f* result, const XrVector3f* a, const float scaleFactor) {
+inline static XR_LINEAR_CONSTEXPR void XrVector3f_Scale(XrVector3f* result, const XrVector3f* a, const float scaleFactor) {
     result->x = a->x * scaleFactor;
     result->y = a->y * scaleFactor;
     result->z = a->z * scaleFactor;
 }
 
-inline static float XrVector3f_Dot(const XrVector3f* a, const XrVector3f* b) { return a->x * b->x + a->y * b->y + a->z * b->z; }
+inline static XR_LINEAR_CONSTEXPR float XrVector3f_Dot(const XrVector3f* a, const XrVector3f* b) { return a->x * b->x + a->y * b->y + a->z * b->z; }
 
 // Compute cross product, which generates a normal vector.
 // Direction vector can be determined by right-hand rule: Pointing index finder in
 // direction a and middle finger in direction b, thumb will point in Cross(a, b).
-inline static void XrVector3f_Cross(XrVector3f* result, const XrVector3f* a, const XrVector3f* b) {
+inline static XR_LINEAR_CONSTEXPR void XrVector3f_Cross(XrVector3f* result, const XrVector3f* a, const XrVector3f* b) {
     result->x = a->y * b->z - a->z * b->y;
     result->y = a->z * b->x - a->x * b->z;
     result->z = a->x * b->y - a->y * b->x;
 }
 
-inline static void XrVector3f_Normalize(XrVector3f* v) {
+inline static XR_LINEAR_CONSTEXPR void XrVector3f_Normalize(XrVector3f* v) {
     const float lengthRcp = XrRcpSqrt(v->x * v->x + v->y * v->y + v->z * v->z);
     v->x *= lengthRcp;
     v->y *= lengthRcp;
     v->z *= lengthRcp;
 }
 
-inline static float XrVector3f_Length(const XrVector3f* v) { return sqrtf(v->x * v->x + v->y * v->y + v->z * v->z); }
+inline static XR_LINEAR_CONSTEXPR float XrVector3f_Length(const XrVector3f* v) { return XrMath_Sqrt(v->x * v->x + v->y * v->y + v->z * v->z); }
 
-inline static void XrQuaternionf_CreateFromAxisAngle(XrQuaternionf* result, const XrVector3f* axis, const float angleInRadians) {
-    float s = sinf(angleInRadians / 2.0f);
+inline static XR_LINEAR_CONSTEXPR void XrQuaternionf_CreateFromAxisAngle(XrQuaternionf* result, const XrVector3f* axis, const float angleInRadians) {
+    float s = XrMath_Sin(angleInRadians / 2.0f);
     float lengthRcp = XrRcpSqrt(axis->x * axis->x + axis->y * axis->y + axis->z * axis->z);
     result->x = s * axis->x * lengthRcp;
     result->y = s * axis->y * lengthRcp;
     result->z = s * axis->z * lengthRcp;
-    result->w = cosf(angleInRadians / 2.0f);
+    result->w = XrMath_Cos(angleInRadians / 2.0f);
 }
 
-inline static void XrQuaternionf_Lerp(XrQuaternionf* result, const XrQuaternionf* a, const XrQuaternionf* b, const float fraction) {
+inline static XR_LINEAR_CONSTEXPR void XrQuaternionf_Lerp(XrQuaternionf* result, const XrQuaternionf* a, const XrQuaternionf* b, const float fraction) {
     const float s = a->x * b->x + a->y * b->y + a->z * b->z + a->w * b->w;
     const float fa = 1.0f - fraction;
     const float fb = (s < 0.0f) ? -fraction : fraction;
@@ -231,7 +408,7 @@ inline static void XrQuaternionf_Lerp(XrQuaternionf* result, const XrQuaternionf
     result->w = w * lengthRcp;
 }
 
-inline static void XrQuaternionf_Multiply(XrQuaternionf* result, const XrQuaternionf* a, const XrQuaternionf* b) {
+inline static XR_LINEAR_CONSTEXPR void XrQuaternionf_Multiply(XrQuaternionf* result, const XrQuaternionf* a, const XrQuaternionf* b) {
     result->x = (b->w * a->x) + (b->x * a->w) + (b->y * a->z) - (b->z * a->y);
     result->y = (b->w * a->y) - (b->x * a->z) + (b->y * a->w) + (b->z * a->x);
     result->z = (b->w * a->z) + (b->x * a->y) - (b->y * a->x) + (b->z * a->w);
@@ -239,7 +416,7 @@ inline static void XrQuaternionf_Multiply(XrQuaternionf* result, const XrQuatern
 }
 
 // Use left-multiplication to accumulate transformations.
-inline static void XrMatrix4x4f_Multiply(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_Multiply_Scalar(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b) {
     result->m[0] = a->m[0] * b->m[0] + a->m[4] * b->m[1] + a->m[8] * b->m[2] + a->m[12] * b->m[3];
     result->m[1] = a->m[1] * b->m[0] + a->m[5] * b->m[1] + a->m[9] * b->m[2] + a->m[13] * b->m[3];
     result->m[2] = a->m[2] * b->m[0] + a->m[6] * b->m[1] + a->m[10] * b->m[2] + a->m[14] * b->m[3];
@@ -261,8 +438,36 @@ inline static void XrMatrix4x4f_Multiply(XrMatrix4x4f* result, const XrMatrix4x4
     result->m[15] = a->m[3] * b->m[12] + a->m[7] * b->m[13] + a->m[11] * b->m[14] + a->m[15] * b->m[15];
 }
 
+// Use left-multiplication to accumulate transformations.
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_Multiply(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b) {
+#if defined(XR_LINEAR_SIMD)
+    if (XR_LINEAR_IS_CONSTANT_EVALUATED()) {
+        XrMatrix4x4f_Multiply_Scalar(result, a, b);
+        return;
+    }
+    // Each result column is the columns of 'a' weighted by a column of 'b'.
+    const XrSimd4f a0 = XrSimd4f_Load(&a->m[0]);
+    const XrSimd4f a1 = XrSimd4f_Load(&a->m[4]);
+    const XrSimd4f a2 = XrSimd4f_Load(&a->m[8]);
+    const XrSimd4f a3 = XrSimd4f_Load(&a->m[12]);
+    XrSimd4f c[4];
+    for (int i = 0; i < 4; i++) {
+        const float* bc = &b->m[i * 4];
+        const XrSimd4f c01 = XrSimd4f_Add(XrSimd4f_Mul(a0, XrSimd4f_Splat(bc[0])), XrSimd4f_Mul(a1, XrSimd4f_Splat(bc[1])));
+        const XrSimd4f c012 = XrSimd4f_Add(c01, XrSimd4f_Mul(a2, XrSimd4f_Splat(bc[2])));
+        c[i] = XrSimd4f_Add(c012, XrSimd4f_Mul(a3, XrSimd4f_Splat(bc[3])));
+    }
+    XrSimd4f_Store(&result->m[0], c[0]);
+    XrSimd4f_Store(&result->m[4], c[1]);
+    XrSimd4f_Store(&result->m[8], c[2]);
+    XrSimd4f_Store(&result->m[12], c[3]);
+#else
+    XrMatrix4x4f_Multiply_Scalar(result, a, b);
+#endif
+}
+
 // Creates the transpose of the given matrix.
-inline static void XrMatrix4x4f_Transpose(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_Transpose(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
     result->m[0] = src->m[0];
     result->m[1] = src->m[4];
     result->m[2] = src->m[8];
@@ -285,7 +490,7 @@ inline static void XrMatrix4x4f_Transpose(XrMatrix4x4f* result, const XrMatrix4x
 }
 
 // Returns a 3x3 minor of a 4x4 matrix.
-inline static float XrMatrix4x4f_Minor(const XrMatrix4x4f* matrix, int r0, int r1, int r2, int c0, int c1, int c2) {
+inline static XR_LINEAR_CONSTEXPR float XrMatrix4x4f_Minor(const XrMatrix4x4f* matrix, int r0, int r1, int r2, int c0, int c1, int c2) {
     return matrix->m[4 * r0 + c0] *
                (matrix->m[4 * r1 + c1] * matrix->m[4 * r2 + c2] - matrix->m[4 * r2 + c1] * matrix->m[4 * r1 + c2]) -
            matrix->m[4 * r0 + c1] *
@@ -295,7 +500,7 @@ inline static float XrMatrix4x4f_Minor(const XrMatrix4x4f* matrix, int r0, int r
 }
 
 // Calculates the inverse of a 4x4 matrix.
-inline static void XrMatrix4x4f_Invert(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_Invert_Scalar(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
     const float rcpDet =
         1.0f / (src->m[0] * XrMatrix4x4f_Minor(src, 1, 2, 3, 1, 2, 3) - src->m[1] * XrMatrix4x4f_Minor(src, 1, 2, 3, 0, 2, 3) +
                 src->m[2] * XrMatrix4x4f_Minor(src, 1, 2, 3, 0, 1, 3) - src->m[3] * XrMatrix4x4f_Minor(src, 1, 2, 3, 0, 1, 2));
@@ -318,8 +523,68 @@ inline static void XrMatrix4x4f_Invert(XrMatrix4x4f* result, const XrMatrix4x4f*
     result->m[15] = XrMatrix4x4f_Minor(src, 0, 1, 2, 0, 1, 2) * rcpDet;
 }
 
+#if defined(XR_LINEAR_SIMD)
+// (a[i], a[i], a[i], b[i])
+#define XrMatrix4x4f_InvertLanes(a, b, i) \
+    XrSimd4f_Shuffle(XrSimd4f_Shuffle(a, b, i, i, i, i), XrSimd4f_Shuffle(a, b, i, i, i, i), 0, 0, 0, 2)
+// Row 'r' of the upper left 2x4 block: (c1[r], c0[r], c0[r], c0[r])
+#define XrMatrix4x4f_InvertRow(c0, c1, r) \
+    XrSimd4f_Shuffle(XrSimd4f_Shuffle(c1, c0, r, r, r, r), XrSimd4f_Shuffle(c1, c0, r, r, r, r), 0, 2, 2, 2)
+// 2x2 determinants of rows 'i' and 'j', four at a time: (columns 23, columns 23, columns 13, columns 12).
+#define XrMatrix4x4f_InvertFactor(c1, c2, c3, i, j)                                                         \
+    XrSimd4f_Sub(XrSimd4f_Mul(XrSimd4f_Shuffle(c2, c1, i, i, i, i), XrMatrix4x4f_InvertLanes(c3, c2, j)), \
+                 XrSimd4f_Mul(XrMatrix4x4f_InvertLanes(c3, c2, i), XrSimd4f_Shuffle(c2, c1, j, j, j, j)))
+#endif
+
+// Calculates the inverse of a 4x4 matrix.
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_Invert(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
+#if defined(XR_LINEAR_SIMD)
+    if (XR_LINEAR_IS_CONSTANT_EVALUATED()) {
+        XrMatrix4x4f_Invert_Scalar(result, src);
+        return;
+    }
+    // Cofactors from shared 2x2 determinants instead of sixteen 3x3 minors.
+    const XrSimd4f c0 = XrSimd4f_Load(&src->m[0]);
+    const XrSimd4f c1 = XrSimd4f_Load(&src->m[4]);
+    const XrSimd4f c2 = XrSimd4f_Load(&src->m[8]);
+    const XrSimd4f c3 = XrSimd4f_Load(&src->m[12]);
+
+    const XrSimd4f fac0 = XrMatrix4x4f_InvertFactor(c1, c2, c3, 2, 3);
+    const XrSimd4f fac1 = XrMatrix4x4f_InvertFactor(c1, c2, c3, 1, 3);
+    const XrSimd4f fac2 = XrMatrix4x4f_InvertFactor(c1, c2, c3, 1, 2);
+    const XrSimd4f fac3 = XrMatrix4x4f_InvertFactor(c1, c2, c3, 0, 3);
+    const XrSimd4f fac4 = XrMatrix4x4f_InvertFactor(c1, c2, c3, 0, 2);
+    const XrSimd4f fac5 = XrMatrix4x4f_InvertFactor(c1, c2, c3, 0, 1);
+
+    const XrSimd4f vec0 = XrMatrix4x4f_InvertRow(c0, c1, 0);
+    const XrSimd4f vec1 = XrMatrix4x4f_InvertRow(c0, c1, 1);
+    const XrSimd4f vec2 = XrMatrix4x4f_InvertRow(c0, c1, 2);
+    const XrSimd4f vec3 = XrMatrix4x4f_InvertRow(c0, c1, 3);
+
+    const XrSimd4f signA = XrSimd4f_Set(1.0f, -1.0f, 1.0f, -1.0f);
+    const XrSimd4f signB = XrSimd4f_Set(-1.0f, 1.0f, -1.0f, 1.0f);
+    const XrSimd4f inv0 = XrSimd4f_Add(XrSimd4f_Sub(XrSimd4f_Mul(vec1, fac0), XrSimd4f_Mul(vec2, fac1)), XrSimd4f_Mul(vec3, fac2));
+    const XrSimd4f inv1 = XrSimd4f_Add(XrSimd4f_Sub(XrSimd4f_Mul(vec0, fac0), XrSimd4f_Mul(vec2, fac3)), XrSimd4f_Mul(vec3, fac4));
+    const XrSimd4f inv2 = XrSimd4f_Add(XrSimd4f_Sub(XrSimd4f_Mul(vec0, fac1), XrSimd4f_Mul(vec1, fac3)), XrSimd4f_Mul(vec3, fac5));
+    const XrSimd4f inv3 = XrSimd4f_Add(XrSimd4f_Sub(XrSimd4f_Mul(vec0, fac2), XrSimd4f_Mul(vec1, fac4)), XrSimd4f_Mul(vec2, fac5));
+    XrMatrix4x4f inv;
+    XrSimd4f_Store(&inv.m[0], XrSimd4f_Mul(inv0, signA));
+    XrSimd4f_Store(&inv.m[4], XrSimd4f_Mul(inv1, signB));
+    XrSimd4f_Store(&inv.m[8], XrSimd4f_Mul(inv2, signA));
+    XrSimd4f_Store(&inv.m[12], XrSimd4f_Mul(inv3, signB));
+
+    const float det = (src->m[0] * inv.m[0] + src->m[1] * inv.m[4]) + (src->m[2] * inv.m[8] + src->m[3] * inv.m[12]);
+    const XrSimd4f rcpDet = XrSimd4f_Splat(1.0f / det);
+    for (int i = 0; i < 16; i += 4) {
+        XrSimd4f_Store(&result->m[i], XrSimd4f_Mul(XrSimd4f_Load(&inv.m[i]), rcpDet));
+    }
+#else
+    XrMatrix4x4f_Invert_Scalar(result, src);
+#endif
+}
+
 // Calculates the inverse of a rigid body transform.
-inline static void XrMatrix4x4f_InvertRigidBody(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_InvertRigidBody_Scalar(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
     result->m[0] = src->m[0];
     result->m[1] = src->m[4];
     result->m[2] = src->m[8];
@@ -338,8 +603,31 @@ inline static void XrMatrix4x4f_InvertRigidBody(XrMatrix4x4f* result, const XrMa
     result->m[15] = 1.0f;
 }
 
+// Calculates the inverse of a rigid body transform.
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_InvertRigidBody(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
+#if defined(XR_LINEAR_SIMD)
+    if (XR_LINEAR_IS_CONSTANT_EVALUATED()) {
+        XrMatrix4x4f_InvertRigidBody_Scalar(result, src);
+        return;
+    }
+    // The transposed rotation, then the translation rotated back by it.
+    const XrSimd4f c0 = XrSimd4f_Set(src->m[0], src->m[4], src->m[8], 0.0f);
+    const XrSimd4f c1 = XrSimd4f_Set(src->m[1], src->m[5], src->m[9], 0.0f);
+    const XrSimd4f c2 = XrSimd4f_Set(src->m[2], src->m[6], src->m[10], 0.0f);
+    const XrSimd4f t01 = XrSimd4f_Add(XrSimd4f_Mul(c0, XrSimd4f_Splat(src->m[12])), XrSimd4f_Mul(c1, XrSimd4f_Splat(src->m[13])));
+    const XrSimd4f t = XrSimd4f_Add(t01, XrSimd4f_Mul(c2, XrSimd4f_Splat(src->m[14])));
+    const XrSimd4f c3 = XrSimd4f_Sub(XrSimd4f_Set(0.0f, 0.0f, 0.0f, 1.0f), t);
+    XrSimd4f_Store(&result->m[0], c0);
+    XrSimd4f_Store(&result->m[4], c1);
+    XrSimd4f_Store(&result->m[8], c2);
+    XrSimd4f_Store(&result->m[12], c3);
+#else
+    XrMatrix4x4f_InvertRigidBody_Scalar(result, src);
+#endif
+}
+
 // Creates an identity matrix.
-inline static void XrMatrix4x4f_CreateIdentity(XrMatrix4x4f* result) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_CreateIdentity(XrMatrix4x4f* result) {
     result->m[0] = 1.0f;
     result->m[1] = 0.0f;
     result->m[2] = 0.0f;
@@ -359,7 +647,7 @@ inline static void XrMatrix4x4f_CreateIdentity(XrMatrix4x4f* result) {
 }
 
 // Creates a translation matrix.
-inline static void XrMatrix4x4f_CreateTranslation(XrMatrix4x4f* result, const float x, const float y, const float z) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_CreateTranslation(XrMatrix4x4f* result, const float x, const float y, const float z) {
     result->m[0] = 1.0f;
     result->m[1] = 0.0f;
     result->m[2] = 0.0f;
@@ -380,16 +668,16 @@ inline static void XrMatrix4x4f_CreateTranslation(XrMatrix4x4f* result, const fl
 
 // Creates a rotation matrix.
 // If -Z=forward, +Y=up, +X=right, then degreesX=pitch, degreesY=yaw, degreesZ=roll.
-inline static void XrMatrix4x4f_CreateRotation(XrMatrix4x4f* result, const float degreesX, const float degreesY,
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_CreateRotation(XrMatrix4x4f* result, const float degreesX, const float degreesY,
                                                const float degreesZ) {
-    const float sinX = sinf(degreesX * (MATH_PI / 180.0f));
-    const float cosX = cosf(degreesX * (MATH_PI / 180.0f));
+    const float sinX = XrMath_Sin(degreesX * (MATH_PI / 180.0f));
+    const float cosX = XrMath_Cos(degreesX * (MATH_PI / 180.0f));
     const XrMatrix4x4f rotationX = {{1, 0, 0, 0, 0, cosX, sinX, 0, 0, -sinX, cosX, 0, 0, 0, 0, 1}};
-    const float sinY = sinf(degreesY * (MATH_PI / 180.0f));
-    const float cosY = cosf(degreesY * (MATH_PI / 180.0f));
+    const float sinY = XrMath_Sin(degreesY * (MATH_PI / 180.0f));
+    const float cosY = XrMath_Cos(degreesY * (MATH_PI / 180.0f));
     const XrMatrix4x4f rotationY = {{cosY, 0, -sinY, 0, 0, 1, 0, 0, sinY, 0, cosY, 0, 0, 0, 0, 1}};
-    const float sinZ = sinf(degreesZ * (MATH_PI / 180.0f));
-    const float cosZ = cosf(degreesZ * (MATH_PI / 180.0f));
+    const float sinZ = XrMath_Sin(degreesZ * (MATH_PI / 180.0f));
+    const float cosZ = XrMath_Cos(degreesZ * (MATH_PI / 180.0f));
     const XrMatrix4x4f rotationZ = {{cosZ, sinZ, 0, 0, -sinZ, cosZ, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}};
     XrMatrix4x4f rotationXY;
     XrMatrix4x4f_Multiply(&rotationXY, &rotationY, &rotationX);
@@ -397,7 +685,7 @@ inline static void XrMatrix4x4f_CreateRotation(XrMatrix4x4f* result, const float
 }
 
 // Creates a scale matrix.
-inline static void XrMatrix4x4f_CreateScale(XrMatrix4x4f* result, const float x, const float y, const float z) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_CreateScale(XrMatrix4x4f* result, const float x, const float y, const float z) {
     result->m[0] = x;
     result->m[1] = 0.0f;
     result->m[2] = 0.0f;
@@ -417,7 +705,7 @@ inline static void XrMatrix4x4f_CreateScale(XrMatrix4x4f* result, const float x,
 }
 
 // Creates a matrix from a quaternion.
-inline static void XrMatrix4x4f_CreateFromQuaternion(XrMatrix4x4f* result, const XrQuaternionf* quat) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_CreateFromQuaternion_Scalar(XrMatrix4x4f* result, const XrQuaternionf* quat) {
     const float x2 = quat->x + quat->x;
     const float y2 = quat->y + quat->y;
     const float z2 = quat->z + quat->z;
@@ -454,8 +742,49 @@ inline static void XrMatrix4x4f_CreateFromQuaternion(XrMatrix4x4f* result, const
     result->m[15] = 1.0f;
 }
 
+// Creates a matrix from a quaternion.
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_CreateFromQuaternion(XrMatrix4x4f* result, const XrQuaternionf* quat) {
+#if defined(XR_LINEAR_SIMD)
+    if (XR_LINEAR_IS_CONSTANT_EVALUATED()) {
+        XrMatrix4x4f_CreateFromQuaternion_Scalar(result, quat);
+        return;
+    }
+    // Each column is identity + a * products + b * products, the signs select add or subtract.
+    const float x = quat->x;
+    const float y = quat->y;
+    const float z = quat->z;
+    const float w = quat->w;
+    const float x2 = x + x;
+    const float y2 = y + y;
+    const float z2 = z + z;
+
+    // (yy2, xy2, xz2) and (zz2, wz2, wy2)
+    const XrSimd4f p0 = XrSimd4f_Mul(XrSimd4f_Set(y, x, x, 0.0f), XrSimd4f_Set(y2, y2, z2, 0.0f));
+    const XrSimd4f q0 = XrSimd4f_Mul(XrSimd4f_Set(z, w, w, 0.0f), XrSimd4f_Set(z2, z2, y2, 0.0f));
+    // (xy2, xx2, yz2) and (wz2, zz2, wx2)
+    const XrSimd4f p1 = XrSimd4f_Mul(XrSimd4f_Set(x, x, y, 0.0f), XrSimd4f_Set(y2, x2, z2, 0.0f));
+    const XrSimd4f q1 = XrSimd4f_Mul(XrSimd4f_Set(w, z, w, 0.0f), XrSimd4f_Set(z2, z2, x2, 0.0f));
+    // (xz2, yz2, xx2) and (wy2, wx2, yy2)
+    const XrSimd4f p2 = XrSimd4f_Mul(XrSimd4f_Set(x, y, x, 0.0f), XrSimd4f_Set(z2, z2, x2, 0.0f));
+    const XrSimd4f q2 = XrSimd4f_Mul(XrSimd4f_Set(w, w, y, 0.0f), XrSimd4f_Set(y2, x2, y2, 0.0f));
+
+    XrSimd4f_Store(&result->m[0], XrSimd4f_Add(XrSimd4f_Add(XrSimd4f_Set(1.0f, 0.0f, 0.0f, 0.0f),
+                                                            XrSimd4f_Mul(p0, XrSimd4f_Set(-1.0f, 1.0f, 1.0f, 0.0f))),
+                                               XrSimd4f_Mul(q0, XrSimd4f_Set(-1.0f, 1.0f, -1.0f, 0.0f))));
+    XrSimd4f_Store(&result->m[4], XrSimd4f_Add(XrSimd4f_Add(XrSimd4f_Set(0.0f, 1.0f, 0.0f, 0.0f),
+                                                            XrSimd4f_Mul(p1, XrSimd4f_Set(1.0f, -1.0f, 1.0f, 0.0f))),
+                                               XrSimd4f_Mul(q1, XrSimd4f_Set(-1.0f, -1.0f, 1.0f, 0.0f))));
+    XrSimd4f_Store(&result->m[8], XrSimd4f_Add(XrSimd4f_Add(XrSimd4f_Set(0.0f, 0.0f, 1.0f, 0.0f),
+                                                            XrSimd4f_Mul(p2, XrSimd4f_Set(1.0f, 1.0f, -1.0f, 0.0f))),
+                                               XrSimd4f_Mul(q2, XrSimd4f_Set(1.0f, -1.0f, -1.0f, 0.0f))));
+    XrSimd4f_Store(&result->m[12], XrSimd4f_Set(0.0f, 0.0f, 0.0f, 1.0f));
+#else
+    XrMatrix4x4f_CreateFromQuaternion_Scalar(result, quat);
+#endif
+}
+
 // Creates a combined translation(rotation(scale(object))) matrix.
-inline static void XrMatrix4x4f_CreateTranslationRotationScale(XrMatrix4x4f* result, const XrVector3f* translation,
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_CreateTranslationRotationScale(XrMatrix4x4f* result, const XrVector3f* translation,
                                                                const XrQuaternionf* rotation, const XrVector3f* scale) {
     XrMatrix4x4f scaleMatrix;
     XrMatrix4x4f_CreateScale(&scaleMatrix, scale->x, scale->y, scale->z);
@@ -479,7 +808,7 @@ inline static void XrMatrix4x4f_CreateTranslationRotationScale(XrMatrix4x4f* res
 //              "Tightening the Precision of Perspective Rendering"
 //              Paul Upchurch, Mathieu Desbrun
 //              Journal of Graphics Tools, Volume 16, Issue 1, 2012
-inline static void XrMatrix4x4f_CreateProjection(XrMatrix4x4f* result, GraphicsAPI graphicsApi, const float tanAngleLeft,
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_CreateProjection(XrMatrix4x4f* result, GraphicsAPI graphicsApi, const float tanAngleLeft,
                                                  const float tanAngleRight, const float tanAngleUp, float const tanAngleDown,
                                                  const float nearZ, const float farZ) {
     const float tanAngleWidth = tanAngleRight - tanAngleLeft;
@@ -538,19 +867,19 @@ inline static void XrMatrix4x4f_CreateProjection(XrMatrix4x4f* result, GraphicsA
 }
 
 // Creates a projection matrix based on the specified FOV.
-inline static void XrMatrix4x4f_CreateProjectionFov(XrMatrix4x4f* result, GraphicsAPI graphicsApi, const XrFovf fov,
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_CreateProjectionFov(XrMatrix4x4f* result, GraphicsAPI graphicsApi, const XrFovf fov,
                                                     const float nearZ, const float farZ) {
-    const float tanLeft = tanf(fov.angleLeft);
-    const float tanRight = tanf(fov.angleRight);
+    const float tanLeft = XrMath_Tan(fov.angleLeft);
+    const float tanRight = XrMath_Tan(fov.angleRight);
 
-    const float tanDown = tanf(fov.angleDown);
-    const float tanUp = tanf(fov.angleUp);
+    const float tanDown = XrMath_Tan(fov.angleDown);
+    const float tanUp = XrMath_Tan(fov.angleUp);
 
     XrMatrix4x4f_CreateProjection(result, graphicsApi, tanLeft, tanRight, tanUp, tanDown, nearZ, farZ);
 }
 
 // Creates a matrix that transforms the -1 to 1 cube to cover the given 'mins' and 'maxs' transformed with the given 'matrix'.
-inline static void XrMatrix4x4f_CreateOffsetScaleForBounds(XrMatrix4x4f* result, const XrMatrix4x4f* matrix, const XrVector3f* mins,
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_CreateOffsetScaleForBounds(XrMatrix4x4f* result, const XrMatrix4x4f* matrix, const XrVector3f* mins,
                                                            const XrVector3f* maxs) {
     const XrVector3f offset = {(maxs->x + mins->x) * 0.5f, (maxs->y + mins->y) * 0.5f, (maxs->z + mins->z) * 0.5f};
     const XrVector3f scale = {(maxs->x - mins->x) * 0.5f, (maxs->y - mins->y) * 0.5f, (maxs->z - mins->z) * 0.5f};
@@ -577,21 +906,21 @@ inline static void XrMatrix4x4f_CreateOffsetScaleForBounds(XrMatrix4x4f* result,
 }
 
 // Returns true if the given matrix is affine.
-inline static bool XrMatrix4x4f_IsAffine(const XrMatrix4x4f* matrix, const float epsilon) {
-    return fabsf(matrix->m[3]) <= epsilon && fabsf(matrix->m[7]) <= epsilon && fabsf(matrix->m[11]) <= epsilon &&
-           fabsf(matrix->m[15] - 1.0f) <= epsilon;
+inline static XR_LINEAR_CONSTEXPR bool XrMatrix4x4f_IsAffine(const XrMatrix4x4f* matrix, const float epsilon) {
+    return XrMath_Fabs(matrix->m[3]) <= epsilon && XrMath_Fabs(matrix->m[7]) <= epsilon && XrMath_Fabs(matrix->m[11]) <= epsilon &&
+           XrMath_Fabs(matrix->m[15] - 1.0f) <= epsilon;
 }
 
 // Returns true if the given matrix is orthogonal.
-inline static bool XrMatrix4x4f_IsOrthogonal(const XrMatrix4x4f* matrix, const float epsilon) {
+inline static XR_LINEAR_CONSTEXPR bool XrMatrix4x4f_IsOrthogonal(const XrMatrix4x4f* matrix, const float epsilon) {
     for (int i = 0; i < 3; i++) {
         for (int j = 0; j < 3; j++) {
             if (i != j) {
-                if (fabsf(matrix->m[4 * i + 0] * matrix->m[4 * j + 0] + matrix->m[4 * i + 1] * matrix->m[4 * j + 1] +
+                if (XrMath_Fabs(matrix->m[4 * i + 0] * matrix->m[4 * j + 0] + matrix->m[4 * i + 1] * matrix->m[4 * j + 1] +
                           matrix->m[4 * i + 2] * matrix->m[4 * j + 2]) > epsilon) {
                     return false;
                 }
-                if (fabsf(matrix->m[4 * 0 + i] * matrix->m[4 * 0 + j] + matrix->m[4 * 1 + i] * matrix->m[4 * 1 + j] +
+                if (XrMath_Fabs(matrix->m[4 * 0 + i] * matrix->m[4 * 0 + j] + matrix->m[4 * 1 + i] * matrix->m[4 * 1 + j] +
                           matrix->m[4 * 2 + i] * matrix->m[4 * 2 + j]) > epsilon) {
                     return false;
                 }
@@ -602,15 +931,15 @@ inline static bool XrMatrix4x4f_IsOrthogonal(const XrMatrix4x4f* matrix, const f
 }
 
 // Returns true if the given matrix is orthonormal.
-inline static bool XrMatrix4x4f_IsOrthonormal(const XrMatrix4x4f* matrix, const float epsilon) {
+inline static XR_LINEAR_CONSTEXPR bool XrMatrix4x4f_IsOrthonormal(const XrMatrix4x4f* matrix, const float epsilon) {
     for (int i = 0; i < 3; i++) {
         for (int j = 0; j < 3; j++) {
             const float kd = (i == j) ? 1.0f : 0.0f;  // Kronecker delta
-            if (fabsf(kd - (matrix->m[4 * i + 0] * matrix->m[4 * j + 0] + matrix->m[4 * i + 1] * matrix->m[4 * j + 1] +
+            if (XrMath_Fabs(kd - (matrix->m[4 * i + 0] * matrix->m[4 * j + 0] + matrix->m[4 * i + 1] * matrix->m[4 * j + 1] +
                             matrix->m[4 * i + 2] * matrix->m[4 * j + 2])) > epsilon) {
                 return false;
             }
-            if (fabsf(kd - (matrix->m[4 * 0 + i] * matrix->m[4 * 0 + j] + matrix->m[4 * 1 + i] * matrix->m[4 * 1 + j] +
+            if (XrMath_Fabs(kd - (matrix->m[4 * 0 + i] * matrix->m[4 * 0 + j] + matrix->m[4 * 1 + i] * matrix->m[4 * 1 + j] +
                             matrix->m[4 * 2 + i] * matrix->m[4 * 2 + j])) > epsilon) {
                 return false;
             }
@@ -620,12 +949,12 @@ inline static bool XrMatrix4x4f_IsOrthonormal(const XrMatrix4x4f* matrix, const
 }
 
 // Returns true if the given matrix is a rigid body transform.
-inline static bool XrMatrix4x4f_IsRigidBody(const XrMatrix4x4f* matrix, const float epsilon) {
+inline static XR_LINEAR_CONSTEXPR bool XrMatrix4x4f_IsRigidBody(const XrMatrix4x4f* matrix, const float epsilon) {
     return XrMatrix4x4f_IsAffine(matrix, epsilon) && XrMatrix4x4f_IsOrthonormal(matrix, epsilon);
 }
 
 // Get the translation from a combined translation(rotation(scale(object))) matrix.
-inline static void XrMatrix4x4f_GetTranslation(XrVector3f* result, const XrMatrix4x4f* src) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_GetTranslation(XrVector3f* result, const XrMatrix4x4f* src) {
     assert(XrMatrix4x4f_IsAffine(src, 1e-4f));
     assert(XrMatrix4x4f_IsOrthogonal(src, 1e-4f));
 
@@ -635,7 +964,7 @@ inline static void XrMatrix4x4f_GetTranslation(XrVector3f* result, const XrMatri
 }
 
 // Get the rotation from a combined translation(rotation(scale(object))) matrix.
-inline static void XrMatrix4x4f_GetRotation(XrQuaternionf* result, const XrMatrix4x4f* src) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_GetRotation(XrQuaternionf* result, const XrMatrix4x4f* src) {
     assert(XrMatrix4x4f_IsAffine(src, 1e-4f));
     assert(XrMatrix4x4f_IsOrthogonal(src, 1e-4f));
 
@@ -677,17 +1006,17 @@ inline static void XrMatrix4x4f_GetRotation(XrQuaternionf* result, const XrMatri
 }
 
 // Get the scale from a combined translation(rotation(scale(object))) matrix.
-inline static void XrMatrix4x4f_GetScale(XrVector3f* result, const XrMatrix4x4f* src) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_GetScale(XrVector3f* result, const XrMatrix4x4f* src) {
     assert(XrMatrix4x4f_IsAffine(src, 1e-4f));
     assert(XrMatrix4x4f_IsOrthogonal(src, 1e-4f));
 
-    result->x = sqrtf(src->m[0] * src->m[0] + src->m[1] * src->m[1] + src->m[2] * src->m[2]);
-    result->y = sqrtf(src->m[4] * src->m[4] + src->m[5] * src->m[5] + src->m[6] * src->m[6]);
-    result->z = sqrtf(src->m[8] * src->m[8] + src->m[9] * src->m[9] + src->m[10] * src->m[10]);
+    result->x = XrMath_Sqrt(src->m[0] * src->m[0] + src->m[1] * src->m[1] + src->m[2] * src->m[2]);
+    result->y = XrMath_Sqrt(src->m[4] * src->m[4] + src->m[5] * src->m[5] + src->m[6] * src->m[6]);
+    result->z = XrMath_Sqrt(src->m[8] * src->m[8] + src->m[9] * src->m[9] + src->m[10] * src->m[10]);
 }
 
 // Transforms a 3D vector.
-inline static void XrMatrix4x4f_TransformVector3f(XrVector3f* result, const XrMatrix4x4f* m, const XrVector3f* v) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_TransformVector3f_Scalar(XrVector3f* result, const XrMatrix4x4f* m, const XrVector3f* v) {
     const float w = m->m[3] * v->x + m->m[7] * v->y + m->m[11] * v->z + m->m[15];
     const float rcpW = 1.0f / w;
     result->x = (m->m[0] * v->x + m->m[4] * v->y + m->m[8] * v->z + m->m[12]) * rcpW;
@@ -695,8 +1024,30 @@ inline static void XrMatrix4x4f_TransformVector3f(XrVector3f* result, const XrMa
     result->z = (m->m[2] * v->x + m->m[6] * v->y + m->m[10] * v->z + m->m[14]) * rcpW;
 }
 
+// Transforms a 3D vector.
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_TransformVector3f(XrVector3f* result, const XrMatrix4x4f* m, const XrVector3f* v) {
+#if defined(XR_LINEAR_SIMD)
+    if (XR_LINEAR_IS_CONSTANT_EVALUATED()) {
+        XrMatrix4x4f_TransformVector3f_Scalar(result, m, v);
+        return;
+    }
+    const XrSimd4f xy = XrSimd4f_Add(XrSimd4f_Mul(XrSimd4f_Load(&m->m[0]), XrSimd4f_Splat(v->x)),
+                                     XrSimd4f_Mul(XrSimd4f_Load(&m->m[4]), XrSimd4f_Splat(v->y)));
+    const XrSimd4f xyz = XrSimd4f_Add(xy, XrSimd4f_Mul(XrSimd4f_Load(&m->m[8]), XrSimd4f_Splat(v->z)));
+    const XrSimd4f xyzw = XrSimd4f_Add(xyz, XrSimd4f_Load(&m->m[12]));
+    float p[4];
+    XrSimd4f_Store(p, xyzw);
+    const float rcpW = 1.0f / p[3];
+    result->x = p[0] * rcpW;
+    result->y = p[1] * rcpW;
+    result->z = p[2] * rcpW;
+#else
+    XrMatrix4x4f_TransformVector3f_Scalar(result, m, v);
+#endif
+}
+
 // Transforms a 4D vector.
-inline static void XrMatrix4x4f_TransformVector4f(XrVector4f* result, const XrMatrix4x4f* m, const XrVector4f* v) {
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_TransformVector4f(XrVector4f* result, const XrMatrix4x4f* m, const XrVector4f* v) {
     result->x = m->m[0] * v->x + m->m[4] * v->y + m->m[8] * v->z + m->m[12] * v->w;
     result->y = m->m[1] * v->x + m->m[5] * v->y + m->m[9] * v->z + m->m[13] * v->w;
     result->z = m->m[2] * v->x + m->m[6] * v->y + m->m[10] * v->z + m->m[14] * v->w;
@@ -704,7 +1055,7 @@ inline static void XrMatrix4x4f_TransformVector4f(XrVector4f* result, const XrMa
 }
 
 // Transforms the 'mins' and 'maxs' bounds with the given 'matrix'.
-inline static void XrMatrix4x4f_TransformBounds(XrVector3f* resultMins, XrVector3f* resultMaxs, const XrMatrix4x4f* matrix,
+inline static XR_LINEAR_CONSTEXPR void XrMatrix4x4f_TransformBounds(XrVector3f* resultMins, XrVector3f* resultMaxs, const XrMatrix4x4f* matrix,
                                                 const XrVector3f* mins, const XrVector3f* maxs) {
     assert(XrMatrix4x4f_IsAffine(matrix, 1e-4f));
 
@@ -714,15 +1065,15 @@ inline static void XrMatrix4x4f_TransformBounds(XrVector3f* resultMins, XrVector
                                   matrix->m[1] * center.x + matrix->m[5] * center.y + matrix->m[9] * center.z + matrix->m[13],
                                   matrix->m[2] * center.x + matrix->m[6] * center.y + matrix->m[10] * center.z + matrix->m[14]};
     const XrVector3f newExtents = {
-        fabsf(extents.x * matrix->m[0]) + fabsf(extents.y * matrix->m[4]) + fabsf(extents.z * matrix->m[8]),
-        fabsf(extents.x * matrix->m[1]) + fabsf(extents.y * matrix->m[5]) + fabsf(extents.z * matrix->m[9]),
-        fabsf(extents.x * matrix->m[2]) + fabsf(extents.y * matrix->m[6]) + fabsf(extents.z * matrix->m[10])};
+        XrMath_Fabs(extents.x * matrix->m[0]) + XrMath_Fabs(extents.y * matrix->m[4]) + XrMath_Fabs(extents.z * matrix->m[8]),
+        XrMath_Fabs(extents.x * matrix->m[1]) + XrMath_Fabs(extents.y * matrix->m[5]) + XrMath_Fabs(extents.z * matrix->m[9]),
+        XrMath_Fabs(extents.x * matrix->m[2]) + XrMath_Fabs(extents.y * matrix->m[6]) + XrMath_Fabs(extents.z * matrix->m[10])};
     XrVector3f_Sub(resultMins, &newCenter, &newExtents);
     XrVector3f_Add(resultMaxs, &newCenter, &newExtents);
 }
 
 // Returns true if the 'mins' and 'maxs' bounds is completely off to one side of the projection matrix.
-inline static bool XrMatrix4x4f_CullBounds(const XrMatrix4x4f* mvp, const XrVector3f* mins, const XrVector3f* maxs) {
+inline static XR_LINEAR_CONSTEXPR bool XrMatrix4x4f_CullBounds(const XrMatrix4x4f* mvp, const XrVector3f* mins, const XrVector3f* maxs) {
     if (maxs->x <= mins->x && maxs->y <= mins->y && maxs->z <= mins->z) {
         return false;
     }
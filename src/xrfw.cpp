@@ -4,45 +4,269 @@
 #include <plog/Log.h>
 
 #include "xr_linear.h"
+#include "xrfw_capture_writer.h"
+#include "xrfw_frame_stats.h"
 #include "xrfw_initialization.h"
+#include "xrfw_log.h"
+#include "xrfw_space_cache.h"
+#include "xrfw_trace.h"
 #include <algorithm>
+#include <array>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <openxr/openxr.h>
+#include <stdio.h>
 
-#include <unordered_map>
 #include <vector>
 #include <xrfw.h>
 
 XrfwInitialization g_init = {};
 
-static const int MAX_NUM_LAYERS = 16;
-// App only supports the primary stereo view config.
-const XrViewConfigurationType g_supportedViewConfigType =
+// projection matrix and XrCompositionLayerDepthInfoKHR
+static const float NEAR_Z = 0.05f;
+static const float FAR_Z = 100.0f;
+
+//
+// instance. shared by the contexts, the OpenXR loader allows one XrInstance
+// per process.
+//
+// xrfwSetViewConfiguration. PRIMARY_STEREO if the runtime lacks
+// XR_VARJO_quad_views.
+XrViewConfigurationType g_viewConfigurationType =
   XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+// xrfwSetCompositionLayerDepth. cleared if the runtime or the platform lacks
+// it.
+bool g_compositionLayerDepth = false;
+// xrfwCreateInstance. XrfwExtension bits
+XrfwExtensionSet g_enabledExtensions;
+uint32_t g_maxLayerCount = XRFW_MAX_LAYER_COUNT;
+#ifdef XR_KHR_locate_spaces
+// xrLocateSpacesKHR or xrLocateSpaces. nullptr if the runtime has neither
+PFN_xrLocateSpacesKHR g_xrLocateSpaces = nullptr;
+#endif
 
 XrInstance g_instance = nullptr;
 XrSystemId g_systemId = {};
-XrSession g_session = nullptr;
-XrEventDataBuffer g_eventDataBuffer = {};
-XrSessionState g_sessionState = XR_SESSION_STATE_UNKNOWN;
-bool g_sessionRunning = false;
-XrSpace g_currentSpace = {};
-XrSpace g_headSpace = {};
-XrSpace g_localSpace = {};
-
-struct SwapchainInfo
+// the frame loop calls the runtime through this
+XrfwDispatchTable g_dispatchTable = {};
+
+// Dense swapchain table. XrfwSwapchains carries the slot handle, so the frame
+// loop never hashes a swapchain. A destroyed slot is reused by the next create.
+// The handle is generation << SWAPCHAIN_SLOT_INDEX_BITS | index, and destroy
+// bumps the generation, so a stale handle of a reused slot fails instead of
+// reaching the new swapchain.
+static const uint32_t MAX_SWAPCHAIN_SLOTS = 32;
+static const uint32_t SWAPCHAIN_SLOT_INDEX_BITS = 8;
+static_assert(MAX_SWAPCHAIN_SLOTS <= (1u << SWAPCHAIN_SLOT_INDEX_BITS));
+enum class SwapchainUsage
+{
+  // XrCompositionLayerProjectionView subImage
+  Projection,
+  // XrCompositionLayerDepthInfoKHR subImage
+  Depth,
+  // xrfwCreateLayer. the layer owns its subImage
+  Layer,
+};
+struct SwapchainSlot
 {
-  uint32_t index = 0;
+  XrSwapchain swapchain = XR_NULL_HANDLE;
+  // projectionViews index
+  uint32_t viewIndex = 0;
   int width = 0;
   int height = 0;
   std::vector<XrSwapchainImageBaseHeader*> images;
-  bool useVprt = false;
+  // VPRT. views viewIndex .. viewIndex + arraySize - 1
+  uint32_t arraySize = 1;
+  SwapchainUsage usage = SwapchainUsage::Projection;
+  // color slot. acquired and released together
+  uint32_t depthSlot = XRFW_INVALID_SWAPCHAIN_SLOT;
+  // kept across destroy and create
+  uint32_t generation = 0;
+};
+
+// xrfwCreateLayer. the projection layer comes first
+static const uint32_t MAX_LAYERS = XRFW_MAX_LAYER_COUNT - 1;
+struct Layer
+{
+  uint32_t swapchainSlot = XRFW_INVALID_SWAPCHAIN_SLOT;
+  XrfwLayerCreateInfo info = {};
+  bool visible = true;
+  bool dirty = true;
+  // released once. the compositor has an image to sample
+  bool rendered = false;
+  XrCompositionLayerQuad quad = {};
+  XrCompositionLayerCylinderKHR cylinder = {};
+};
+
+// XRFW_LOG_*
+static XrfwLogThread g_logThread;
+
+void
+xrfwLogPush(const XrfwLogRecord& record)
+{
+  g_logThread.Push(record);
+}
+
+// XRFW_TRACE_SCOPE
+// events per thread
+static const size_t TRACE_EVENT_COUNT = 8192;
+using XrfwThreadTraceBuffer = XrfwTraceBuffer<TRACE_EVENT_COUNT>;
+static std::atomic<bool> g_traceEnabled = false;
+// guards the registration of g_traceBuffers, never taken by a marker
+static std::mutex g_traceMutex;
+// kept after the thread exits, so its events are still written
+static std::vector<std::unique_ptr<XrfwThreadTraceBuffer>> g_traceBuffers;
+// buffers of exited threads. The next new thread takes one over instead of
+// registering another, so a thread recreated on every session restart (the
+// frame pacer) does not grow the trace.
+static std::vector<XrfwThreadTraceBuffer*> g_freeTraceBuffers;
+
+// returns the buffer of the thread to g_freeTraceBuffers at thread exit
+struct XrfwTraceBufferOwner
+{
+  XrfwThreadTraceBuffer* buffer = nullptr;
+
+  ~XrfwTraceBufferOwner()
+  {
+    if (buffer) {
+      std::lock_guard<std::mutex> lock(g_traceMutex);
+      g_freeTraceBuffers.push_back(buffer);
+    }
+  }
+};
+static thread_local XrfwTraceBufferOwner t_traceBuffer;
+
+static XrfwThreadTraceBuffer*
+_xrfwTraceBuffer()
+{
+  if (!t_traceBuffer.buffer) {
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    if (!g_freeTraceBuffers.empty()) {
+      // the events of the exited thread stay until overwritten
+      t_traceBuffer.buffer = g_freeTraceBuffers.back();
+      g_freeTraceBuffers.pop_back();
+      t_traceBuffer.buffer->m_name.store(nullptr, std::memory_order_relaxed);
+    } else {
+      auto buffer = std::make_unique<XrfwThreadTraceBuffer>();
+      buffer->m_tid = static_cast<uint32_t>(g_traceBuffers.size());
+      t_traceBuffer.buffer = buffer.get();
+      g_traceBuffers.push_back(std::move(buffer));
+    }
+  }
+  return t_traceBuffer.buffer;
+}
+
+// a span already timed for the frame records
+static void
+_xrfwTrace(const char* name, int64_t begin, int64_t end)
+{
+  if (g_traceEnabled.load(std::memory_order_relaxed)) {
+    _xrfwTraceBuffer()->Push(name, begin, end);
+  }
+}
+
+static const size_t FRAME_RECORD_COUNT = 256;
+// distinct (space, baseSpace, time) in a frame
+static const size_t SPACE_LOCATION_CACHE_COUNT = 32;
+// xrfwLocateSpaces locates larger batches in chunks of this
+static const uint32_t LOCATE_SPACES_CHUNK = 32;
+// session state changes between two xrfwPollEventsIsSessionActive
+static const size_t XRFW_SESSION_EVENT_CAPACITY = 16;
+
+//
+// session and frame loop. one per XrfwContext
+//
+struct XrfwContext
+{
+  // falls back to stereo if the runtime lacks g_viewConfigurationType
+  XrViewConfigurationType viewConfigurationType =
+    XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+  uint32_t viewCount = 2;
+  // g_compositionLayerDepth. cleared if no depth format
+  bool compositionLayerDepth = false;
+  int64_t depthSwapchainFormat = 0;
+
+  XrSession session = nullptr;
+  XrSessionState sessionState = XR_SESSION_STATE_UNKNOWN;
+  bool sessionRunning = false;
+  // routed by xrfwPollEventsIsSessionActive. guarded by g_eventMutex
+  std::vector<XrEventDataSessionStateChanged> pendingEvents;
+  std::vector<XrEventDataSessionStateChanged> processingEvents;
+  XrSpace currentSpace = {};
+  XrSpace headSpace = {};
+  XrSpace localSpace = {};
+
+  std::array<SwapchainSlot, MAX_SWAPCHAIN_SLOTS> swapchainSlots;
+
+  XrFrameState frameState{ XR_TYPE_FRAME_STATE };
+  XrBool32 shouldRender = false;
+  XrCompositionLayerProjectionView projectionViews[XRFW_MAX_VIEW_COUNT];
+  XrCompositionLayerProjection projection = {};
+  XrCompositionLayerDepthInfoKHR depthInfos[XRFW_MAX_VIEW_COUNT];
+  const XrSwapchainImageBaseHeader* depthImages[XRFW_MAX_VIEW_COUNT];
+
+  XrfwViewMatrices viewMatrices = {};
+  bool lateLatch = false;
+  XrfwLateLatchFunc lateLatchCallback = nullptr;
+  void* lateLatchUser = nullptr;
+  // with late latch the views record waits for the final poses of the frame
+  bool captureViewsPending = false;
+  XrViewStateFlags captureViewStateFlags = 0;
+  XrView captureViews[XRFW_MAX_VIEW_COUNT];
+
+  std::array<Layer, MAX_LAYERS> layers;
+
+  XrfwFrameRecorder<FRAME_RECORD_COUNT> frameRecorder;
+  XrfwSpaceLocationCache<SPACE_LOCATION_CACHE_COUNT> spaceLocationCache;
+  // xrfwStartCapture
+  XrfwCaptureWriter capture;
 };
-std::unordered_map<XrSwapchain, SwapchainInfo> g_swapchainImages;
 
-XrFrameState g_frameState{ XR_TYPE_FRAME_STATE };
-XrCompositionLayerProjectionView g_projectionViews[2];
-XrCompositionLayerProjection g_projection = {};
+static XrfwContext g_defaultContext;
+static thread_local XrfwContext* t_currentContext = nullptr;
+
+// xrPollEvent drains one queue for every session of the instance
+static std::mutex g_eventMutex;
+static XrEventDataBuffer g_eventDataBuffer = {};
+// contexts with a session
+static std::vector<XrfwContext*> g_sessionContexts;
+
+static XrfwContext&
+_xrfwContext()
+{
+  return t_currentContext ? *t_currentContext : g_defaultContext;
+}
+
+XRFW_API XrfwContext*
+xrfwCreateContext()
+{
+  return new XrfwContext;
+}
+
+XRFW_API void
+xrfwDestroyContext(XrfwContext* context)
+{
+  if (!context || context == &g_defaultContext) {
+    return;
+  }
+  if (t_currentContext == context) {
+    t_currentContext = nullptr;
+  }
+  delete context;
+}
+
+XRFW_API void
+xrfwMakeContextCurrent(XrfwContext* context)
+{
+  t_currentContext = context;
+}
+
+XRFW_API XrfwContext*
+xrfwGetCurrentContext()
+{
+  return &_xrfwContext();
+}
 
 static std::vector<int64_t>
 _xrfwGetSwapchainFormats(XrSession session)
@@ -70,12 +294,70 @@ _xrfwGetSwapchainFormats(XrSession session)
   return swapchainFormats;
 }
 
+// the runtime extensions known to xrfw. enumerated once per
+// xrfwCreateInstance
+static XrfwExtensionSet
+_xrfwGetSupportedExtensions()
+{
+  uint32_t count = 0;
+  auto result = xrEnumerateInstanceExtensionProperties(
+    nullptr, 0, &count, nullptr);
+  if (XR_FAILED(result)) {
+    PLOG_WARNING << "xrEnumerateInstanceExtensionProperties: " << result;
+    return {};
+  }
+  std::vector<XrExtensionProperties> properties(
+    count, { XR_TYPE_EXTENSION_PROPERTIES });
+  result = xrEnumerateInstanceExtensionProperties(
+    nullptr, count, &count, properties.data());
+  if (XR_FAILED(result)) {
+    PLOG_WARNING << "xrEnumerateInstanceExtensionProperties: " << result;
+    return {};
+  }
+  XrfwExtensionSet supported;
+  for (auto& property : properties) {
+    auto extension = xrfwFindExtension(property.extensionName);
+    if (extension != XrfwExtension::Count) {
+      supported.set(static_cast<size_t>(extension));
+    }
+  }
+  return supported;
+}
+
+// add to g_init.extensionNames if the runtime has it
+static bool
+_xrfwEnableExtensionIfSupported(const XrfwExtensionSet& supported,
+                                XrfwExtension extension)
+{
+  auto bit = static_cast<size_t>(extension);
+  if (!supported.test(bit)) {
+    return false;
+  }
+  if (!g_enabledExtensions.test(bit)) {
+    g_init.extensionNames.push_back(xrfwExtensionName(extension).data());
+    g_enabledExtensions.set(bit);
+  }
+  return true;
+}
+
+XRFW_API XrBool32
+xrfwIsExtensionEnabled(XrfwExtension extension)
+{
+  return g_enabledExtensions.test(static_cast<size_t>(extension));
+}
+
 XRFW_API XrInstance
 xrfwGetInstance()
 {
   return g_instance;
 }
 
+XRFW_API const XrfwDispatchTable*
+xrfwGetDispatchTable()
+{
+  return &g_dispatchTable;
+}
+
 // static std::vector<XrExtensionProperties>
 // GetXrExtensionProperties()
 // {
@@ -124,7 +406,37 @@ xrfwCreateInstance(const char* const* extensionNames,
   for (uint32_t i = 0; i < extensionCount; ++i) {
     g_init.extensionNames.push_back(extensionNames[i]);
   }
-  xrfwInitLogger();
+  g_enabledExtensions.reset();
+  for (auto name : g_init.extensionNames) {
+    auto extension = xrfwFindExtension(name);
+    if (extension != XrfwExtension::Count) {
+      g_enabledExtensions.set(static_cast<size_t>(extension));
+    }
+  }
+  // plog::init adds the appender on every call
+  static std::once_flag s_logger;
+  std::call_once(s_logger, xrfwInitLogger);
+  g_logThread.Start();
+  auto supported = _xrfwGetSupportedExtensions();
+  if (g_compositionLayerDepth) {
+    g_compositionLayerDepth =
+      g_init.selectDepthSwapchainFormatCallback &&
+      _xrfwEnableExtensionIfSupported(
+        supported, XrfwExtension::KHR_composition_layer_depth);
+    PLOG_INFO << XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME << ": "
+              << (g_compositionLayerDepth ? "enabled" : "not available");
+  }
+  // xrfwCreateLayer XRFW_LAYER_CYLINDER
+  _xrfwEnableExtensionIfSupported(
+    supported, XrfwExtension::KHR_composition_layer_cylinder);
+  if (g_viewConfigurationType ==
+        XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO &&
+      !_xrfwEnableExtensionIfSupported(supported,
+                                       XrfwExtension::VARJO_quad_views)) {
+    PLOG_WARNING << XR_VARJO_QUAD_VIEWS_EXTENSION_NAME
+                 << " is not supported. fallback to PRIMARY_STEREO";
+    g_viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+  }
 
   XrApplicationInfo appInfo{
     .applicationName = "xrfw_app",
@@ -137,6 +449,14 @@ xrfwCreateInstance(const char* const* extensionNames,
   if (pAppInfo) {
     appInfo = *pAppInfo;
   }
+#ifdef XR_KHR_locate_spaces
+  // xrfwLocateSpaces. core in OpenXR 1.1
+  auto locateSpacesCore = appInfo.apiVersion >= XR_MAKE_VERSION(1, 1, 0);
+  auto locateSpaces =
+    locateSpacesCore ||
+    _xrfwEnableExtensionIfSupported(supported,
+                                    XrfwExtension::KHR_locate_spaces);
+#endif
 
   XrInstanceCreateInfo instanceCreateInfo{
     .type = XR_TYPE_INSTANCE_CREATE_INFO,
@@ -155,6 +475,22 @@ xrfwCreateInstance(const char* const* extensionNames,
     PLOG_FATAL << "xrCreateInstance:" << result;
     return nullptr;
   }
+  if (!g_dispatchTable.Initialize(g_instance)) {
+    return nullptr;
+  }
+#ifdef XR_KHR_locate_spaces
+  g_xrLocateSpaces = nullptr;
+  if (locateSpaces) {
+    auto name = locateSpacesCore ? "xrLocateSpaces" : "xrLocateSpacesKHR";
+    if (XR_FAILED(xrGetInstanceProcAddr(
+          g_instance, name, (PFN_xrVoidFunction*)&g_xrLocateSpaces))) {
+      PLOG_WARNING << "xrGetInstanceProcAddr: " << name;
+      g_xrLocateSpaces = nullptr;
+    }
+  }
+  PLOG_INFO << XR_KHR_LOCATE_SPACES_EXTENSION_NAME << ": "
+            << (g_xrLocateSpaces ? "enabled" : "not available");
+#endif
 
   XrInstanceProperties instanceInfo{
     .type = XR_TYPE_INSTANCE_PROPERTIES,
@@ -207,11 +543,9 @@ xrfwCreateInstance(const char* const* extensionNames,
             << " PositionTracking="
             << (systemProperties.trackingProperties.positionTracking ? "True"
                                                                      : "False");
-  if (MAX_NUM_LAYERS > systemProperties.graphicsProperties.maxLayerCount) {
-    PLOG_FATAL << "systemProperties.graphicsProperties.maxLayerCount "
-               << MAX_NUM_LAYERS;
-    return nullptr;
-  }
+  g_maxLayerCount =
+    std::min<uint32_t>(XRFW_MAX_LAYER_COUNT,
+                       systemProperties.graphicsProperties.maxLayerCount);
 
   if (!g_init.graphicsRequirementsCallback(
         g_instance, g_systemId, g_init.graphicsRequirements)) {
@@ -228,25 +562,18 @@ xrfwCreateInstance(const char* const* extensionNames,
 XRFW_API void
 xrfwDestroyInstance()
 {
+  // while xrResultToString has the instance, and before the appender, a
+  // function static in xrfwInitLogger, is destroyed
+  g_logThread.Stop();
   xrDestroyInstance(g_instance);
+  g_dispatchTable = {};
 }
 
-XRFW_API XrSession
-xrfwCreateSession(XrfwSwapchains* swapchains, const void* next, bool useVrpt)
+// views, spaces and swapchains of the session just created
+static bool
+_xrfwInitSession(XrfwContext& ctx, XrfwSwapchains* swapchains, bool useVrpt)
 {
-  XrSessionCreateInfo sessionCreateInfo = {
-    .type = XR_TYPE_SESSION_CREATE_INFO,
-    .next = next, // &graphicsBindingGL,
-    .createFlags = 0,
-    .systemId = g_systemId,
-  };
-
-  auto result = xrCreateSession(g_instance, &sessionCreateInfo, &g_session);
-  if (XR_FAILED(result)) {
-    PLOG_FATAL << "xrCreateSession: " << result;
-    return nullptr;
-  }
-
+  XrResult result;
   // viewports
   {
     // Enumerate the viewport configurations.
@@ -255,7 +582,7 @@ xrfwCreateSession(XrfwSwapchains* swapchains, const void* next, bool useVrpt)
       g_instance, g_systemId, 0, &viewportConfigTypeCount, NULL);
     if (XR_FAILED(result)) {
       PLOG_FATAL << "xrEnumerateViewConfigurations: " << result;
-      return nullptr;
+      return false;
     }
 
     std::vector<XrViewConfigurationType> viewportConfigurationTypes(
@@ -267,7 +594,16 @@ xrfwCreateSession(XrfwSwapchains* swapchains, const void* next, bool useVrpt)
                                            viewportConfigurationTypes.data());
     if (XR_FAILED(result)) {
       PLOG_FATAL << "xrEnumerateViewConfigurations: " << result;
-      return nullptr;
+      return false;
+    }
+
+    if (std::find(viewportConfigurationTypes.begin(),
+                  viewportConfigurationTypes.end(),
+                  ctx.viewConfigurationType) ==
+        viewportConfigurationTypes.end()) {
+      PLOG_WARNING << ctx.viewConfigurationType
+                   << " is not supported. fallback to PRIMARY_STEREO";
+      ctx.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
     }
 
     PLOG_INFO << "Available Viewport Configuration Types: "
@@ -282,12 +618,12 @@ xrfwCreateSession(XrfwSwapchains* swapchains, const void* next, bool useVrpt)
         g_instance, g_systemId, viewportConfigType, &viewportConfig);
       if (XR_FAILED(result)) {
         PLOG_FATAL << "xrGetViewConfigurationProperties: " << result;
-        return nullptr;
+        return false;
       }
       PLOG_INFO << "  [" << i << "]FovMutable="
                 << (viewportConfig.fovMutable ? "true" : "false")
                 << " ConfigurationType " << viewportConfig.viewConfigurationType
-                << (viewportConfigType == g_supportedViewConfigType
+                << (viewportConfigType == ctx.viewConfigurationType
                       ? " Selected"
                       : "");
 
@@ -296,7 +632,7 @@ xrfwCreateSession(XrfwSwapchains* swapchains, const void* next, bool useVrpt)
         g_instance, g_systemId, viewportConfigType, 0, &viewCount, NULL);
       if (XR_FAILED(result)) {
         PLOG_FATAL << "xrEnumerateViewConfigurationViews: " << result;
-        return nullptr;
+        return false;
       }
     }
   }
@@ -313,10 +649,10 @@ xrfwCreateSession(XrfwSwapchains* swapchains, const void* next, bool useVrpt)
             },
     };
     auto result =
-      xrCreateReferenceSpace(g_session, &spaceCreateInfo, &g_currentSpace);
+      xrCreateReferenceSpace(ctx.session, &spaceCreateInfo, &ctx.currentSpace);
     if (XR_FAILED(result)) {
       PLOG_FATAL << result;
-      return {};
+      return false;
     }
   }
 
@@ -332,80 +668,250 @@ xrfwCreateSession(XrfwSwapchains* swapchains, const void* next, bool useVrpt)
             },
     };
     auto result =
-      xrCreateReferenceSpace(g_session, &spaceCreateInfo, &g_headSpace);
+      xrCreateReferenceSpace(ctx.session, &spaceCreateInfo, &ctx.headSpace);
     if (XR_FAILED(result)) {
       PLOG_FATAL << result;
-      return {};
+      return false;
     }
     spaceCreateInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
-    result = xrCreateReferenceSpace(g_session, &spaceCreateInfo, &g_localSpace);
+    result =
+      xrCreateReferenceSpace(ctx.session, &spaceCreateInfo, &ctx.localSpace);
     if (XR_FAILED(result)) {
       PLOG_FATAL << result;
-      return {};
+      return false;
     }
   }
 
   // swapchain
-  XrViewConfigurationView viewConfigurationViews[2];
-  if (!xrfwGetViewConfigurationViews(viewConfigurationViews, 2)) {
-    return {};
+  result = xrEnumerateViewConfigurationViews(g_instance,
+                                             g_systemId,
+                                             ctx.viewConfigurationType,
+                                             0,
+                                             &ctx.viewCount,
+                                             nullptr);
+  if (XR_FAILED(result)) {
+    PLOG_FATAL << "xrEnumerateViewConfigurationViews: " << result;
+    return false;
+  }
+  if (ctx.viewCount == 0 || ctx.viewCount > XRFW_MAX_VIEW_COUNT) {
+    PLOG_FATAL << "view count " << ctx.viewCount << " > "
+               << XRFW_MAX_VIEW_COUNT;
+    return false;
+  }
+  XrViewConfigurationView viewConfigurationViews[XRFW_MAX_VIEW_COUNT];
+  if (!xrfwGetViewConfigurationViews(viewConfigurationViews, ctx.viewCount)) {
+    return false;
   }
 
-  if (useVrpt) {
-    swapchains->leftOrVrpt = xrfwCreateSwapchain(viewConfigurationViews[0],
-                                                 &swapchains->format,
-                                                 &swapchains->width,
-                                                 &swapchains->height,
-                                                 2);
-    if (!swapchains->leftOrVrpt) {
-      return {};
+  swapchains->viewConfigurationType = ctx.viewConfigurationType;
+  swapchains->viewCount = ctx.viewCount;
+  for (uint32_t i = 0; i < ctx.viewCount;) {
+    // VPRT. one array swapchain for the following views of the same size
+    uint32_t arraySize = 1;
+    if (useVrpt) {
+      while (i + arraySize < ctx.viewCount &&
+             viewConfigurationViews[i + arraySize].recommendedImageRectWidth ==
+               viewConfigurationViews[i].recommendedImageRectWidth &&
+             viewConfigurationViews[i + arraySize].recommendedImageRectHeight ==
+               viewConfigurationViews[i].recommendedImageRectHeight) {
+        ++arraySize;
+      }
+    }
+    XrfwSwapchainView view;
+    view.swapchain = xrfwCreateSwapchain(viewConfigurationViews[i],
+                                         &swapchains->format,
+                                         &view.width,
+                                         &view.height,
+                                         arraySize,
+                                         i,
+                                         &view.slot,
+                                         &view.depthSwapchain,
+                                         &view.depthSlot);
+    if (!view.swapchain) {
+      return false;
     }
-  } else {
-    swapchains->leftOrVrpt = xrfwCreateSwapchain(viewConfigurationViews[0],
-                                                 &swapchains->format,
-                                                 &swapchains->width,
-                                                 &swapchains->height,
-                                                 1);
-    if (!swapchains->leftOrVrpt) {
-      return {};
+    for (uint32_t j = 0; j < arraySize; ++j, ++i) {
+      swapchains->views[i] = view;
+      swapchains->views[i].imageArrayIndex = j;
     }
-    swapchains->right = xrfwCreateSwapchain(viewConfigurationViews[1],
-                                            &swapchains->format,
-                                            &swapchains->width,
-                                            &swapchains->height,
-                                            1);
-    if (!swapchains->right) {
-      return {};
+  }
+
+  swapchains->depthFormat = ctx.depthSwapchainFormat;
+  swapchains->leftOrVrpt = swapchains->views[0].swapchain;
+  swapchains->leftOrVrptSlot = swapchains->views[0].slot;
+  swapchains->width = swapchains->views[0].width;
+  swapchains->height = swapchains->views[0].height;
+  if (ctx.viewCount > 1 && swapchains->views[1].imageArrayIndex == 0) {
+    swapchains->right = swapchains->views[1].swapchain;
+    swapchains->rightSlot = swapchains->views[1].slot;
+  }
+
+  return true;
+}
+
+XRFW_API XrSession
+xrfwCreateSession(XrfwSwapchains* swapchains, const void* next, bool useVrpt)
+{
+  auto& ctx = _xrfwContext();
+  ctx.viewConfigurationType = g_viewConfigurationType;
+  ctx.compositionLayerDepth = g_compositionLayerDepth;
+  XrSessionCreateInfo sessionCreateInfo = {
+    .type = XR_TYPE_SESSION_CREATE_INFO,
+    .next = next, // &graphicsBindingGL,
+    .createFlags = 0,
+    .systemId = g_systemId,
+  };
+
+  XrResult result;
+  {
+    // route the session events to this context. Registered under the same
+    // lock as the create, so a poll on another context cannot see the first
+    // events of the new session before the session is known.
+    std::lock_guard<std::mutex> lock(g_eventMutex);
+    result = xrCreateSession(g_instance, &sessionCreateInfo, &ctx.session);
+    if (XR_FAILED(result)) {
+      PLOG_FATAL << "xrCreateSession: " << result;
+      return nullptr;
     }
+    ctx.pendingEvents.reserve(XRFW_SESSION_EVENT_CAPACITY);
+    ctx.processingEvents.reserve(XRFW_SESSION_EVENT_CAPACITY);
+    g_sessionContexts.push_back(&ctx);
   }
 
-  return g_session;
+  if (!_xrfwInitSession(ctx, swapchains, useVrpt)) {
+    // unregisters the context and destroys the swapchains created so far
+    xrfwDestroySession(ctx.session);
+    return nullptr;
+  }
+  return ctx.session;
 }
 
 XRFW_API void
 xrfwDestroySession(void* session)
 {
-  assert(session == g_session);
+  auto& ctx = _xrfwContext();
+  assert(session == ctx.session);
+  ctx.layers = {};
+  // the handles of the live generations. a reused slot is past generation 0
+  for (uint32_t i = 0; i < MAX_SWAPCHAIN_SLOTS; ++i) {
+    auto generation = ctx.swapchainSlots[i].generation;
+    xrfwDestroySwapchain(generation << SWAPCHAIN_SLOT_INDEX_BITS | i);
+  }
+  {
+    std::lock_guard<std::mutex> lock(g_eventMutex);
+    std::erase(g_sessionContexts, &ctx);
+    ctx.pendingEvents.clear();
+  }
   xrDestroySession((XrSession)session);
+  ctx.spaceLocationCache.Clear();
+  ctx.capture.Close();
+  ctx.session = nullptr;
+  ctx.sessionState = XR_SESSION_STATE_UNKNOWN;
+  ctx.sessionRunning = false;
+}
+
+XRFW_API void
+xrfwSetViewConfiguration(XrViewConfigurationType viewConfigurationType)
+{
+  g_viewConfigurationType = viewConfigurationType;
+}
+
+XRFW_API void
+xrfwSetCompositionLayerDepth(XrBool32 enable)
+{
+  g_compositionLayerDepth = enable;
 }
 
 XRFW_API XrSpace
 xrfwAppSpace()
 {
-  return g_currentSpace;
+  return _xrfwContext().currentSpace;
+}
+
+XRFW_API XrResult
+xrfwLocateSpace(XrSpace space,
+                XrSpace baseSpace,
+                XrTime time,
+                XrSpaceLocation* location)
+{
+  return _xrfwContext().spaceLocationCache.Locate(
+    g_dispatchTable.xrLocateSpace, space, baseSpace, time, location);
+}
+
+XRFW_API void
+xrfwGetSpaceLocationCacheStats(XrfwSpaceLocationCacheStats* stats)
+{
+  *stats = _xrfwContext().spaceLocationCache.m_stats;
+}
+
+XRFW_API XrResult
+xrfwLocateSpaces(const XrSpace* spaces,
+                 uint32_t spaceCount,
+                 XrSpace baseSpace,
+                 XrTime time,
+                 XrSpaceLocation* locations)
+{
+  auto& ctx = _xrfwContext();
+#ifdef XR_KHR_locate_spaces
+  if (g_xrLocateSpaces) {
+    XrSpaceLocationDataKHR data[LOCATE_SPACES_CHUNK];
+    for (uint32_t offset = 0; offset < spaceCount;
+         offset += LOCATE_SPACES_CHUNK) {
+      auto count = std::min(spaceCount - offset, LOCATE_SPACES_CHUNK);
+      XrSpacesLocateInfoKHR locateInfo{
+        .type = XR_TYPE_SPACES_LOCATE_INFO_KHR,
+        .baseSpace = baseSpace,
+        .time = time,
+        .spaceCount = count,
+        .spaces = spaces + offset,
+      };
+      XrSpaceLocationsKHR spaceLocations{
+        .type = XR_TYPE_SPACE_LOCATIONS_KHR,
+        .locationCount = count,
+        .locations = data,
+      };
+      auto result = g_xrLocateSpaces(ctx.session, &locateInfo, &spaceLocations);
+      if (XR_FAILED(result)) {
+        XRFW_LOG_ERROR("xrLocateSpaces: ", result);
+        return result;
+      }
+      for (uint32_t i = 0; i < count; ++i) {
+        locations[offset + i].locationFlags = data[i].locationFlags;
+        locations[offset + i].pose = data[i].pose;
+      }
+    }
+    return XR_SUCCESS;
+  }
+#endif
+  for (uint32_t i = 0; i < spaceCount; ++i) {
+    auto result =
+      ctx.spaceLocationCache.Locate(g_dispatchTable.xrLocateSpace,
+                                    spaces[i],
+                                    baseSpace,
+                                    time,
+                                    &locations[i]);
+    if (XR_FAILED(result)) {
+      return result;
+    }
+  }
+  return XR_SUCCESS;
 }
 
 XRFW_API XrBool32
 xrfwGetViewConfigurationViews(XrViewConfigurationView* viewConfigurationViews,
                               uint32_t viewCount)
 {
+  auto& ctx = _xrfwContext();
+  // before xrfwCreateSession, the requested one
+  auto viewConfigurationType =
+    ctx.session ? ctx.viewConfigurationType : g_viewConfigurationType;
 
   for (int i = 0; i < viewCount; ++i) {
     viewConfigurationViews[i] = { XR_TYPE_VIEW_CONFIGURATION_VIEW };
   }
   auto result = xrEnumerateViewConfigurationViews(g_instance,
                                                   g_systemId,
-                                                  g_supportedViewConfigType,
+                                                  viewConfigurationType,
                                                   viewCount,
                                                   &viewCount,
                                                   viewConfigurationViews);
@@ -432,14 +938,92 @@ xrfwGetViewConfigurationViews(XrViewConfigurationView* viewConfigurationViews,
   return XR_TRUE;
 }
 
+// create a swapchain into a free slot
+static uint32_t
+_xrfwCreateSwapchainSlot(XrfwContext& ctx,
+                         const XrSwapchainCreateInfo& swapchainCreateInfo,
+                         uint32_t viewIndex,
+                         SwapchainUsage usage)
+{
+  auto slot = std::find_if(
+    ctx.swapchainSlots.begin(), ctx.swapchainSlots.end(), [](const auto& slot) {
+      return slot.swapchain == XR_NULL_HANDLE;
+    });
+  if (slot == ctx.swapchainSlots.end()) {
+    PLOG_FATAL << "no free swapchain slot: " << MAX_SWAPCHAIN_SLOTS;
+    return XRFW_INVALID_SWAPCHAIN_SLOT;
+  }
+
+  XrSwapchain swapchain;
+  auto result =
+    xrCreateSwapchain(ctx.session, &swapchainCreateInfo, &swapchain);
+  if (XR_FAILED(result)) {
+    PLOG_FATAL << result;
+    return XRFW_INVALID_SWAPCHAIN_SLOT;
+  }
+
+  uint32_t imageCount;
+  result = xrEnumerateSwapchainImages(swapchain, 0, &imageCount, nullptr);
+  if (XR_FAILED(result)) {
+    PLOG_FATAL << result;
+    xrDestroySwapchain(swapchain);
+    return XRFW_INVALID_SWAPCHAIN_SLOT;
+  }
+
+  // XXX This should really just return XrSwapchainImageBaseHeader*
+  auto swapchainImages = g_init.allocateSwapchainImageStructsCallback(
+    imageCount, swapchainCreateInfo);
+  result = xrEnumerateSwapchainImages(
+    swapchain, imageCount, &imageCount, swapchainImages[0]);
+  if (XR_FAILED(result)) {
+    PLOG_FATAL << result;
+    xrDestroySwapchain(swapchain);
+    return XRFW_INVALID_SWAPCHAIN_SLOT;
+  }
+
+  *slot = SwapchainSlot{
+    .swapchain = swapchain,
+    .viewIndex = viewIndex,
+    .width = static_cast<int>(swapchainCreateInfo.width),
+    .height = static_cast<int>(swapchainCreateInfo.height),
+    .images = swapchainImages,
+    .arraySize = swapchainCreateInfo.arraySize,
+    .usage = usage,
+    .generation = slot->generation,
+  };
+  return slot->generation << SWAPCHAIN_SLOT_INDEX_BITS |
+         static_cast<uint32_t>(slot - ctx.swapchainSlots.begin());
+}
+
+// nullptr for an invalid, destroyed or stale handle
+static SwapchainSlot*
+_xrfwGetSwapchainSlot(XrfwContext& ctx, uint32_t slot)
+{
+  auto index = slot & ((1u << SWAPCHAIN_SLOT_INDEX_BITS) - 1);
+  if (index >= MAX_SWAPCHAIN_SLOTS) {
+    return nullptr;
+  }
+  auto& info = ctx.swapchainSlots[index];
+  if (!info.swapchain ||
+      info.generation != slot >> SWAPCHAIN_SLOT_INDEX_BITS) {
+    return nullptr;
+  }
+  return &info;
+}
+
 XRFW_API XrSwapchain
 xrfwCreateSwapchain(const XrViewConfigurationView& viewConfigurationView,
                     uint64_t* format,
                     int* width,
                     int* height,
-                    uint32_t arraySize)
+                    uint32_t arraySize,
+                    uint32_t viewIndex,
+                    uint32_t* outSlot,
+                    XrSwapchain* outDepthSwapchain,
+                    uint32_t* outDepthSlot)
 {
-  auto swapchainFormats = _xrfwGetSwapchainFormats(g_session);
+  auto& ctx = _xrfwContext();
+  auto swapchainFormats = _xrfwGetSwapchainFormats(ctx.session);
   auto colorSwapchainFormat =
     g_init.selectColorSwapchainFormatCallback(swapchainFormats);
   *format = colorSwapchainFormat;
@@ -466,85 +1050,131 @@ xrfwCreateSwapchain(const XrViewConfigurationView& viewConfigurationView,
     .arraySize = arraySize,
     .mipCount = 1,
   };
-
-  XrSwapchain swapchain;
-  auto result = xrCreateSwapchain(g_session, &swapchainCreateInfo, &swapchain);
-  if (XR_FAILED(result)) {
-    PLOG_FATAL << result;
+  auto slot = _xrfwCreateSwapchainSlot(
+    ctx, swapchainCreateInfo, viewIndex, SwapchainUsage::Projection);
+  if (slot == XRFW_INVALID_SWAPCHAIN_SLOT) {
     return {};
   }
 
-  uint32_t imageCount;
-  result = xrEnumerateSwapchainImages(swapchain, 0, &imageCount, nullptr);
-  if (XR_FAILED(result)) {
-    PLOG_FATAL << result;
-    return {};
+  // depth swapchain of the same size
+  if (ctx.compositionLayerDepth) {
+    auto depthSwapchainFormat =
+      g_init.selectDepthSwapchainFormatCallback(swapchainFormats);
+    if (depthSwapchainFormat) {
+      PLOG_INFO << "Creating depth swapchain Format=" << depthSwapchainFormat;
+      auto depthCreateInfo = swapchainCreateInfo;
+      depthCreateInfo.usageFlags = XR_SWAPCHAIN_USAGE_SAMPLED_BIT |
+                                   XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+      depthCreateInfo.format = depthSwapchainFormat;
+      auto depthSlot = _xrfwCreateSwapchainSlot(
+        ctx, depthCreateInfo, viewIndex, SwapchainUsage::Depth);
+      if (depthSlot == XRFW_INVALID_SWAPCHAIN_SLOT) {
+        xrfwDestroySwapchain(slot);
+        return {};
+      }
+      _xrfwGetSwapchainSlot(ctx, slot)->depthSlot = depthSlot;
+      ctx.depthSwapchainFormat = depthSwapchainFormat;
+    } else {
+      PLOG_WARNING << "no depth swapchain format. "
+                   << XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME
+                   << " disabled";
+      ctx.compositionLayerDepth = false;
+    }
   }
 
-  // XXX This should really just return XrSwapchainImageBaseHeader*
-  auto swapchainImages = g_init.allocateSwapchainImageStructsCallback(
-    imageCount, swapchainCreateInfo);
-  result = xrEnumerateSwapchainImages(
-    swapchain, imageCount, &imageCount, swapchainImages[0]);
-  if (XR_FAILED(result)) {
-    PLOG_FATAL << result;
-    return {};
+  auto& info = *_xrfwGetSwapchainSlot(ctx, slot);
+  *width = info.width;
+  *height = info.height;
+  if (outSlot) {
+    *outSlot = slot;
   }
+  if (outDepthSwapchain) {
+    auto depth = _xrfwGetSwapchainSlot(ctx, info.depthSlot);
+    *outDepthSwapchain = depth ? depth->swapchain : XR_NULL_HANDLE;
+  }
+  if (outDepthSlot) {
+    *outDepthSlot = info.depthSlot;
+  }
+  return info.swapchain;
+}
 
-  auto index = (uint32_t)g_swapchainImages.size();
-  g_swapchainImages.insert(
-    std::make_pair(swapchain,
-                   SwapchainInfo{
-                     .index = index,
-                     .width = static_cast<int>(swapchainCreateInfo.width),
-                     .height = static_cast<int>(swapchainCreateInfo.height),
-                     .images = swapchainImages,
-                     .useVprt = (arraySize == 2),
-                   }));
+XRFW_API void
+xrfwDestroySwapchain(uint32_t slot)
+{
+  auto& ctx = _xrfwContext();
+  auto info = _xrfwGetSwapchainSlot(ctx, slot);
+  if (!info) {
+    return;
+  }
+  xrfwDestroySwapchain(info->depthSlot);
+  auto result = xrDestroySwapchain(info->swapchain);
+  if (XR_FAILED(result)) {
+    PLOG_FATAL << "xrDestroySwapchain: " << result;
+  }
+  auto generation =
+    (info->generation + 1) & (UINT32_MAX >> SWAPCHAIN_SLOT_INDEX_BITS);
+  *info = {};
+  info->generation = generation;
+}
 
-  *width = swapchainCreateInfo.width;
-  *height = swapchainCreateInfo.height;
-  return swapchain;
+static uint32_t
+_xrfwFindSwapchainSlot(XrfwContext& ctx, XrSwapchain swapchain)
+{
+  for (uint32_t i = 0; i < MAX_SWAPCHAIN_SLOTS; ++i) {
+    auto& info = ctx.swapchainSlots[i];
+    if (info.swapchain && info.swapchain == swapchain) {
+      return info.generation << SWAPCHAIN_SLOT_INDEX_BITS | i;
+    }
+  }
+  return XRFW_INVALID_SWAPCHAIN_SLOT;
 }
 
-XRFW_API const XrSwapchainImageBaseHeader*
-xrfwAcquireSwapchain(XrSwapchain swapchain)
+static const XrSwapchainImageBaseHeader*
+_xrfwAcquireSwapchainSlot(XrfwContext& ctx, uint32_t slot)
 {
-  auto found = g_swapchainImages.find(swapchain);
-  if (found == g_swapchainImages.end()) {
+  auto found = _xrfwGetSwapchainSlot(ctx, slot);
+  if (!found) {
     return {};
   }
-  auto& info = found->second;
-  g_projectionViews[info.index].subImage = {
-      .swapchain = swapchain,
-      .imageRect =
-          {
-              .offset = {0, 0},
-              .extent = {info.width, info.height},
-          },
-      .imageArrayIndex = 0,
-  };
-  if (info.useVprt) {
-    assert(info.index == 0);
-    g_projectionViews[1].subImage = {
+  auto& info = *found;
+  auto swapchain = info.swapchain;
+  for (uint32_t i = 0;
+       info.usage != SwapchainUsage::Layer && i < info.arraySize;
+       ++i) {
+    assert(info.viewIndex + i < XRFW_MAX_VIEW_COUNT);
+    XrSwapchainSubImage subImage{
         .swapchain = swapchain,
         .imageRect =
             {
                 .offset = {0, 0},
                 .extent = {info.width, info.height},
             },
-        .imageArrayIndex = 1,
+        .imageArrayIndex = i,
     };
+    if (info.usage == SwapchainUsage::Depth) {
+      // GL depth range. same near, far as the projection matrix
+      ctx.depthInfos[info.viewIndex + i] = {
+        .type = XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR,
+        .next = nullptr,
+        .subImage = subImage,
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f,
+        .nearZ = NEAR_Z,
+        .farZ = FAR_Z,
+      };
+    } else {
+      ctx.projectionViews[info.viewIndex + i].subImage = subImage;
+    }
   }
 
   XrSwapchainImageAcquireInfo acquireInfo{
     XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO
   };
   uint32_t swapchainImageIndex;
-  auto result =
-    xrAcquireSwapchainImage(swapchain, &acquireInfo, &swapchainImageIndex);
+  auto result = g_dispatchTable.xrAcquireSwapchainImage(
+    swapchain, &acquireInfo, &swapchainImageIndex);
   if (XR_FAILED(result)) {
-    PLOG_FATAL << "xrAcquireSwapchainImage: " << result;
+    XRFW_LOG_FATAL("xrAcquireSwapchainImage: ", result);
     return {};
   }
 
@@ -552,25 +1182,281 @@ xrfwAcquireSwapchain(XrSwapchain swapchain)
     .type = XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO,
     .timeout = XR_INFINITE_DURATION,
   };
-  result = xrWaitSwapchainImage(swapchain, &waitInfo);
+  result = g_dispatchTable.xrWaitSwapchainImage(swapchain, &waitInfo);
   if (XR_FAILED(result)) {
-    PLOG_FATAL << "xrWaitSwapchainImage: " << result;
+    XRFW_LOG_FATAL("xrWaitSwapchainImage: ", result);
     return {};
   }
 
-  return g_swapchainImages[swapchain].images[swapchainImageIndex];
+  if (info.usage == SwapchainUsage::Projection) {
+    // chain the depth info to the projection views
+    const XrSwapchainImageBaseHeader* depthImage = nullptr;
+    if (info.depthSlot != XRFW_INVALID_SWAPCHAIN_SLOT) {
+      depthImage = _xrfwAcquireSwapchainSlot(ctx, info.depthSlot);
+      if (!depthImage) {
+        // the caller releases nothing after a failed acquire
+        XrSwapchainImageReleaseInfo releaseInfo{
+          XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO
+        };
+        result =
+          g_dispatchTable.xrReleaseSwapchainImage(swapchain, &releaseInfo);
+        if (XR_FAILED(result)) {
+          XRFW_LOG_FATAL("xrReleaseSwapchainImage: ", result);
+        }
+        return {};
+      }
+    }
+    for (uint32_t i = 0; i < info.arraySize; ++i) {
+      ctx.depthImages[info.viewIndex + i] = depthImage;
+      ctx.projectionViews[info.viewIndex + i].next =
+        depthImage ? &ctx.depthInfos[info.viewIndex + i] : nullptr;
+    }
+  }
+
+  return info.images[swapchainImageIndex];
 }
 
-XRFW_API void
-xrfwReleaseSwapchain(XrSwapchain swapchain)
+XRFW_API const XrSwapchainImageBaseHeader*
+xrfwAcquireSwapchainSlot(uint32_t slot)
 {
+  auto& ctx = _xrfwContext();
+  auto begin = xrfwNowNanoseconds();
+  auto image = _xrfwAcquireSwapchainSlot(ctx, slot);
+  auto end = xrfwNowNanoseconds();
+  ctx.frameRecorder.Acquire(begin, end);
+  _xrfwTrace("xrfwAcquireSwapchainSlot", begin, end);
+  return image;
+}
+
+static void
+_xrfwReleaseSwapchainSlot(XrfwContext& ctx, uint32_t slot)
+{
+  auto info = _xrfwGetSwapchainSlot(ctx, slot);
+  if (!info) {
+    return;
+  }
   XrSwapchainImageReleaseInfo releaseInfo{
     XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO
   };
-  auto result = xrReleaseSwapchainImage(swapchain, &releaseInfo);
+  auto result =
+    g_dispatchTable.xrReleaseSwapchainImage(info->swapchain, &releaseInfo);
   if (XR_FAILED(result)) {
-    PLOG_FATAL << "xrReleaseSwapchainImage: " << result;
+    XRFW_LOG_FATAL("xrReleaseSwapchainImage: ", result);
+  }
+  _xrfwReleaseSwapchainSlot(ctx, info->depthSlot);
+}
+
+XRFW_API void
+xrfwReleaseSwapchainSlot(uint32_t slot)
+{
+  auto& ctx = _xrfwContext();
+  if (!_xrfwGetSwapchainSlot(ctx, slot)) {
+    return;
+  }
+  auto begin = xrfwNowNanoseconds();
+  _xrfwReleaseSwapchainSlot(ctx, slot);
+  auto end = xrfwNowNanoseconds();
+  ctx.frameRecorder.Release(begin, end);
+  _xrfwTrace("xrfwReleaseSwapchainSlot", begin, end);
+}
+
+XRFW_API const XrSwapchainImageBaseHeader*
+xrfwGetDepthSwapchainImage(uint32_t viewIndex)
+{
+  auto& ctx = _xrfwContext();
+  if (viewIndex >= XRFW_MAX_VIEW_COUNT) {
+    return nullptr;
   }
+  return ctx.depthImages[viewIndex];
+}
+
+XRFW_API const XrSwapchainImageBaseHeader*
+xrfwAcquireSwapchain(XrSwapchain swapchain)
+{
+  auto& ctx = _xrfwContext();
+  return xrfwAcquireSwapchainSlot(_xrfwFindSwapchainSlot(ctx, swapchain));
+}
+
+XRFW_API void
+xrfwReleaseSwapchain(XrSwapchain swapchain)
+{
+  auto& ctx = _xrfwContext();
+  xrfwReleaseSwapchainSlot(_xrfwFindSwapchainSlot(ctx, swapchain));
+}
+
+static Layer*
+_xrfwGetLayer(XrfwContext& ctx, uint32_t layer)
+{
+  if (layer >= MAX_LAYERS ||
+      ctx.layers[layer].swapchainSlot == XRFW_INVALID_SWAPCHAIN_SLOT) {
+    return nullptr;
+  }
+  return &ctx.layers[layer];
+}
+
+XRFW_API uint32_t
+xrfwCreateLayer(const XrfwLayerCreateInfo* createInfo)
+{
+  auto& ctx = _xrfwContext();
+  if (createInfo->shape == XRFW_LAYER_CYLINDER &&
+      !xrfwIsExtensionEnabled(
+        XrfwExtension::KHR_composition_layer_cylinder)) {
+    PLOG_FATAL << XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME
+               << " is not enabled";
+    return XRFW_INVALID_LAYER;
+  }
+  auto layer =
+    std::find_if(ctx.layers.begin(), ctx.layers.end(), [](const auto& layer) {
+      return layer.swapchainSlot == XRFW_INVALID_SWAPCHAIN_SLOT;
+    });
+  if (layer == ctx.layers.end()) {
+    PLOG_FATAL << "no free layer: " << MAX_LAYERS;
+    return XRFW_INVALID_LAYER;
+  }
+
+  auto swapchainFormats = _xrfwGetSwapchainFormats(ctx.session);
+  XrSwapchainCreateInfo swapchainCreateInfo{
+    .type = XR_TYPE_SWAPCHAIN_CREATE_INFO,
+    .next = nullptr,
+    .createFlags = static_cast<XrSwapchainCreateFlags>(
+      createInfo->staticImage ? XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT : 0),
+    .usageFlags =
+      XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT,
+    .format = g_init.selectColorSwapchainFormatCallback(swapchainFormats),
+    .sampleCount = 1,
+    .width = static_cast<uint32_t>(createInfo->width),
+    .height = static_cast<uint32_t>(createInfo->height),
+    .faceCount = 1,
+    .arraySize = 1,
+    .mipCount = 1,
+  };
+  auto slot = _xrfwCreateSwapchainSlot(
+    ctx, swapchainCreateInfo, 0, SwapchainUsage::Layer);
+  if (slot == XRFW_INVALID_SWAPCHAIN_SLOT) {
+    return XRFW_INVALID_LAYER;
+  }
+
+  XrSwapchainSubImage subImage{
+      .swapchain = _xrfwGetSwapchainSlot(ctx, slot)->swapchain,
+      .imageRect =
+          {
+              .offset = {0, 0},
+              .extent = {createInfo->width, createInfo->height},
+          },
+      .imageArrayIndex = 0,
+  };
+  auto space = createInfo->headLocked ? ctx.headSpace : ctx.currentSpace;
+  *layer = Layer{
+    .swapchainSlot = slot,
+    .info = *createInfo,
+    .quad =
+      {
+        .type = XR_TYPE_COMPOSITION_LAYER_QUAD,
+        .next = nullptr,
+        .layerFlags = createInfo->layerFlags,
+        .space = space,
+        .eyeVisibility = XR_EYE_VISIBILITY_BOTH,
+        .subImage = subImage,
+        .pose = createInfo->pose,
+        .size = createInfo->size,
+      },
+    .cylinder =
+      {
+        .type = XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR,
+        .next = nullptr,
+        .layerFlags = createInfo->layerFlags,
+        .space = space,
+        .eyeVisibility = XR_EYE_VISIBILITY_BOTH,
+        .subImage = subImage,
+        .pose = createInfo->pose,
+        .radius = createInfo->radius,
+        .centralAngle = createInfo->centralAngle,
+        .aspectRatio = createInfo->aspectRatio,
+      },
+  };
+  return static_cast<uint32_t>(layer - ctx.layers.begin());
+}
+
+XRFW_API void
+xrfwDestroyLayer(uint32_t layer)
+{
+  auto& ctx = _xrfwContext();
+  if (auto p = _xrfwGetLayer(ctx, layer)) {
+    xrfwDestroySwapchain(p->swapchainSlot);
+    *p = {};
+  }
+}
+
+XRFW_API void
+xrfwSetLayerPose(uint32_t layer, const XrPosef* pose)
+{
+  auto& ctx = _xrfwContext();
+  if (auto p = _xrfwGetLayer(ctx, layer)) {
+    p->info.pose = *pose;
+    p->quad.pose = *pose;
+    p->cylinder.pose = *pose;
+  }
+}
+
+XRFW_API void
+xrfwSetLayerVisible(uint32_t layer, XrBool32 visible)
+{
+  auto& ctx = _xrfwContext();
+  if (auto p = _xrfwGetLayer(ctx, layer)) {
+    p->visible = visible;
+  }
+}
+
+XRFW_API void
+xrfwInvalidateLayer(uint32_t layer)
+{
+  auto& ctx = _xrfwContext();
+  if (auto p = _xrfwGetLayer(ctx, layer)) {
+    if (p->info.staticImage && p->rendered) {
+      // a static swapchain is acquired only once
+      XRFW_LOG_WARNING("static layer ", layer, " can not be re-rendered");
+      return;
+    }
+    p->dirty = true;
+  }
+}
+
+XRFW_API uint32_t
+xrfwUpdateLayers(const XrCompositionLayerBaseHeader** layers,
+                 uint32_t layerCount,
+                 uint32_t capacity)
+{
+  auto& ctx = _xrfwContext();
+  capacity = std::min(capacity, g_maxLayerCount);
+  for (auto& layer : ctx.layers) {
+    if (layerCount >= capacity) {
+      break;
+    }
+    if (layer.swapchainSlot == XRFW_INVALID_SWAPCHAIN_SLOT || !layer.visible) {
+      continue;
+    }
+    if (layer.dirty) {
+      // not the projection acquire / release of the frame stats. a trace
+      // phase of its own
+      XRFW_TRACE_SCOPE("xrfwUpdateLayers layer");
+      if (auto image = _xrfwAcquireSwapchainSlot(ctx, layer.swapchainSlot)) {
+        if (layer.info.render) {
+          layer.info.render(
+            image, layer.info.width, layer.info.height, layer.info.user);
+        }
+        _xrfwReleaseSwapchainSlot(ctx, layer.swapchainSlot);
+        layer.dirty = false;
+        layer.rendered = true;
+      }
+    }
+    if (layer.rendered) {
+      layers[layerCount++] =
+        layer.info.shape == XRFW_LAYER_CYLINDER
+          ? (const XrCompositionLayerBaseHeader*)&layer.cylinder
+          : (const XrCompositionLayerBaseHeader*)&layer.quad;
+    }
+  }
+  return layerCount;
 }
 
 // Return event if one is available, otherwise return null.
@@ -582,12 +1468,12 @@ TryReadNextEvent()
   auto baseHeader =
     reinterpret_cast<XrEventDataBaseHeader*>(&g_eventDataBuffer);
   *baseHeader = { XR_TYPE_EVENT_DATA_BUFFER };
-  auto result = xrPollEvent(g_instance, &g_eventDataBuffer);
+  auto result = g_dispatchTable.xrPollEvent(g_instance, &g_eventDataBuffer);
   if (result == XR_SUCCESS) {
     if (baseHeader->type == XR_TYPE_EVENT_DATA_EVENTS_LOST) {
       const XrEventDataEventsLost* const eventsLost =
         reinterpret_cast<const XrEventDataEventsLost*>(baseHeader);
-      PLOG_WARNING << eventsLost << " events lost";
+      XRFW_LOG_WARNING(eventsLost->lostEventCount, " events lost");
     }
 
     return baseHeader;
@@ -601,68 +1487,66 @@ TryReadNextEvent()
 
 static void
 HandleSessionStateChangedEvent(
+  XrfwContext& ctx,
   const XrEventDataSessionStateChanged& stateChangedEvent,
   SessionBeginFunc begin,
   SessionEndFunc end,
   void* user)
 {
-  auto oldState = g_sessionState;
-  g_sessionState = stateChangedEvent.state;
-  PLOG_INFO << oldState << " => " << g_sessionState
-    // << " session=" << stateChangedEvent.session
-    // << " time=" << stateChangedEvent.time
-    ;
-
-  if ((stateChangedEvent.session != XR_NULL_HANDLE) &&
-      (stateChangedEvent.session != g_session)) {
-    throw std::runtime_error(
-      "XrEventDataSessionStateChanged for unknown session");
+  auto oldState = ctx.sessionState;
+  ctx.sessionState = stateChangedEvent.state;
+  XRFW_LOG_INFO(oldState, " => ", ctx.sessionState);
+  if (ctx.capture.IsOpen()) {
+    ctx.capture.Append(XRFW_CAPTURE_SESSION_STATE,
+                       XrfwCaptureSessionState{
+                         .state = stateChangedEvent.state,
+                         .time = stateChangedEvent.time,
+                       });
   }
 
-  switch (g_sessionState) {
+  switch (ctx.sessionState) {
 
     case XR_SESSION_STATE_READY: {
       XrSessionBeginInfo sessionBeginInfo{
         .type = XR_TYPE_SESSION_BEGIN_INFO,
-        .primaryViewConfigurationType =
-          XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO,
+        .primaryViewConfigurationType = ctx.viewConfigurationType,
       };
-      auto result = xrBeginSession(g_session, &sessionBeginInfo);
+      auto result = xrBeginSession(ctx.session, &sessionBeginInfo);
       if (XR_FAILED(result)) {
         PLOG_FATAL << result;
         throw std::runtime_error("[xrBeginSession]");
       }
-      PLOG_INFO << "xrBeginSession";
+      XRFW_LOG_INFO("xrBeginSession");
       if (begin) {
-        begin(g_session, user);
+        begin(ctx.session, user);
       }
-      g_sessionRunning = true;
+      ctx.sessionRunning = true;
       break;
     }
 
     case XR_SESSION_STATE_STOPPING: {
-      auto result = xrEndSession(g_session);
+      auto result = xrEndSession(ctx.session);
       if (XR_FAILED(result)) {
         PLOG_FATAL << result;
         throw std::runtime_error("[xrEndSession]");
       }
-      PLOG_INFO << "xrEndSession";
+      XRFW_LOG_INFO("xrEndSession");
       if (end) {
-        end(g_session, user);
+        end(ctx.session, user);
       }
-      g_sessionRunning = false;
+      ctx.sessionRunning = false;
       break;
     }
 
     case XR_SESSION_STATE_EXITING: {
       // Do not attempt to restart because user closed this session.
-      g_sessionRunning = false;
+      ctx.sessionRunning = false;
       break;
     }
 
     case XR_SESSION_STATE_LOSS_PENDING: {
       // Poll for a new instance.
-      g_sessionRunning = false;
+      ctx.sessionRunning = false;
       break;
     }
 
@@ -676,32 +1560,61 @@ xrfwPollEventsIsSessionActive(SessionBeginFunc begin,
                               SessionEndFunc end,
                               void* user)
 {
-  // Process all pending messages.
-  while (const XrEventDataBaseHeader* event = TryReadNextEvent()) {
-    switch (event->type) {
-      case XR_TYPE_EVENT_DATA_INSTANCE_LOSS_PENDING: {
-        const auto& instanceLossPending =
-          *reinterpret_cast<const XrEventDataInstanceLossPending*>(event);
-        PLOG_WARNING << "XrEventDataInstanceLossPending by "
-                     << instanceLossPending.lossTime;
-        break;
-      }
-
-      case XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED: {
-        auto sessionStateChangedEvent =
-          *reinterpret_cast<const XrEventDataSessionStateChanged*>(event);
-        HandleSessionStateChangedEvent(
-          sessionStateChangedEvent, begin, end, user);
-        break;
-      }
-
-      default: {
-        PLOG_INFO << "unknown event type " << event->type;
-        break;
+  XRFW_TRACE_SCOPE("xrfwPollEventsIsSessionActive");
+  auto& ctx = _xrfwContext();
+  {
+    // Process all pending messages. The events of the other sessions are
+    // queued to their contexts.
+    std::lock_guard<std::mutex> lock(g_eventMutex);
+    while (const XrEventDataBaseHeader* event = TryReadNextEvent()) {
+      switch (event->type) {
+        case XR_TYPE_EVENT_DATA_INSTANCE_LOSS_PENDING: {
+          const auto& instanceLossPending =
+            *reinterpret_cast<const XrEventDataInstanceLossPending*>(event);
+          XRFW_LOG_WARNING("XrEventDataInstanceLossPending by ",
+                           instanceLossPending.lossTime);
+          break;
+        }
+
+        case XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED: {
+          auto sessionStateChangedEvent =
+            *reinterpret_cast<const XrEventDataSessionStateChanged*>(event);
+          auto found = std::find_if(
+            g_sessionContexts.begin(),
+            g_sessionContexts.end(),
+            [session = sessionStateChangedEvent.session](auto context) {
+              return context->session == session;
+            });
+          if (found == g_sessionContexts.end()) {
+            XRFW_LOG_WARNING(
+              "XrEventDataSessionStateChanged for unknown session");
+            break;
+          }
+          (*found)->pendingEvents.push_back(sessionStateChangedEvent);
+          break;
+        }
+
+        default: {
+          XRFW_LOG_INFO("unknown event type ", event->type);
+          break;
+        }
       }
     }
+    std::swap(ctx.pendingEvents, ctx.processingEvents);
   }
-  return g_sessionRunning;
+
+  // outside the lock. begin and end call back the app
+  for (auto& event : ctx.processingEvents) {
+    HandleSessionStateChangedEvent(ctx, event, begin, end, user);
+  }
+  ctx.processingEvents.clear();
+  return ctx.sessionRunning;
+}
+
+XRFW_API XrSessionState
+xrfwGetSessionState()
+{
+  return _xrfwContext().sessionState;
 }
 
 static void
@@ -714,110 +1627,445 @@ poseToMatrix(XrMatrix4x4f* view, const XrPosef& pose)
   XrMatrix4x4f_InvertRigidBody(view, &toView);
 }
 
-XRFW_API const XrCompositionLayerBaseHeader*
-xrfwBeginFrame(XrTime* outtime, XrfwViewMatrices* viewMatrix)
+XRFW_API XrBool32
+xrfwWaitFrame(XrFrameState* outFrameState)
 {
+  auto& ctx = _xrfwContext();
+  auto begin = xrfwNowNanoseconds();
   XrFrameWaitInfo frameWaitInfo{ XR_TYPE_FRAME_WAIT_INFO };
-  XrFrameState frameState{ XR_TYPE_FRAME_STATE };
-  auto result = xrWaitFrame(g_session, &frameWaitInfo, &frameState);
+  *outFrameState = { XR_TYPE_FRAME_STATE };
+  auto result =
+    g_dispatchTable.xrWaitFrame(ctx.session, &frameWaitInfo, outFrameState);
+  auto end = xrfwNowNanoseconds();
+  ctx.frameRecorder.WaitFrame(begin, end);
+  _xrfwTrace("xrfwWaitFrame", begin, end);
   if (XR_FAILED(result)) {
-    PLOG_FATAL << result;
-    return nullptr;
+    XRFW_LOG_FATAL("xrWaitFrame: ", result);
+    return false;
+  }
+  if (ctx.capture.IsOpen()) {
+    ctx.capture.Append(XRFW_CAPTURE_FRAME_STATE,
+                       XrfwCaptureFrameState{
+                         .predictedDisplayTime =
+                           outFrameState->predictedDisplayTime,
+                         .predictedDisplayPeriod =
+                           outFrameState->predictedDisplayPeriod,
+                         .shouldRender = outFrameState->shouldRender,
+                       });
   }
-  g_frameState = frameState;
+  return true;
+}
+
+static void
+_xrfwCaptureViews(XrfwContext& ctx,
+                  XrTime displayTime,
+                  XrViewStateFlags viewStateFlags,
+                  const XrView views[XRFW_MAX_VIEW_COUNT])
+{
+  if (!ctx.capture.IsOpen()) {
+    return;
+  }
+  XrfwCaptureViews captureViews{
+    .displayTime = displayTime,
+    .viewStateFlags = viewStateFlags,
+    .viewCount = ctx.viewCount,
+  };
+  XrfwCaptureView captureView[XRFW_MAX_VIEW_COUNT];
+  for (uint32_t i = 0; i < ctx.viewCount; ++i) {
+    captureView[i] = { views[i].pose, views[i].fov };
+  }
+  ctx.capture.AppendAt(displayTime,
+                       XRFW_CAPTURE_VIEWS,
+                       &captureViews,
+                       sizeof(captureViews),
+                       captureView,
+                       sizeof(XrfwCaptureView) * ctx.viewCount);
+}
+
+// false if xrLocateViews fails. the capture is left to the caller
+static bool
+_xrfwLocateViews(XrfwContext& ctx,
+                 XrTime displayTime,
+                 XrView views[XRFW_MAX_VIEW_COUNT],
+                 XrViewStateFlags* viewStateFlags)
+{
+  XrViewState viewState{ XR_TYPE_VIEW_STATE };
+  XrViewLocateInfo viewLocateInfo{
+    .type = XR_TYPE_VIEW_LOCATE_INFO,
+    .viewConfigurationType = ctx.viewConfigurationType,
+    .displayTime = displayTime,
+    .space = ctx.currentSpace,
+  };
+  uint32_t viewCountOutput;
+  auto result = g_dispatchTable.xrLocateViews(ctx.session,
+                                              &viewLocateInfo,
+                                              &viewState,
+                                              ctx.viewCount,
+                                              &viewCountOutput,
+                                              views);
+  if (XR_FAILED(result)) {
+    XRFW_LOG_FATAL("xrLocateViews: ", result);
+    return false;
+  }
+  assert(viewCountOutput == ctx.viewCount);
+  *viewStateFlags = viewState.viewStateFlags;
+  return true;
+}
+
+static bool
+_xrfwViewsTracked(XrViewStateFlags viewStateFlags)
+{
+  return (viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT) != 0 &&
+         (viewStateFlags & XR_VIEW_STATE_ORIENTATION_VALID_BIT) != 0;
+}
+
+static const XrCompositionLayerBaseHeader*
+_xrfwBeginFrameWithState(XrfwContext& ctx,
+                         const XrFrameState* pFrameState,
+                         XrTime* outtime,
+                         XrfwViewMatrices* viewMatrix)
+{
+  const auto& frameState = *pFrameState;
+  ctx.frameState = frameState;
+  ctx.spaceLocationCache.Clear();
   *outtime = frameState.predictedDisplayTime;
 
-  static XrBool32 shouldRender_ = false;
-  if (shouldRender_ != frameState.shouldRender) {
-    PLOG_INFO << "shouldRender: " << shouldRender_ << " => "
-              << frameState.shouldRender;
-    shouldRender_ = frameState.shouldRender;
+  if (ctx.shouldRender != frameState.shouldRender) {
+    XRFW_LOG_INFO(
+      "shouldRender: ", ctx.shouldRender, " => ", frameState.shouldRender);
+    ctx.shouldRender = frameState.shouldRender;
   }
 
   XrFrameBeginInfo frameBeginInfo{ XR_TYPE_FRAME_BEGIN_INFO };
-  result = xrBeginFrame(g_session, &frameBeginInfo);
+  auto result = g_dispatchTable.xrBeginFrame(ctx.session, &frameBeginInfo);
   if (XR_FAILED(result)) {
-    PLOG_FATAL << result;
+    XRFW_LOG_FATAL("xrBeginFrame: ", result);
     return nullptr;
   }
 
-  XrView views[2]{
+  XrView views[XRFW_MAX_VIEW_COUNT]{
+    { XR_TYPE_VIEW },
+    { XR_TYPE_VIEW },
     { XR_TYPE_VIEW },
     { XR_TYPE_VIEW },
   };
-  if (shouldRender_) {
+  if (ctx.shouldRender) {
     // view
-    XrViewState viewState{ XR_TYPE_VIEW_STATE };
-    XrViewLocateInfo viewLocateInfo{
-      .type = XR_TYPE_VIEW_LOCATE_INFO,
-      .viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO,
-      .displayTime = frameState.predictedDisplayTime,
-      .space = g_currentSpace,
-    };
-    uint32_t viewCountOutput;
-    auto result = xrLocateViews(
-      g_session, &viewLocateInfo, &viewState, 2, &viewCountOutput, views);
-    if (XR_FAILED(result)) {
-      PLOG_FATAL << "xrLocateViews: " << result;
+    XrViewStateFlags viewStateFlags;
+    if (!_xrfwLocateViews(
+          ctx, frameState.predictedDisplayTime, views, &viewStateFlags)) {
       return nullptr;
     }
-    if ((viewState.viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT) == 0 ||
-        (viewState.viewStateFlags & XR_VIEW_STATE_ORIENTATION_VALID_BIT) == 0) {
+    if (ctx.lateLatch && ctx.lateLatchCallback && ctx.capture.IsOpen()) {
+      // recorded by xrfwEndFrame, after the late latch
+      ctx.captureViewsPending = true;
+      ctx.captureViewStateFlags = viewStateFlags;
+      std::copy_n(views, ctx.viewCount, ctx.captureViews);
+    } else {
+      _xrfwCaptureViews(
+        ctx, frameState.predictedDisplayTime, viewStateFlags, views);
+    }
+    if (!_xrfwViewsTracked(viewStateFlags)) {
       return nullptr; // There is no valid tracking poses for the views.
     }
-    assert(viewCountOutput == 2);
 
     // update matrix
-    XrMatrix4x4f_CreateProjectionFov((XrMatrix4x4f*)viewMatrix->leftProjection,
-                                     GRAPHICS_OPENGL,
-                                     views[0].fov,
-                                     0.05f,
-                                     100.0f);
-    poseToMatrix((XrMatrix4x4f*)viewMatrix->leftView, views[0].pose);
-    XrMatrix4x4f_CreateProjectionFov((XrMatrix4x4f*)viewMatrix->rightProjection,
-                                     GRAPHICS_OPENGL,
-                                     views[1].fov,
-                                     0.05f,
-                                     100.0f);
-    poseToMatrix((XrMatrix4x4f*)viewMatrix->rightView, views[1].pose);
-  }
-
-  g_projectionViews[0].type = XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW;
-  g_projectionViews[0].pose = views[0].pose;
-  g_projectionViews[0].fov = views[0].fov;
-
-  g_projectionViews[1].type = XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW;
-  g_projectionViews[1].pose = views[1].pose;
-  g_projectionViews[1].fov = views[1].fov;
-
-  g_projection = {
+    for (uint32_t i = 0; i < ctx.viewCount; ++i) {
+      XrMatrix4x4f_CreateProjectionFov(
+        (XrMatrix4x4f*)viewMatrix->views[i].projection,
+        GRAPHICS_OPENGL,
+        views[i].fov,
+        NEAR_Z,
+        FAR_Z);
+      poseToMatrix((XrMatrix4x4f*)viewMatrix->views[i].view, views[i].pose);
+    }
+    ctx.viewMatrices = *viewMatrix;
+  }
+
+  for (uint32_t i = 0; i < ctx.viewCount; ++i) {
+    ctx.projectionViews[i].type = XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW;
+    ctx.projectionViews[i].pose = views[i].pose;
+    ctx.projectionViews[i].fov = views[i].fov;
+  }
+
+  ctx.projection = {
     .type = XR_TYPE_COMPOSITION_LAYER_PROJECTION,
     .next = nullptr,
     .layerFlags = 0,
-    .space = g_currentSpace,
-    .viewCount = 2,
-    .views = g_projectionViews,
+    .space = ctx.currentSpace,
+    .viewCount = ctx.viewCount,
+    .views = ctx.projectionViews,
   };
 
-  return shouldRender_ ? (XrCompositionLayerBaseHeader*)&g_projection : nullptr;
+  return ctx.shouldRender ? (XrCompositionLayerBaseHeader*)&ctx.projection
+                          : nullptr;
+}
+
+XRFW_API const XrCompositionLayerBaseHeader*
+xrfwBeginFrameWithState(const XrFrameState* frameState,
+                        XrTime* outtime,
+                        XrfwViewMatrices* viewMatrix)
+{
+  auto& ctx = _xrfwContext();
+  auto begin = xrfwNowNanoseconds();
+  auto layer =
+    _xrfwBeginFrameWithState(ctx, frameState, outtime, viewMatrix);
+  auto end = xrfwNowNanoseconds();
+  ctx.frameRecorder.BeginFrame(*frameState, begin, end);
+  _xrfwTrace("xrfwBeginFrameWithState", begin, end);
+  return layer;
+}
+
+XRFW_API const XrCompositionLayerBaseHeader*
+xrfwBeginFrame(XrTime* outtime, XrfwViewMatrices* viewMatrix)
+{
+  XRFW_TRACE_SCOPE("xrfwBeginFrame");
+  XrFrameState frameState;
+  if (!xrfwWaitFrame(&frameState)) {
+    return nullptr;
+  }
+  return xrfwBeginFrameWithState(&frameState, outtime, viewMatrix);
+}
+
+XRFW_API XrBool32
+xrfwSetLateLatch(XrBool32 enable, XrfwLateLatchFunc callback, void* user)
+{
+  auto& ctx = _xrfwContext();
+  if (enable && !callback) {
+    // the rendered image would not match the late latched poses
+    PLOG_WARNING << "xrfwSetLateLatch: a callback is required";
+    ctx.lateLatch = false;
+    ctx.lateLatchCallback = nullptr;
+    ctx.lateLatchUser = nullptr;
+    return false;
+  }
+  ctx.lateLatch = enable;
+  ctx.lateLatchCallback = callback;
+  ctx.lateLatchUser = user;
+  return true;
+}
+
+// locate views again and replace the poses rendered at xrfwBeginFrame.
+static void
+_xrfwLateLatch(XrfwContext& ctx)
+{
+  XrView views[XRFW_MAX_VIEW_COUNT]{
+    { XR_TYPE_VIEW },
+    { XR_TYPE_VIEW },
+    { XR_TYPE_VIEW },
+    { XR_TYPE_VIEW },
+  };
+  XrViewStateFlags viewStateFlags;
+  if (!_xrfwLocateViews(
+        ctx, ctx.frameState.predictedDisplayTime, views, &viewStateFlags) ||
+      !_xrfwViewsTracked(viewStateFlags)) {
+    // keep the poses from xrfwBeginFrame
+    return;
+  }
+  if (ctx.captureViewsPending) {
+    ctx.captureViewStateFlags = viewStateFlags;
+    std::copy_n(views, ctx.viewCount, ctx.captureViews);
+  }
+  for (uint32_t i = 0; i < ctx.viewCount; ++i) {
+    ctx.projectionViews[i].pose = views[i].pose;
+    poseToMatrix((XrMatrix4x4f*)ctx.viewMatrices.views[i].view, views[i].pose);
+  }
+  ctx.lateLatchCallback(ctx.viewMatrices, ctx.lateLatchUser);
 }
 
 XRFW_API XrBool32
 xrfwEndFrame(const XrCompositionLayerBaseHeader* const* layers,
              uint32_t layerCount)
 {
+  auto& ctx = _xrfwContext();
+  auto begin = xrfwNowNanoseconds();
+  if (ctx.lateLatch && ctx.lateLatchCallback && layerCount > 0 &&
+      layers[0] == (const XrCompositionLayerBaseHeader*)&ctx.projection) {
+    _xrfwLateLatch(ctx);
+  }
+  if (ctx.captureViewsPending) {
+    // one views record per frame, with the poses submitted
+    ctx.captureViewsPending = false;
+    _xrfwCaptureViews(ctx,
+                      ctx.frameState.predictedDisplayTime,
+                      ctx.captureViewStateFlags,
+                      ctx.captureViews);
+  }
   XrFrameEndInfo frameEndInfo = {
     .type = XR_TYPE_FRAME_END_INFO,
-    .displayTime = g_frameState.predictedDisplayTime,
+    .displayTime = ctx.frameState.predictedDisplayTime,
     .environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE,
     .layerCount = layerCount,
     .layers = layers,
   };
 
-  auto result = xrEndFrame(g_session, &frameEndInfo);
+  auto result = g_dispatchTable.xrEndFrame(ctx.session, &frameEndInfo);
+  auto end = xrfwNowNanoseconds();
+  ctx.frameRecorder.EndFrame(begin, end);
+  _xrfwTrace("xrfwEndFrame", begin, end);
   if (XR_FAILED(result)) {
-    PLOG_FATAL << "xrEndFrame: " << result;
+    XRFW_LOG_FATAL("xrEndFrame: ", result);
     return false;
   }
   return true;
 }
+
+XRFW_API uint32_t
+xrfwGetFrameRecords(XrfwFrameRecord* records, uint32_t capacity)
+{
+  auto& ctx = _xrfwContext();
+  auto size = ctx.frameRecorder.Size();
+  auto count = std::min(size, capacity);
+  for (uint32_t i = 0; i < count; ++i) {
+    records[i] = ctx.frameRecorder.Get(size - count + i);
+  }
+  return count;
+}
+
+XRFW_API XrBool32
+xrfwGetFrameStats(XrfwFrameStats* stats)
+{
+  return _xrfwContext().frameRecorder.Stats(stats);
+}
+
+XRFW_API void
+xrfwSetTraceEnabled(XrBool32 enable)
+{
+  g_traceEnabled.store(enable, std::memory_order_relaxed);
+}
+
+XRFW_API void
+xrfwSetTraceThreadName(const char* name)
+{
+  _xrfwTraceBuffer()->m_name.store(name, std::memory_order_relaxed);
+}
+
+XRFW_API int64_t
+xrfwTraceBegin()
+{
+  return g_traceEnabled.load(std::memory_order_relaxed) ? xrfwNowNanoseconds()
+                                                        : 0;
+}
+
+XRFW_API void
+xrfwTraceEnd(const char* name, int64_t begin)
+{
+  if (begin) {
+    _xrfwTraceBuffer()->Push(name, begin, xrfwNowNanoseconds());
+  }
+}
+
+XRFW_API XrBool32
+xrfwWriteTrace(const char* path)
+{
+  auto fp = fopen(path, "w");
+  if (!fp) {
+    PLOG_ERROR << "fopen: " << path;
+    return false;
+  }
+
+  // Trace Event Format. complete events and thread_name metadata
+  fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  const char* separator = "";
+  std::vector<XrfwThreadTraceBuffer::Event> events;
+  std::lock_guard<std::mutex> lock(g_traceMutex);
+  for (auto& buffer : g_traceBuffers) {
+    if (auto name = buffer->m_name.load(std::memory_order_relaxed)) {
+      fprintf(fp,
+              "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+              "\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+              separator,
+              buffer->m_tid,
+              name);
+      separator = ",\n";
+    }
+    events.clear();
+    buffer->Snapshot(&events);
+    for (auto& event : events) {
+      // microseconds
+      fprintf(fp,
+              "%s{\"name\":\"%s\",\"cat\":\"xrfw\",\"ph\":\"X\","
+              "\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+              separator,
+              event.name,
+              buffer->m_tid,
+              event.begin / 1000.0,
+              (event.end - event.begin) / 1000.0);
+      separator = ",\n";
+    }
+  }
+  fprintf(fp, "\n]}\n");
+  auto success = ferror(fp) == 0;
+  fclose(fp);
+  return success;
+}
+
+XRFW_API XrBool32
+xrfwStartCapture(const char* path)
+{
+  auto& ctx = _xrfwContext();
+  ctx.capture.Close();
+  if (!ctx.capture.Open(path)) {
+    PLOG_ERROR << "xrfwStartCapture: " << path;
+    return false;
+  }
+  // replay starts from the current state
+  if (ctx.sessionState != XR_SESSION_STATE_UNKNOWN) {
+    ctx.capture.Append(XRFW_CAPTURE_SESSION_STATE,
+                       XrfwCaptureSessionState{
+                         .state = ctx.sessionState,
+                       });
+  }
+  return true;
+}
+
+XRFW_API void
+xrfwStopCapture()
+{
+  _xrfwContext().capture.Close();
+}
+
+XRFW_API void
+xrfwCaptureHandJoints(XrHandEXT hand,
+                      XrTime time,
+                      const XrHandJointLocationsEXT* locations)
+{
+  auto& ctx = _xrfwContext();
+  if (!ctx.capture.IsOpen()) {
+    return;
+  }
+  XrfwCaptureHandJoints joints{
+    .time = time,
+    .hand = hand,
+    .isActive = locations->isActive,
+    .jointCount = locations->isActive ? locations->jointCount : 0,
+  };
+  ctx.capture.AppendAt(time,
+                       XRFW_CAPTURE_HAND_JOINTS,
+                       &joints,
+                       sizeof(joints),
+                       locations->jointLocations,
+                       sizeof(XrHandJointLocationEXT) * joints.jointCount);
+}
+
+XRFW_API void
+xrfwCaptureBodyJoints(XrTime time, const XrBodyJointLocationsFB* locations)
+{
+  auto& ctx = _xrfwContext();
+  if (!ctx.capture.IsOpen()) {
+    return;
+  }
+  XrfwCaptureBodyJoints joints{
+    .time = time,
+    .isActive = locations->isActive,
+    .confidence = locations->confidence,
+    .skeletonChangedCount = locations->skeletonChangedCount,
+    .jointCount = locations->isActive ? locations->jointCount : 0,
+  };
+  ctx.capture.AppendAt(time,
+                       XRFW_CAPTURE_BODY_JOINTS,
+                       &joints,
+                       sizeof(joints),
+                       locations->jointLocations,
+                       sizeof(XrBodyJointLocationFB) * joints.jointCount);
+}
@@ -110,6 +110,22 @@ selectColorSwapchainFormatOpenGLES(std::span<int64_t> swapchainFormats) {
   return *swapchainFormatIt;
 }
 
+static int64_t
+selectDepthSwapchainFormatOpenGLES(std::span<int64_t> swapchainFormats) {
+  // depth only. XrfwSwapchainFbo attaches it to GL_DEPTH_ATTACHMENT
+  constexpr int64_t SupportedDepthSwapchainFormats[] = {
+      GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT16};
+
+  auto swapchainFormatIt =
+      std::find_first_of(swapchainFormats.begin(), swapchainFormats.end(),
+                         std::begin(SupportedDepthSwapchainFormats),
+                         std::end(SupportedDepthSwapchainFormats));
+  if (swapchainFormatIt == swapchainFormats.end()) {
+    return 0;
+  }
+  return *swapchainFormatIt;
+}
+
 XRFW_API void xrfwInitExtensionsAndroidOpenGLES(
     XrGraphicsRequirementsOpenGLESKHR *graphicsRequirements,
     android_app *state) {
@@ -126,6 +142,8 @@ XRFW_API void xrfwInitExtensionsAndroidOpenGLES(
   g_init.graphicsRequirementsCallback = &graphicsRequirementsOpenGLES;
   g_init.selectColorSwapchainFormatCallback =
       &selectColorSwapchainFormatOpenGLES;
+  g_init.selectDepthSwapchainFormatCallback =
+      &selectDepthSwapchainFormatOpenGLES;
   g_init.allocateSwapchainImageStructsCallback =
       &SwapchainImageListOpenGLES::allocateSwapchainImageStructs;
 }
@@ -0,0 +1,195 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <openxr/openxr.h>
+#include <stdint.h>
+#include <string.h>
+#include <xrfw_capture.h>
+
+// Appends capture records to a mapped file (include/xrfw_capture.h).
+//
+// A record is a memcpy into the mapping. The mapping doubles when it is full,
+// the only system calls on the frame loop. Close writes the frame index and
+// the header and cuts the file to its size.
+//
+// xrfwSessionPipelined appends from two threads: the frame pacer the frame
+// states and views of frame N+1, the render thread the late latched views and
+// the joints of frame N. Append is serialized by a mutex, as Reserve may remap
+// the file, and AppendAt puts a record in the frame displayed at its time.
+struct XrfwCaptureWriter
+{
+  static const uint64_t INITIAL_SIZE = 16 * 1024 * 1024;
+  // frames in flight that AppendAt finds by display time
+  static const size_t RECENT_FRAME_COUNT = 4;
+
+  std::mutex m_mutex;
+  // IsOpen without the lock
+  std::atomic<bool> m_open = false;
+  XrfwMappedFile m_file;
+  // end of the records
+  uint64_t m_offset = 0;
+  uint64_t m_frameCount = 0;
+  // predictedDisplayTime of frame i at i % RECENT_FRAME_COUNT
+  std::array<XrTime, RECENT_FRAME_COUNT> m_frameTimes = {};
+
+  ~XrfwCaptureWriter() { Close(); }
+
+  bool IsOpen() const { return m_open.load(std::memory_order_relaxed); }
+
+  bool Open(const char* path)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.OpenWrite(path, INITIAL_SIZE)) {
+      return false;
+    }
+    m_offset = sizeof(XrfwCaptureFileHeader);
+    m_frameCount = 0;
+    m_frameTimes = {};
+    m_open = true;
+    return true;
+  }
+
+  // a record of the latest frame. payload0 and payload1 are written back to
+  // back
+  bool Append(XrfwCaptureRecordType type,
+              const void* payload0,
+              uint32_t size0,
+              const void* payload1 = nullptr,
+              uint32_t size1 = 0)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return AppendLocked(m_frameCount ? m_frameCount - 1 : 0,
+                        type,
+                        payload0,
+                        size0,
+                        payload1,
+                        size1);
+  }
+
+  template<typename T>
+  bool Append(XrfwCaptureRecordType type, const T& payload)
+  {
+    return Append(type, &payload, sizeof(T));
+  }
+
+  // a record of the frame whose predictedDisplayTime is time, the latest
+  // frame if it is none of the recent ones
+  bool AppendAt(XrTime time,
+                XrfwCaptureRecordType type,
+                const void* payload0,
+                uint32_t size0,
+                const void* payload1 = nullptr,
+                uint32_t size1 = 0)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto frame = m_frameCount ? m_frameCount - 1 : 0;
+    auto recent = std::min<uint64_t>(m_frameCount, RECENT_FRAME_COUNT);
+    for (uint64_t i = 1; i <= recent; ++i) {
+      if (m_frameTimes[(m_frameCount - i) % RECENT_FRAME_COUNT] == time) {
+        frame = m_frameCount - i;
+        break;
+      }
+    }
+    return AppendLocked(frame, type, payload0, size0, payload1, size1);
+  }
+
+  void Close()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    CloseLocked();
+  }
+
+private:
+  bool AppendLocked(uint64_t frame,
+                    XrfwCaptureRecordType type,
+                    const void* payload0,
+                    uint32_t size0,
+                    const void* payload1,
+                    uint32_t size1)
+  {
+    if (!m_file.IsOpen()) {
+      return false;
+    }
+    auto size = size0 + size1;
+    auto recordSize = sizeof(XrfwCaptureRecordHeader) + xrfwCaptureAlign(size);
+    if (!Reserve(m_offset + recordSize)) {
+      return false;
+    }
+    if (type == XRFW_CAPTURE_FRAME_STATE) {
+      // opens its own frame
+      frame = m_frameCount++;
+      XrfwCaptureFrameState frameState;
+      memcpy(&frameState,
+             payload0,
+             std::min<size_t>(size0, sizeof(frameState)));
+      m_frameTimes[frame % RECENT_FRAME_COUNT] =
+        frameState.predictedDisplayTime;
+    }
+    auto dst = m_file.m_data + m_offset;
+    XrfwCaptureRecordHeader header{
+      .type = type,
+      .size = size,
+      .frame = frame,
+    };
+    memcpy(dst, &header, sizeof(header));
+    dst += sizeof(header);
+    memcpy(dst, payload0, size0);
+    if (size1) {
+      memcpy(dst + size0, payload1, size1);
+    }
+    memset(dst + size, 0, xrfwCaptureAlign(size) - size);
+    m_offset += recordSize;
+    return true;
+  }
+
+  void CloseLocked()
+  {
+    if (!m_file.IsOpen()) {
+      return;
+    }
+    m_open = false;
+    // the index of the FrameState records
+    auto indexOffset = m_offset;
+    auto end = indexOffset + m_frameCount * sizeof(uint64_t);
+    if (!Reserve(end)) {
+      // closed by Reserve
+      return;
+    }
+    auto index = reinterpret_cast<uint64_t*>(m_file.m_data + indexOffset);
+    for (auto offset = uint64_t(sizeof(XrfwCaptureFileHeader));
+         offset < indexOffset;) {
+      auto record = reinterpret_cast<const XrfwCaptureRecordHeader*>(
+        m_file.m_data + offset);
+      if (record->type == XRFW_CAPTURE_FRAME_STATE) {
+        *index++ = offset;
+      }
+      offset +=
+        sizeof(XrfwCaptureRecordHeader) + xrfwCaptureAlign(record->size);
+    }
+    XrfwCaptureFileHeader header{
+      .version = XRFW_CAPTURE_VERSION,
+      .frameCount = m_frameCount,
+      .indexOffset = indexOffset,
+    };
+    memcpy(header.magic, XRFW_CAPTURE_MAGIC, sizeof(header.magic));
+    memcpy(m_file.m_data, &header, sizeof(header));
+    m_file.Close(end);
+  }
+
+  bool Reserve(uint64_t size)
+  {
+    if (size <= m_file.m_size) {
+      return true;
+    }
+    auto newSize = std::max(size, m_file.m_size * 2);
+    if (!m_file.Map(newSize)) {
+      // the records so far stay in the file, without header and index
+      m_open = false;
+      m_file.Close(m_offset);
+      return false;
+    }
+    return true;
+  }
+};
@@ -0,0 +1,149 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <openxr/openxr.h>
+#include <stdint.h>
+#include <xrfw.h>
+
+inline int64_t
+xrfwNowNanoseconds()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+
+// Fixed size ring buffer of XrfwFrameRecord. Never allocates.
+//
+// xrWaitFrame of the next frame may run before xrEndFrame of the current one
+// (xrfwSessionPipelined), so the wait timestamps are kept aside until
+// xrfwBeginFrameWithState opens the record.
+template<size_t N>
+struct XrfwFrameRecorder
+{
+  std::array<XrfwFrameRecord, N> m_records = {};
+  uint64_t m_count = 0;
+  XrfwFrameRecord m_current = {};
+  int64_t m_waitFrameBegin = 0;
+  int64_t m_waitFrameEnd = 0;
+
+  void WaitFrame(int64_t begin, int64_t end)
+  {
+    m_waitFrameBegin = begin;
+    m_waitFrameEnd = end;
+  }
+
+  void BeginFrame(const XrFrameState& frameState, int64_t begin, int64_t end)
+  {
+    m_current = {
+      .waitFrameBegin = m_waitFrameBegin,
+      .waitFrameEnd = m_waitFrameEnd,
+      .beginFrameBegin = begin,
+      .beginFrameEnd = end,
+      .predictedDisplayTime = frameState.predictedDisplayTime,
+      .predictedDisplayPeriod = frameState.predictedDisplayPeriod,
+      .shouldRender = frameState.shouldRender,
+    };
+  }
+
+  void Acquire(int64_t begin, int64_t end)
+  {
+    if (!m_current.acquireBegin) {
+      m_current.acquireBegin = begin;
+    }
+    m_current.acquireEnd = end;
+  }
+
+  void Release(int64_t begin, int64_t end)
+  {
+    if (!m_current.releaseBegin) {
+      m_current.releaseBegin = begin;
+    }
+    m_current.releaseEnd = end;
+  }
+
+  void EndFrame(int64_t begin, int64_t end)
+  {
+    m_current.endFrameBegin = begin;
+    m_current.endFrameEnd = end;
+    m_records[m_count % N] = m_current;
+    ++m_count;
+    m_current = {};
+  }
+
+  uint32_t Size() const
+  {
+    return static_cast<uint32_t>(std::min<uint64_t>(m_count, N));
+  }
+
+  // i = 0 is the oldest
+  const XrfwFrameRecord& Get(uint32_t i) const
+  {
+    return m_records[(m_count - Size() + i) % N];
+  }
+
+  template<typename F>
+  XrfwPhaseStats Percentiles(F duration) const
+  {
+    std::array<int64_t, N> values;
+    auto size = Size();
+    for (uint32_t i = 0; i < size; ++i) {
+      values[i] = duration(Get(i));
+    }
+    auto percentile = [&](uint32_t p) {
+      auto nth = values.begin() + (size - 1) * p / 100;
+      std::nth_element(values.begin(), nth, values.begin() + size);
+      return *nth;
+    };
+    return {
+      .p50 = percentile(50),
+      .p95 = percentile(95),
+      .p99 = percentile(99),
+    };
+  }
+
+  bool Stats(XrfwFrameStats* stats) const
+  {
+    auto size = Size();
+    if (size == 0) {
+      return false;
+    }
+    *stats = {
+      .frameCount = size,
+    };
+
+    // the runtime skipped a display period
+    for (uint32_t i = 1; i < size; ++i) {
+      auto& prev = Get(i - 1);
+      auto& record = Get(i);
+      if ((record.predictedDisplayTime - prev.predictedDisplayTime) * 2 >
+          record.predictedDisplayPeriod * 3) {
+        ++stats->missedDeadlineCount;
+      }
+    }
+
+    stats->waitFrame = Percentiles([](const XrfwFrameRecord& r) {
+      return r.waitFrameEnd - r.waitFrameBegin;
+    });
+    stats->beginFrame = Percentiles([](const XrfwFrameRecord& r) {
+      return r.beginFrameEnd - r.beginFrameBegin;
+    });
+    stats->acquire = Percentiles([](const XrfwFrameRecord& r) {
+      return r.acquireEnd - r.acquireBegin;
+    });
+    stats->render = Percentiles([](const XrfwFrameRecord& r) {
+      return r.acquireEnd ? r.releaseBegin - r.acquireEnd : 0;
+    });
+    stats->release = Percentiles([](const XrfwFrameRecord& r) {
+      return r.releaseEnd - r.releaseBegin;
+    });
+    stats->endFrame = Percentiles([](const XrfwFrameRecord& r) {
+      return r.endFrameEnd - r.endFrameBegin;
+    });
+    stats->total = Percentiles([](const XrfwFrameRecord& r) {
+      return r.endFrameEnd - r.waitFrameBegin;
+    });
+    return true;
+  }
+};
@@ -10,6 +10,9 @@ using XrfwGraphicsRequirementsFunc = bool (*)(XrInstance instance,
 // session);
 using XrfwSelectColorSwapchainFormatFunc =
     int64_t (*)(std::span<int64_t> swapchainFormats);
+// 0 if no depth format is supported
+using XrfwSelectDepthSwapchainFormatFunc =
+    int64_t (*)(std::span<int64_t> swapchainFormats);
 using XrfwAllocateSwapchainImageStructsFunc =
     std::vector<XrSwapchainImageBaseHeader *> (*)(
         uint32_t capacity, const XrSwapchainCreateInfo &);
@@ -19,6 +22,9 @@ struct XrfwInitialization {
   // XrfwGetSwapchainFormatsFunc getSwapchainFormatsCallback = nullptr;
   XrfwSelectColorSwapchainFormatFunc selectColorSwapchainFormatCallback =
       nullptr;
+  // optional. depth swapchains for XR_KHR_composition_layer_depth
+  XrfwSelectDepthSwapchainFormatFunc selectDepthSwapchainFormatCallback =
+      nullptr;
   XrfwAllocateSwapchainImageStructsFunc allocateSwapchainImageStructsCallback =
       nullptr;
   std::vector<const char *> extensionNames;
@@ -0,0 +1,143 @@
+#ifdef XR_USE_PLATFORM_EGL
+#include "xrfw.h"
+#include "xrfw_initialization.h"
+#include "xrfw_plog_formatter.h"
+#include "xrfw_swapchain_imagelist.h"
+
+#include <EGL/egl.h>
+#include <GLES3/gl32.h>
+#include <openxr/openxr_platform.h>
+
+#include <plog/Appenders/ColorConsoleAppender.h>
+#include <plog/Init.h>
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <list>
+#include <span>
+#include <vector>
+
+XRFW_API void xrfwInitLogger() {
+  static plog::ColorConsoleAppender<plog::MyFormatter> consoleAppender;
+  plog::init(plog::debug, &consoleAppender);
+}
+
+extern XrfwInitialization g_init;
+
+#ifdef XR_USE_GRAPHICS_API_OPENGL_ES
+using SwapchainImageListOpenGLES =
+    SwapchainImageList<XrSwapchainImageOpenGLESKHR,
+                       XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_ES_KHR>;
+template <>
+std::list<std::vector<XrSwapchainImageOpenGLESKHR>>
+    SwapchainImageListOpenGLES::s_swapchainImageBuffers = {};
+
+// XR_MNDX_egl_enable binds the context. The runtime still expects the
+// OpenGL ES graphics requirements to be queried.
+static const char *egl_extensions[2] = {
+    XR_MNDX_EGL_ENABLE_EXTENSION_NAME,
+    XR_KHR_OPENGL_ES_ENABLE_EXTENSION_NAME,
+};
+
+static bool graphicsRequirementsLinuxEGL(XrInstance instance,
+                                         XrSystemId systemId,
+                                         void *outGraphicsRequirements) {
+
+  PFN_xrGetOpenGLESGraphicsRequirementsKHR
+      pfnGetOpenGLESGraphicsRequirementsKHR = nullptr;
+  auto result =
+      xrGetInstanceProcAddr(instance, "xrGetOpenGLESGraphicsRequirementsKHR",
+                            reinterpret_cast<PFN_xrVoidFunction *>(
+                                &pfnGetOpenGLESGraphicsRequirementsKHR));
+  if (XR_FAILED(result)) {
+    PLOG_FATAL << "xrGetInstanceProcAddr: xrGetOpenGLESGraphicsRequirementsKHR";
+    return false;
+  }
+
+  auto graphicsRequirements =
+      (XrGraphicsRequirementsOpenGLESKHR *)outGraphicsRequirements;
+  graphicsRequirements->type = XR_TYPE_GRAPHICS_REQUIREMENTS_OPENGL_ES_KHR;
+  result = pfnGetOpenGLESGraphicsRequirementsKHR(instance, systemId,
+                                                 graphicsRequirements);
+  if (XR_FAILED(result)) {
+    PLOG_FATAL << "xrGetOpenGLESGraphicsRequirementsKHR";
+    return false;
+  }
+
+  return true;
+}
+
+static int64_t
+selectColorSwapchainFormatLinuxEGL(std::span<int64_t> swapchainFormats) {
+
+  // List of supported color swapchain formats.
+  constexpr int64_t SupportedColorSwapchainFormats[] = {
+      GL_RGBA8, GL_SRGB8_ALPHA8, GL_RGBA8_SNORM};
+
+  auto swapchainFormatIt =
+      std::find_first_of(swapchainFormats.begin(), swapchainFormats.end(),
+                         std::begin(SupportedColorSwapchainFormats),
+                         std::end(SupportedColorSwapchainFormats));
+  if (swapchainFormatIt == swapchainFormats.end()) {
+    throw std::runtime_error(
+        "No runtime swapchain format supported for color swapchain");
+  }
+  return *swapchainFormatIt;
+}
+
+static int64_t
+selectDepthSwapchainFormatLinuxEGL(std::span<int64_t> swapchainFormats) {
+  // depth only. XrfwSwapchainFbo attaches it to GL_DEPTH_ATTACHMENT
+  constexpr int64_t SupportedDepthSwapchainFormats[] = {
+      GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT16};
+
+  auto swapchainFormatIt =
+      std::find_first_of(swapchainFormats.begin(), swapchainFormats.end(),
+                         std::begin(SupportedDepthSwapchainFormats),
+                         std::end(SupportedDepthSwapchainFormats));
+  if (swapchainFormatIt == swapchainFormats.end()) {
+    return 0;
+  }
+  return *swapchainFormatIt;
+}
+
+XRFW_API void xrfwInitExtensionsLinuxEGL(
+    XrGraphicsRequirementsOpenGLESKHR *graphicsRequirements) {
+  g_init.extensionNames.assign(egl_extensions,
+                               egl_extensions + std::size(egl_extensions));
+  g_init.graphicsRequirements = graphicsRequirements;
+  g_init.graphicsRequirementsCallback = &graphicsRequirementsLinuxEGL;
+  g_init.selectColorSwapchainFormatCallback =
+      &selectColorSwapchainFormatLinuxEGL;
+  g_init.selectDepthSwapchainFormatCallback =
+      &selectDepthSwapchainFormatLinuxEGL;
+  g_init.allocateSwapchainImageStructsCallback =
+      &SwapchainImageListOpenGLES::allocateSwapchainImageStructs;
+}
+
+XRFW_API XrSession xrfwCreateSessionLinuxEGL(XrfwSwapchains *swapchains,
+                                             EGLDisplay display,
+                                             EGLConfig config,
+                                             EGLContext context) {
+  XrGraphicsBindingEGLMNDX graphicsBinding = {
+      .type = XR_TYPE_GRAPHICS_BINDING_EGL_MNDX,
+      .next = nullptr,
+      .getProcAddress = (PFN_xrEglGetProcAddressMNDX)&eglGetProcAddress,
+      .display = display,
+      .config = config,
+      .context = context,
+  };
+  return xrfwCreateSession(swapchains, &graphicsBinding, false);
+}
+
+XRFW_API uint32_t
+xrfwCastTextureLinuxEGL(const XrSwapchainImageBaseHeader *swapchainImage) {
+  if (!swapchainImage) {
+    return {};
+  }
+  return reinterpret_cast<const XrSwapchainImageOpenGLESKHR *>(swapchainImage)
+      ->image;
+}
+
+#endif
+#endif
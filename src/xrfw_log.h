@@ -0,0 +1,297 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <openxr/openxr.h>
+#include <plog/Log.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+#include <type_traits>
+#include <xrfw.h>
+
+// Logging for the frame loop.
+//
+// PLOG_* formats a std::ostringstream and runs the appender (localtime, the
+// console or logcat) on the calling thread, so a burst of runtime errors
+// stalls the render thread that reports them. XRFW_LOG_* instead copies its
+// arguments into a fixed size record and pushes it to a lock-free ring. A
+// background thread pops the records and writes them to plog. A full ring
+// drops the record and counts it, it never blocks.
+//
+// The arguments are concatenated like a << chain. Strings are stored as
+// pointers and must be literals or otherwise outlive the record.
+//
+//   XRFW_LOG_FATAL("xrEndFrame: ", result);
+//
+// XRFW_LOG_LEVEL strips the levels above it at compile time, for example
+// -DXRFW_LOG_LEVEL=plog::warning (meson -Dlog_level=warning).
+#ifndef XRFW_LOG_LEVEL
+#define XRFW_LOG_LEVEL plog::verbose
+#endif
+
+static const size_t XRFW_LOG_MAX_ARGS = 6;
+// records. power of two
+static const size_t XRFW_LOG_RING_SIZE = 256;
+
+struct XrfwLogArg
+{
+  enum Kind : uint8_t
+  {
+    Int,
+    UInt,
+    Float,
+    String,
+    Result,
+    SessionState,
+    StructureType,
+  };
+  Kind kind;
+  union
+  {
+    int64_t i;
+    uint64_t u;
+    double f;
+    const char* s;
+  };
+};
+
+struct XrfwLogRecord
+{
+  plog::Severity severity;
+  uint32_t line;
+  const char* func;
+  const char* file;
+  uint32_t argCount;
+  XrfwLogArg args[XRFW_LOG_MAX_ARGS];
+
+  template<typename T>
+  void Add(T value)
+  {
+    auto& arg = args[argCount++];
+    if constexpr (std::is_same_v<T, XrResult>) {
+      arg.kind = XrfwLogArg::Result;
+      arg.i = value;
+    } else if constexpr (std::is_same_v<T, XrSessionState>) {
+      arg.kind = XrfwLogArg::SessionState;
+      arg.i = value;
+    } else if constexpr (std::is_same_v<T, XrStructureType>) {
+      arg.kind = XrfwLogArg::StructureType;
+      arg.i = value;
+    } else if constexpr (std::is_convertible_v<T, const char*>) {
+      arg.kind = XrfwLogArg::String;
+      arg.s = value;
+    } else if constexpr (std::is_floating_point_v<T>) {
+      arg.kind = XrfwLogArg::Float;
+      arg.f = value;
+    } else if constexpr (std::is_signed_v<T> || std::is_enum_v<T>) {
+      arg.kind = XrfwLogArg::Int;
+      arg.i = static_cast<int64_t>(value);
+    } else {
+      static_assert(std::is_unsigned_v<T>, "unsupported log argument");
+      arg.kind = XrfwLogArg::UInt;
+      arg.u = static_cast<uint64_t>(value);
+    }
+  }
+};
+
+// Bounded multi producer queue (D. Vyukov). Each cell carries a sequence
+// number, so producers on several XrfwContext threads claim cells with one
+// compare_exchange and never wait for each other.
+template<typename T, size_t N>
+struct XrfwLogRing
+{
+  static_assert((N & (N - 1)) == 0, "N must be a power of two");
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+  std::array<Cell, N> m_cells;
+  alignas(64) std::atomic<size_t> m_enqueue = 0;
+  alignas(64) std::atomic<size_t> m_dequeue = 0;
+
+  XrfwLogRing()
+  {
+    for (size_t i = 0; i < N; ++i) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool TryPush(const T& value)
+  {
+    auto pos = m_enqueue.load(std::memory_order_relaxed);
+    for (;;) {
+      auto& cell = m_cells[pos & (N - 1)];
+      auto sequence = cell.sequence.load(std::memory_order_acquire);
+      auto diff =
+        static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (m_enqueue.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+          cell.data = value;
+          cell.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // full
+        return false;
+      } else {
+        pos = m_enqueue.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // single consumer
+  bool TryPop(T* value)
+  {
+    auto pos = m_dequeue.load(std::memory_order_relaxed);
+    auto& cell = m_cells[pos & (N - 1)];
+    auto sequence = cell.sequence.load(std::memory_order_acquire);
+    if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) <
+        0) {
+      // empty
+      return false;
+    }
+    *value = cell.data;
+    cell.sequence.store(pos + N, std::memory_order_release);
+    m_dequeue.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+};
+
+// push a record. defined in xrfw.cpp
+void
+xrfwLogPush(const XrfwLogRecord& record);
+
+template<typename... ARGS>
+inline void
+xrfwLogWrite(plog::Severity severity,
+             const char* func,
+             const char* file,
+             uint32_t line,
+             ARGS... args)
+{
+  static_assert(sizeof...(ARGS) <= XRFW_LOG_MAX_ARGS,
+                "too many log arguments");
+  auto logger = plog::get();
+  if (!logger || !logger->checkSeverity(severity)) {
+    return;
+  }
+  XrfwLogRecord record{
+    .severity = severity,
+    .line = line,
+    .func = func,
+    .file = file,
+  };
+  (record.Add(args), ...);
+  xrfwLogPush(record);
+}
+
+// Pops the records on its own thread and writes them to plog.
+struct XrfwLogThread
+{
+  XrfwLogRing<XrfwLogRecord, XRFW_LOG_RING_SIZE> m_ring;
+  // bumped by every push. the thread waits on it while the ring is empty
+  std::atomic<uint32_t> m_wake = 0;
+  std::atomic<uint64_t> m_dropped = 0;
+  std::atomic<bool> m_running = false;
+  std::thread m_thread;
+
+  ~XrfwLogThread() { Stop(); }
+
+  void Push(const XrfwLogRecord& record)
+  {
+    if (!m_ring.TryPush(record)) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_one();
+  }
+
+  void Start()
+  {
+    if (m_running.exchange(true)) {
+      return;
+    }
+    m_thread = std::thread([this]() { Run(); });
+  }
+
+  // writes the queued records and joins
+  void Stop()
+  {
+    if (!m_running.exchange(false)) {
+      return;
+    }
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_one();
+    m_thread.join();
+  }
+
+private:
+  void Run()
+  {
+    uint64_t dropped = 0;
+    for (;;) {
+      auto wake = m_wake.load(std::memory_order_acquire);
+      XrfwLogRecord record;
+      while (m_ring.TryPop(&record)) {
+        Write(record);
+      }
+      auto droppedNow = m_dropped.load(std::memory_order_relaxed);
+      if (droppedNow != dropped) {
+        PLOG_WARNING << (droppedNow - dropped) << " log records dropped";
+        dropped = droppedNow;
+      }
+      if (!m_running.load(std::memory_order_acquire)) {
+        break;
+      }
+      m_wake.wait(wake, std::memory_order_acquire);
+    }
+  }
+
+  static void Write(const XrfwLogRecord& record)
+  {
+    plog::Record r(
+      record.severity, record.func, record.line, record.file, nullptr, 0);
+    for (uint32_t i = 0; i < record.argCount; ++i) {
+      auto& arg = record.args[i];
+      switch (arg.kind) {
+        case XrfwLogArg::Int:
+          r << arg.i;
+          break;
+        case XrfwLogArg::UInt:
+          r << arg.u;
+          break;
+        case XrfwLogArg::Float:
+          r << arg.f;
+          break;
+        case XrfwLogArg::String:
+          r << (arg.s ? arg.s : "(null)");
+          break;
+        case XrfwLogArg::Result:
+          r << static_cast<XrResult>(arg.i);
+          break;
+        case XrfwLogArg::SessionState:
+          r << static_cast<XrSessionState>(arg.i);
+          break;
+        case XrfwLogArg::StructureType:
+          r << static_cast<XrStructureType>(arg.i);
+          break;
+      }
+    }
+    *plog::get() += r;
+  }
+};
+
+#define XRFW_LOG(severity, ...)                                                \
+  do {                                                                         \
+    if constexpr (severity <= XRFW_LOG_LEVEL) {                                \
+      xrfwLogWrite(severity, __func__, __FILE__, __LINE__, __VA_ARGS__);       \
+    }                                                                          \
+  } while (0)
+#define XRFW_LOG_FATAL(...) XRFW_LOG(plog::fatal, __VA_ARGS__)
+#define XRFW_LOG_ERROR(...) XRFW_LOG(plog::error, __VA_ARGS__)
+#define XRFW_LOG_WARNING(...) XRFW_LOG(plog::warning, __VA_ARGS__)
+#define XRFW_LOG_INFO(...) XRFW_LOG(plog::info, __VA_ARGS__)
+#define XRFW_LOG_DEBUG(...) XRFW_LOG(plog::debug, __VA_ARGS__)
@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <openxr/openxr.h>
+#include <stdint.h>
+#include <xrfw.h>
+
+// Per frame memo of xrLocateSpace. Never allocates.
+//
+// The hand and body trackers and the app locate the same spaces at the same
+// predictedDisplayTime, and each runtime call is an IPC round trip. Entries
+// are keyed by (space, baseSpace, time) and dropped by Clear at
+// xrfwBeginFrameWithState, so a pose never outlives the frame it was located
+// for. Only plain XrSpaceLocation is cached, a next chain (XrSpaceVelocity) is
+// passed through to the runtime.
+template<size_t N>
+struct XrfwSpaceLocationCache
+{
+  struct Entry
+  {
+    XrSpace space;
+    XrSpace baseSpace;
+    XrTime time;
+    XrPosef pose;
+    XrSpaceLocationFlags locationFlags;
+  };
+  std::array<Entry, N> m_entries = {};
+  uint32_t m_size = 0;
+  XrfwSpaceLocationCacheStats m_stats = {};
+
+  void Clear() { m_size = 0; }
+
+  XrResult Locate(PFN_xrLocateSpace locateSpace,
+                  XrSpace space,
+                  XrSpace baseSpace,
+                  XrTime time,
+                  XrSpaceLocation* location)
+  {
+    if (location->next) {
+      ++m_stats.missCount;
+      return locateSpace(space, baseSpace, time, location);
+    }
+
+    for (uint32_t i = 0; i < m_size; ++i) {
+      auto& entry = m_entries[i];
+      if (entry.space == space && entry.baseSpace == baseSpace &&
+          entry.time == time) {
+        ++m_stats.hitCount;
+        location->pose = entry.pose;
+        location->locationFlags = entry.locationFlags;
+        return XR_SUCCESS;
+      }
+    }
+
+    ++m_stats.missCount;
+    auto result = locateSpace(space, baseSpace, time, location);
+    if (XR_SUCCEEDED(result) && m_size < N) {
+      m_entries[m_size++] = {
+        .space = space,
+        .baseSpace = baseSpace,
+        .time = time,
+        .pose = location->pose,
+        .locationFlags = location->locationFlags,
+      };
+    }
+    return result;
+  }
+};
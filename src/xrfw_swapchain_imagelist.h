@@ -1,10 +1,13 @@
 #pragma once
 #include <list>
+#include <mutex>
 #include <openxr/openxr.h>
 #include <vector>
 
 template <typename T, XrStructureType TYPE> struct SwapchainImageList {
   static std::list<std::vector<T>> s_swapchainImageBuffers;
+  // sessions of several XrfwContext create swapchains concurrently
+  static inline std::mutex s_mutex;
   static std::vector<XrSwapchainImageBaseHeader *>
   allocateSwapchainImageStructs(
       uint32_t size, const XrSwapchainCreateInfo & /*swapchainCreateInfo*/) {
@@ -20,6 +23,7 @@ template <typename T, XrStructureType TYPE> struct SwapchainImageList {
           reinterpret_cast<XrSwapchainImageBaseHeader *>(&image));
     }
     // Keep the buffer alive by moving it into the list of buffers.
+    std::lock_guard<std::mutex> lock(s_mutex);
     s_swapchainImageBuffers.push_back(std::move(swapchainImageBuffer));
     return swapchainImageBase;
   }
@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+// Frame trace. Scoped markers of one thread are kept as complete ("X") events
+// of Chrome's trace event format: name, begin and end in steady_clock
+// nanoseconds. Only the owning thread writes its buffer, so a marker is two
+// plain stores and a release store of the count, no lock and no allocation.
+// xrfwWriteTrace copies a snapshot from another thread without stopping the
+// writer. The oldest events are overwritten when the buffer is full.
+template<size_t N>
+struct XrfwTraceBuffer
+{
+  struct Event
+  {
+    // a literal, never copied
+    const char* name;
+    int64_t begin;
+    int64_t end;
+  };
+  std::array<Event, N> m_events = {};
+  std::atomic<uint64_t> m_count = 0;
+  // order of registration. the tid of the dump
+  uint32_t m_tid = 0;
+  // xrfwSetTraceThreadName. a literal
+  std::atomic<const char*> m_name = nullptr;
+
+  void Push(const char* name, int64_t begin, int64_t end)
+  {
+    auto count = m_count.load(std::memory_order_relaxed);
+    m_events[count % N] = { name, begin, end };
+    m_count.store(count + 1, std::memory_order_release);
+  }
+
+  // the latest events, oldest first. events overwritten while copying are
+  // dropped.
+  void Snapshot(std::vector<Event>* out) const
+  {
+    auto count = m_count.load(std::memory_order_acquire);
+    auto first = count > N ? count - N : 0;
+    auto offset = out->size();
+    for (auto i = first; i < count; ++i) {
+      out->push_back(m_events[i % N]);
+    }
+    auto after = m_count.load(std::memory_order_acquire);
+    if (after > N && after - N > first) {
+      // the writer lapped the oldest ones
+      auto lost = std::min<uint64_t>(after - N - first, count - first);
+      out->erase(out->begin() + offset, out->begin() + offset + lost);
+    }
+  }
+};
@@ -89,6 +89,25 @@ selectColorSwapchainFormatWin32OpenGL(std::span<int64_t> swapchainFormats) {
   return *swapchainFormatIt;
 }
 
+static int64_t
+selectDepthSwapchainFormatWin32OpenGL(std::span<int64_t> swapchainFormats) {
+  // depth only. XrfwSwapchainFbo attaches it to GL_DEPTH_ATTACHMENT
+  constexpr int64_t SupportedDepthSwapchainFormats[] = {
+      0x8CAC, // GL_DEPTH_COMPONENT32F,
+      0x81A6, // GL_DEPTH_COMPONENT24,
+      0x81A5, // GL_DEPTH_COMPONENT16,
+  };
+
+  auto swapchainFormatIt =
+      std::find_first_of(swapchainFormats.begin(), swapchainFormats.end(),
+                         std::begin(SupportedDepthSwapchainFormats),
+                         std::end(SupportedDepthSwapchainFormats));
+  if (swapchainFormatIt == swapchainFormats.end()) {
+    return 0;
+  }
+  return *swapchainFormatIt;
+}
+
 XRFW_API void xrfwInitExtensionsWin32OpenGL(
     XrGraphicsRequirementsOpenGLKHR *graphicsRequirements) {
   g_init.extensionNames.assign(opengl_extensions,
@@ -97,6 +116,8 @@ XRFW_API void xrfwInitExtensionsWin32OpenGL(
   g_init.graphicsRequirementsCallback = &graphicsRequirementsWin32OpenGL;
   g_init.selectColorSwapchainFormatCallback =
       &selectColorSwapchainFormatWin32OpenGL;
+  g_init.selectDepthSwapchainFormatCallback =
+      &selectDepthSwapchainFormatWin32OpenGL;
   g_init.allocateSwapchainImageStructsCallback =
       &SwapchainImageListOpenGL::allocateSwapchainImageStructs;
 }
@@ -0,0 +1,38 @@
+// The source code annotations of the Windows SDK <sal.h> that DirectXMath
+// uses, expanded to nothing. Only on the include path outside Windows.
+#pragma once
+
+#define _Use_decl_annotations_
+#define _Analysis_assume_(e)
+#define _Success_(e)
+#define _Check_return_
+#define _Must_inspect_result_
+#define _Ret_maybenull_
+#define _Ret_notnull_
+
+#define _In_
+#define _In_opt_
+#define _In_z_
+#define _In_range_(lb, ub)
+#define _In_reads_(n)
+#define _In_reads_opt_(n)
+#define _In_reads_bytes_(n)
+#define _In_reads_bytes_opt_(n)
+
+#define _Out_
+#define _Out_opt_
+#define _Out_writes_(n)
+#define _Out_writes_opt_(n)
+#define _Out_writes_all_(n)
+#define _Out_writes_bytes_(n)
+#define _Out_writes_bytes_opt_(n)
+#define _Out_writes_to_(n, c)
+#define _Out_writes_bytes_to_(n, c)
+#define _Outptr_
+#define _Outptr_opt_
+
+#define _Inout_
+#define _Inout_opt_
+#define _Inout_updates_(n)
+#define _Inout_updates_all_(n)
+#define _Inout_updates_bytes_(n)
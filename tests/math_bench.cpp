@@ -0,0 +1,661 @@
+// Throughput and accuracy of the math libraries used in this repo.
+//
+// The same operations on xr_linear.h, thirdparty/common/util_matrix.cpp, glm
+// and DirectXMath, over batches of 1 to 4096 elements. "ns" is the time per
+// element, the best of several runs. "error" is the largest
+// |x - ref| / max(1, |ref|) of an output element against a double precision
+// reference of the same inputs.
+//
+// All matrices are column major for column vectors. DirectXMath loads the same
+// memory as its row major matrix for row vectors, so its products are
+// reversed. transformBatch transforms the points by one matrix, with
+// XMVector3TransformCoordStream for DirectXMath. The DirectXMath column needs
+// MATH_BENCH_DIRECTXMATH, defined when its header compiles (tests/meson.build).
+//
+//   math_bench [--count N] [--output path]
+#include "../../src/xr_linear.h"
+#include "util_matrix.h"
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <openxr/openxr.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string_view>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifdef MATH_BENCH_DIRECTXMATH
+#include <DirectXMath.h>
+#endif
+
+static const size_t BATCH_SIZES[] = {1, 16, 256, 4096};
+static const size_t MAX_BATCH = 4096;
+static const int RUNS = 5;
+static const float NEAR_Z = 0.05f;
+static const float FAR_Z = 100.0f;
+
+using Matrix4d = std::array<double, 16>;
+using Vector3d = std::array<double, 3>;
+
+// keeps the compiler from dropping or merging the repeated batches
+static inline void Clobber() {
+#ifdef _MSC_VER
+  _ReadWriteBarrier();
+#else
+  asm volatile("" ::: "memory");
+#endif
+}
+
+//
+// double precision references
+//
+static Matrix4d ToDouble(const XrMatrix4x4f &m) {
+  Matrix4d result;
+  std::copy(m.m, m.m + 16, result.begin());
+  return result;
+}
+
+static Matrix4d MultiplyRef(const Matrix4d &a, const Matrix4d &b) {
+  Matrix4d result;
+  for (int c = 0; c < 4; ++c) {
+    for (int r = 0; r < 4; ++r) {
+      double sum = 0;
+      for (int k = 0; k < 4; ++k) {
+        sum += a[k * 4 + r] * b[c * 4 + k];
+      }
+      result[c * 4 + r] = sum;
+    }
+  }
+  return result;
+}
+
+// Gauss-Jordan with partial pivoting on [m | I]
+static Matrix4d InvertRef(const Matrix4d &m) {
+  double a[4][8];
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      a[r][c] = m[c * 4 + r];
+      a[r][4 + c] = r == c ? 1.0 : 0.0;
+    }
+  }
+  for (int c = 0; c < 4; ++c) {
+    int pivot = c;
+    for (int r = c + 1; r < 4; ++r) {
+      if (fabs(a[r][c]) > fabs(a[pivot][c])) {
+        pivot = r;
+      }
+    }
+    std::swap(a[c], a[pivot]);
+    auto inv = 1.0 / a[c][c];
+    for (int k = 0; k < 8; ++k) {
+      a[c][k] *= inv;
+    }
+    for (int r = 0; r < 4; ++r) {
+      if (r != c) {
+        auto f = a[r][c];
+        for (int k = 0; k < 8; ++k) {
+          a[r][k] -= f * a[c][k];
+        }
+      }
+    }
+  }
+  Matrix4d result;
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      result[c * 4 + r] = a[r][4 + c];
+    }
+  }
+  return result;
+}
+
+static Matrix4d QuaternionRef(const XrQuaternionf &q) {
+  double x = q.x, y = q.y, z = q.z, w = q.w;
+  return {
+      1 - 2 * (y * y + z * z), 2 * (x * y + w * z), 2 * (x * z - w * y), 0,
+      2 * (x * y - w * z), 1 - 2 * (x * x + z * z), 2 * (y * z + w * x), 0,
+      2 * (x * z + w * y), 2 * (y * z - w * x), 1 - 2 * (x * x + y * y), 0,
+      0, 0, 0, 1,
+  };
+}
+
+// depth -1 to 1 (OpenGL), or 0 to 1 (D3D)
+static Matrix4d ProjectionRef(const XrFovf &fov, bool zeroToOne) {
+  double l = tan(double(fov.angleLeft)), r = tan(double(fov.angleRight));
+  double d = tan(double(fov.angleDown)), u = tan(double(fov.angleUp));
+  double n = NEAR_Z, f = FAR_Z;
+  Matrix4d result{};
+  result[0] = 2 / (r - l);
+  result[5] = 2 / (u - d);
+  result[8] = (r + l) / (r - l);
+  result[9] = (u + d) / (u - d);
+  result[11] = -1;
+  if (zeroToOne) {
+    result[10] = -f / (f - n);
+    result[14] = -f * n / (f - n);
+  } else {
+    result[10] = -(f + n) / (f - n);
+    result[14] = -2 * f * n / (f - n);
+  }
+  return result;
+}
+
+static Vector3d TransformRef(const Matrix4d &m, const XrVector3f &v) {
+  double p[4];
+  for (int r = 0; r < 4; ++r) {
+    p[r] = m[r] * v.x + m[4 + r] * v.y + m[8 + r] * v.z + m[12 + r];
+  }
+  return {p[0] / p[3], p[1] / p[3], p[2] / p[3]};
+}
+
+static double ElementError(const float *x, const double *ref, size_t n) {
+  double error = 0;
+  for (size_t i = 0; i < n; ++i) {
+    error = std::max(error, fabs(x[i] - ref[i]) / std::max(1.0, fabs(ref[i])));
+  }
+  return error;
+}
+
+//
+// inputs
+//
+struct Inputs {
+  // well conditioned, not affine
+  std::vector<XrMatrix4x4f> a;
+  std::vector<XrMatrix4x4f> b;
+  // rotation and translation
+  std::vector<XrMatrix4x4f> rigid;
+  std::vector<XrQuaternionf> rotation;
+  // w, x, y, z for util_matrix
+  std::vector<std::array<float, 4>> rotationWxyz;
+  std::vector<XrFovf> fov;
+  std::vector<XrVector3f> point;
+
+  Inputs() {
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    auto general = [&]() {
+      XrMatrix4x4f m;
+      for (int i = 0; i < 16; ++i) {
+        m.m[i] = unit(rng) + (i % 5 == 0 ? 4.0f : 0.0f);
+      }
+      return m;
+    };
+    for (size_t i = 0; i < MAX_BATCH; ++i) {
+      a.push_back(general());
+      b.push_back(general());
+
+      XrQuaternionf q = {unit(rng), unit(rng), unit(rng), unit(rng)};
+      auto length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+      q = {q.x / length, q.y / length, q.z / length, q.w / length};
+      rotation.push_back(q);
+      rotationWxyz.push_back({q.w, q.x, q.y, q.z});
+
+      XrVector3f t = {unit(rng) * 2, unit(rng) * 2, unit(rng) * 2};
+      XrVector3f s = {1, 1, 1};
+      XrMatrix4x4f m;
+      XrMatrix4x4f_CreateTranslationRotationScale(&m, &t, &q, &s);
+      rigid.push_back(m);
+
+      fov.push_back({
+          .angleLeft = -0.7f + unit(rng) * 0.2f,
+          .angleRight = 0.7f + unit(rng) * 0.2f,
+          .angleUp = 0.7f + unit(rng) * 0.2f,
+          .angleDown = -0.7f + unit(rng) * 0.2f,
+      });
+      point.push_back({unit(rng) * 2, unit(rng) * 2, unit(rng) * 2});
+    }
+  }
+};
+
+//
+// measurement
+//
+struct Result {
+  const char *op;
+  const char *library;
+  size_t batch;
+  double ns;
+  double error;
+};
+
+struct Bench {
+  // elements per run
+  size_t count;
+  std::vector<Result> results;
+  std::vector<XrMatrix4x4f> matrices{MAX_BATCH};
+  std::vector<XrVector3f> points{MAX_BATCH};
+
+  // best ns per element of kernel(n, out) over RUNS runs
+  template <typename F, typename T>
+  double Measure(size_t batch, F &&kernel, T *out) {
+    auto repeat = std::max<size_t>(1, count / batch);
+    double best = INFINITY;
+    for (int run = 0; run < RUNS; ++run) {
+      auto begin = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < repeat; ++i) {
+        kernel(batch, out);
+        Clobber();
+      }
+      std::chrono::duration<double, std::nano> elapsed =
+          std::chrono::steady_clock::now() - begin;
+      best = std::min(best, elapsed.count() / double(repeat * batch));
+    }
+    return best;
+  }
+
+  // kernel(n, XrMatrix4x4f *out) writes out[0, n)
+  template <typename F>
+  void Matrices(const char *op, const char *library,
+                const std::vector<Matrix4d> &reference, F &&kernel) {
+    for (auto batch : BATCH_SIZES) {
+      std::fill(matrices.begin(), matrices.end(), XrMatrix4x4f{});
+      auto ns = Measure(batch, kernel, matrices.data());
+      double error = 0;
+      for (size_t i = 0; i < batch; ++i) {
+        error = std::max(error,
+                         ElementError(matrices[i].m, reference[i].data(), 16));
+      }
+      results.push_back({op, library, batch, ns, error});
+    }
+  }
+
+  // kernel(n, XrVector3f *out) writes out[0, n)
+  template <typename F>
+  void Points(const char *op, const char *library,
+              const std::vector<Vector3d> &reference, F &&kernel) {
+    for (auto batch : BATCH_SIZES) {
+      std::fill(points.begin(), points.end(), XrVector3f{});
+      auto ns = Measure(batch, kernel, points.data());
+      double error = 0;
+      for (size_t i = 0; i < batch; ++i) {
+        error =
+            std::max(error, ElementError(&points[i].x, reference[i].data(), 3));
+      }
+      results.push_back({op, library, batch, ns, error});
+    }
+  }
+};
+
+// glm and DirectXMath read the same memory as XrMatrix4x4f and XrVector3f
+template <typename T, typename S> static const T *As(const std::vector<S> &v) {
+  static_assert(sizeof(T) == sizeof(S));
+  return reinterpret_cast<const T *>(v.data());
+}
+template <typename T, typename S> static T *As(S *p) {
+  static_assert(sizeof(T) == sizeof(S));
+  return reinterpret_cast<T *>(p);
+}
+
+static void Multiply(Bench &bench, const Inputs &in) {
+  std::vector<Matrix4d> reference;
+  for (size_t i = 0; i < MAX_BATCH; ++i) {
+    reference.push_back(MultiplyRef(ToDouble(in.a[i]), ToDouble(in.b[i])));
+  }
+  bench.Matrices("multiply", "xr_linear", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   for (size_t i = 0; i < n; ++i) {
+                     XrMatrix4x4f_Multiply(&out[i], &in.a[i], &in.b[i]);
+                   }
+                 });
+  bench.Matrices("multiply", "util_matrix", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   for (size_t i = 0; i < n; ++i) {
+                     matrix_mult(out[i].m, const_cast<float *>(in.a[i].m),
+                                 const_cast<float *>(in.b[i].m));
+                   }
+                 });
+  bench.Matrices("multiply", "glm", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   auto a = As<glm::mat4>(in.a);
+                   auto b = As<glm::mat4>(in.b);
+                   for (size_t i = 0; i < n; ++i) {
+                     *As<glm::mat4>(&out[i]) = a[i] * b[i];
+                   }
+                 });
+#ifdef MATH_BENCH_DIRECTXMATH
+  bench.Matrices("multiply", "DirectXMath", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   using namespace DirectX;
+                   auto a = As<XMFLOAT4X4>(in.a);
+                   auto b = As<XMFLOAT4X4>(in.b);
+                   for (size_t i = 0; i < n; ++i) {
+                     XMStoreFloat4x4(
+                         As<XMFLOAT4X4>(&out[i]),
+                         XMMatrixMultiply(XMLoadFloat4x4(&b[i]),
+                                          XMLoadFloat4x4(&a[i])));
+                   }
+                 });
+#endif
+}
+
+static void Invert(Bench &bench, const Inputs &in) {
+  std::vector<Matrix4d> reference;
+  for (size_t i = 0; i < MAX_BATCH; ++i) {
+    reference.push_back(InvertRef(ToDouble(in.a[i])));
+  }
+  bench.Matrices("invert", "xr_linear", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   for (size_t i = 0; i < n; ++i) {
+                     XrMatrix4x4f_Invert(&out[i], &in.a[i]);
+                   }
+                 });
+  // in place
+  bench.Matrices("invert", "util_matrix", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   for (size_t i = 0; i < n; ++i) {
+                     out[i] = in.a[i];
+                     matrix_invert(out[i].m);
+                   }
+                 });
+  bench.Matrices("invert", "glm", reference, [&](size_t n, XrMatrix4x4f *out) {
+    auto a = As<glm::mat4>(in.a);
+    for (size_t i = 0; i < n; ++i) {
+      *As<glm::mat4>(&out[i]) = glm::inverse(a[i]);
+    }
+  });
+#ifdef MATH_BENCH_DIRECTXMATH
+  bench.Matrices("invert", "DirectXMath", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   using namespace DirectX;
+                   auto a = As<XMFLOAT4X4>(in.a);
+                   for (size_t i = 0; i < n; ++i) {
+                     XMStoreFloat4x4(
+                         As<XMFLOAT4X4>(&out[i]),
+                         XMMatrixInverse(nullptr, XMLoadFloat4x4(&a[i])));
+                   }
+                 });
+#endif
+}
+
+// util_matrix has the affine path of matrix_invert, glm affineInverse and
+// DirectXMath the transposed rotation.
+static void InvertRigidBody(Bench &bench, const Inputs &in) {
+  std::vector<Matrix4d> reference;
+  for (size_t i = 0; i < MAX_BATCH; ++i) {
+    reference.push_back(InvertRef(ToDouble(in.rigid[i])));
+  }
+  bench.Matrices("invertRigidBody", "xr_linear", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   for (size_t i = 0; i < n; ++i) {
+                     XrMatrix4x4f_InvertRigidBody(&out[i], &in.rigid[i]);
+                   }
+                 });
+  bench.Matrices("invertRigidBody", "util_matrix", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   for (size_t i = 0; i < n; ++i) {
+                     out[i] = in.rigid[i];
+                     matrix_invert(out[i].m);
+                   }
+                 });
+  bench.Matrices("invertRigidBody", "glm", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   auto a = As<glm::mat4>(in.rigid);
+                   for (size_t i = 0; i < n; ++i) {
+                     *As<glm::mat4>(&out[i]) = glm::affineInverse(a[i]);
+                   }
+                 });
+#ifdef MATH_BENCH_DIRECTXMATH
+  bench.Matrices(
+      "invertRigidBody", "DirectXMath", reference,
+      [&](size_t n, XrMatrix4x4f *out) {
+        using namespace DirectX;
+        auto a = As<XMFLOAT4X4>(in.rigid);
+        for (size_t i = 0; i < n; ++i) {
+          auto m = XMLoadFloat4x4(&a[i]);
+          auto t = m.r[3];
+          m.r[3] = g_XMIdentityR3;
+          auto r = XMMatrixTranspose(m);
+          r.r[3] = XMVectorSetW(XMVectorNegate(XMVector3TransformNormal(t, r)),
+                                1.0f);
+          XMStoreFloat4x4(As<XMFLOAT4X4>(&out[i]), r);
+        }
+      });
+#endif
+}
+
+static void QuaternionToMatrix(Bench &bench, const Inputs &in) {
+  std::vector<Matrix4d> reference;
+  for (size_t i = 0; i < MAX_BATCH; ++i) {
+    reference.push_back(QuaternionRef(in.rotation[i]));
+  }
+  bench.Matrices("quaternionToMatrix", "xr_linear", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   for (size_t i = 0; i < n; ++i) {
+                     XrMatrix4x4f_CreateFromQuaternion(&out[i],
+                                                       &in.rotation[i]);
+                   }
+                 });
+  bench.Matrices("quaternionToMatrix", "util_matrix", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   for (size_t i = 0; i < n; ++i) {
+                     quaternion_to_matrix(
+                         out[i].m,
+                         const_cast<float *>(in.rotationWxyz[i].data()));
+                   }
+                 });
+  bench.Matrices("quaternionToMatrix", "glm", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   for (size_t i = 0; i < n; ++i) {
+                     auto &q = in.rotation[i];
+                     *As<glm::mat4>(&out[i]) =
+                         glm::mat4_cast(glm::quat(q.w, q.x, q.y, q.z));
+                   }
+                 });
+#ifdef MATH_BENCH_DIRECTXMATH
+  bench.Matrices("quaternionToMatrix", "DirectXMath", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   using namespace DirectX;
+                   auto q = As<XMFLOAT4>(in.rotation);
+                   for (size_t i = 0; i < n; ++i) {
+                     XMStoreFloat4x4(
+                         As<XMFLOAT4X4>(&out[i]),
+                         XMMatrixRotationQuaternion(XMLoadFloat4(&q[i])));
+                   }
+                 });
+#endif
+}
+
+// DirectXMath has the D3D depth range only
+static void ProjectionFov(Bench &bench, const Inputs &in) {
+  std::vector<Matrix4d> reference;
+  std::vector<Matrix4d> referenceD3D;
+  for (size_t i = 0; i < MAX_BATCH; ++i) {
+    reference.push_back(ProjectionRef(in.fov[i], false));
+    referenceD3D.push_back(ProjectionRef(in.fov[i], true));
+  }
+  bench.Matrices("projectionFov", "xr_linear", reference,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   for (size_t i = 0; i < n; ++i) {
+                     XrMatrix4x4f_CreateProjectionFov(
+                         &out[i], GRAPHICS_OPENGL, in.fov[i], NEAR_Z, FAR_Z);
+                   }
+                 });
+  bench.Matrices(
+      "projectionFov", "util_matrix", reference,
+      [&](size_t n, XrMatrix4x4f *out) {
+        for (size_t i = 0; i < n; ++i) {
+          auto &fov = in.fov[i];
+          matrix_proj_frustum(out[i].m, tanf(fov.angleLeft) * NEAR_Z,
+                              tanf(fov.angleRight) * NEAR_Z,
+                              tanf(fov.angleDown) * NEAR_Z,
+                              tanf(fov.angleUp) * NEAR_Z, NEAR_Z, FAR_Z);
+        }
+      });
+  bench.Matrices(
+      "projectionFov", "glm", reference, [&](size_t n, XrMatrix4x4f *out) {
+        for (size_t i = 0; i < n; ++i) {
+          auto &fov = in.fov[i];
+          *As<glm::mat4>(&out[i]) = glm::frustumRH_NO(
+              tanf(fov.angleLeft) * NEAR_Z, tanf(fov.angleRight) * NEAR_Z,
+              tanf(fov.angleDown) * NEAR_Z, tanf(fov.angleUp) * NEAR_Z,
+              NEAR_Z, FAR_Z);
+        }
+      });
+#ifdef MATH_BENCH_DIRECTXMATH
+  bench.Matrices("projectionFov", "DirectXMath", referenceD3D,
+                 [&](size_t n, XrMatrix4x4f *out) {
+                   using namespace DirectX;
+                   for (size_t i = 0; i < n; ++i) {
+                     auto &fov = in.fov[i];
+                     XMStoreFloat4x4(
+                         As<XMFLOAT4X4>(&out[i]),
+                         XMMatrixPerspectiveOffCenterRH(
+                             tanf(fov.angleLeft) * NEAR_Z,
+                             tanf(fov.angleRight) * NEAR_Z,
+                             tanf(fov.angleDown) * NEAR_Z,
+                             tanf(fov.angleUp) * NEAR_Z, NEAR_Z, FAR_Z));
+                   }
+                 });
+#endif
+}
+
+// a matrix per point. util_matrix does not divide by w, the matrices are rigid
+static void TransformVector(Bench &bench, const Inputs &in) {
+  std::vector<Vector3d> reference;
+  for (size_t i = 0; i < MAX_BATCH; ++i) {
+    reference.push_back(TransformRef(ToDouble(in.rigid[i]), in.point[i]));
+  }
+  bench.Points("transformVector", "xr_linear", reference,
+               [&](size_t n, XrVector3f *out) {
+                 for (size_t i = 0; i < n; ++i) {
+                   XrMatrix4x4f_TransformVector3f(&out[i], &in.rigid[i],
+                                                  &in.point[i]);
+                 }
+               });
+  bench.Points("transformVector", "util_matrix", reference,
+               [&](size_t n, XrVector3f *out) {
+                 for (size_t i = 0; i < n; ++i) {
+                   matrix_multvec3(const_cast<float *>(in.rigid[i].m),
+                                   const_cast<float *>(&in.point[i].x),
+                                   &out[i].x);
+                 }
+               });
+  bench.Points("transformVector", "glm", reference,
+               [&](size_t n, XrVector3f *out) {
+                 auto m = As<glm::mat4>(in.rigid);
+                 auto p = As<glm::vec3>(in.point);
+                 for (size_t i = 0; i < n; ++i) {
+                   auto v = m[i] * glm::vec4(p[i], 1.0f);
+                   *As<glm::vec3>(&out[i]) = glm::vec3(v) / v.w;
+                 }
+               });
+#ifdef MATH_BENCH_DIRECTXMATH
+  bench.Points("transformVector", "DirectXMath", reference,
+               [&](size_t n, XrVector3f *out) {
+                 using namespace DirectX;
+                 auto m = As<XMFLOAT4X4>(in.rigid);
+                 auto p = As<XMFLOAT3>(in.point);
+                 for (size_t i = 0; i < n; ++i) {
+                   XMStoreFloat3(As<XMFLOAT3>(&out[i]),
+                                 XMVector3TransformCoord(XMLoadFloat3(&p[i]),
+                                                         XMLoadFloat4x4(&m[i])));
+                 }
+               });
+#endif
+}
+
+// one matrix for all points
+static void TransformBatch(Bench &bench, const Inputs &in) {
+  auto matrix = ToDouble(in.rigid[0]);
+  std::vector<Vector3d> reference;
+  for (size_t i = 0; i < MAX_BATCH; ++i) {
+    reference.push_back(TransformRef(matrix, in.point[i]));
+  }
+  bench.Points("transformBatch", "xr_linear", reference,
+               [&](size_t n, XrVector3f *out) {
+                 for (size_t i = 0; i < n; ++i) {
+                   XrMatrix4x4f_TransformVector3f(&out[i], &in.rigid[0],
+                                                  &in.point[i]);
+                 }
+               });
+  bench.Points("transformBatch", "util_matrix", reference,
+               [&](size_t n, XrVector3f *out) {
+                 auto m = const_cast<float *>(in.rigid[0].m);
+                 for (size_t i = 0; i < n; ++i) {
+                   matrix_multvec3(m, const_cast<float *>(&in.point[i].x),
+                                   &out[i].x);
+                 }
+               });
+  bench.Points("transformBatch", "glm", reference,
+               [&](size_t n, XrVector3f *out) {
+                 auto m = *As<glm::mat4>(in.rigid);
+                 auto p = As<glm::vec3>(in.point);
+                 for (size_t i = 0; i < n; ++i) {
+                   auto v = m * glm::vec4(p[i], 1.0f);
+                   *As<glm::vec3>(&out[i]) = glm::vec3(v) / v.w;
+                 }
+               });
+#ifdef MATH_BENCH_DIRECTXMATH
+  bench.Points("transformBatch", "DirectXMath", reference,
+               [&](size_t n, XrVector3f *out) {
+                 using namespace DirectX;
+                 XMVector3TransformCoordStream(
+                     As<XMFLOAT3>(out), sizeof(XMFLOAT3),
+                     As<XMFLOAT3>(in.point), sizeof(XMFLOAT3), n,
+                     XMLoadFloat4x4(As<XMFLOAT4X4>(in.rigid)));
+               });
+#endif
+}
+
+int main(int argc, char **argv) {
+  size_t count = 1 << 20;
+  const char *output = nullptr;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string_view arg = argv[i];
+    if (arg == "--count") {
+      count = std::max(1, atoi(argv[i + 1]));
+    } else if (arg == "--output") {
+      output = argv[i + 1];
+    }
+  }
+
+  Inputs in;
+  Bench bench{.count = count};
+  Multiply(bench, in);
+  Invert(bench, in);
+  InvertRigidBody(bench, in);
+  QuaternionToMatrix(bench, in);
+  ProjectionFov(bench, in);
+  TransformVector(bench, in);
+  TransformBatch(bench, in);
+
+  auto fp = output ? fopen(output, "w") : stdout;
+  if (!fp) {
+    fprintf(stderr, "fopen %s\n", output);
+    return 1;
+  }
+  fprintf(fp, "{\n");
+#if defined(XR_LINEAR_SSE2)
+  fprintf(fp, "  \"xr_linear\": \"sse2\",\n");
+#elif defined(XR_LINEAR_NEON)
+  fprintf(fp, "  \"xr_linear\": \"neon\",\n");
+#else
+  fprintf(fp, "  \"xr_linear\": \"scalar\",\n");
+#endif
+  fprintf(fp, "  \"unit\": \"ns\",\n");
+  fprintf(fp, "  \"results\": [\n");
+  for (size_t i = 0; i < bench.results.size(); ++i) {
+    auto &r = bench.results[i];
+    fprintf(fp,
+            "    {\"op\": \"%s\", \"library\": \"%s\", \"batch\": %zu, "
+            "\"ns\": %.2f, \"error\": %.3g}%s\n",
+            r.op, r.library, r.batch, r.ns, r.error,
+            i + 1 < bench.results.size() ? "," : "");
+  }
+  fprintf(fp, "  ]\n");
+  fprintf(fp, "}\n");
+  if (fp != stdout) {
+    fclose(fp);
+  }
+  return 0;
+}
@@ -1,13 +1,18 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "../../src/xr_linear.h"
-#include <corecrt_math.h>
+#include <array>
+#include <cmath>
 #include <cstdint>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <numbers>
 #include <openxr/openxr.h>
+#include <random>
 #include <span>
+#include <vector>
+#include <xrfw_cull.h>
+#include <xrfw_pose_batch.h>
 
 const float EPSILON = 1e-3f;
 static bool CompareMatrix(std::span<const float> lhs,
@@ -27,7 +32,7 @@ static bool CompareMatrix(std::span<const float> lhs,
   return true;
 }
 
-static float deg2rad(float src) {
+static constexpr float deg2rad(float src) {
   return static_cast<float>(src / 180.0 * std::numbers::pi);
 }
 
@@ -112,3 +117,556 @@ TEST_CASE("projection", "[matrix]") {
   REQUIRE(
       CompareMatrix(std::span{proj.m, 16}, std::span{&glm_proj2[0][0], 16}));
 }
+
+// The SIMD versions of xr_linear.h (SSE2 / NEON) against the scalar C ones.
+// Without XR_LINEAR_SIMD both sides are the scalar code.
+static XrMatrix4x4f RandomMatrix(std::mt19937 &rng) {
+  std::uniform_real_distribution<float> dist(-4.0f, 4.0f);
+  XrMatrix4x4f m;
+  for (auto &f : m.m) {
+    f = dist(rng);
+  }
+  return m;
+}
+
+static XrQuaternionf RandomRotation(std::mt19937 &rng) {
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  XrQuaternionf q = {dist(rng), dist(rng), dist(rng), dist(rng)};
+  auto length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+  return {q.x / length, q.y / length, q.z / length, q.w / length};
+}
+
+TEST_CASE("simd multiply", "[matrix][simd]") {
+  std::mt19937 rng(1);
+  for (int i = 0; i < 1000; ++i) {
+    auto a = RandomMatrix(rng);
+    auto b = RandomMatrix(rng);
+    XrMatrix4x4f simd;
+    XrMatrix4x4f_Multiply(&simd, &a, &b);
+    XrMatrix4x4f scalar;
+    XrMatrix4x4f_Multiply_Scalar(&scalar, &a, &b);
+    REQUIRE(CompareMatrix(std::span{simd.m, 16}, std::span{scalar.m, 16}));
+  }
+}
+
+TEST_CASE("simd invert", "[matrix][simd]") {
+  std::mt19937 rng(2);
+  for (int i = 0; i < 1000; ++i) {
+    // well conditioned. a rigid body transform with a scale
+    XrMatrix4x4f rotation;
+    auto q = RandomRotation(rng);
+    XrMatrix4x4f_CreateFromQuaternion_Scalar(&rotation, &q);
+    auto r = RandomMatrix(rng);
+    XrMatrix4x4f scale;
+    XrMatrix4x4f_CreateScale(&scale, 1.0f + fabsf(r.m[0]), 1.0f + fabsf(r.m[1]),
+                             1.0f + fabsf(r.m[2]));
+    XrMatrix4x4f translation;
+    XrMatrix4x4f_CreateTranslation(&translation, r.m[3], r.m[4], r.m[5]);
+    XrMatrix4x4f rs;
+    XrMatrix4x4f_Multiply_Scalar(&rs, &rotation, &scale);
+    XrMatrix4x4f m;
+    XrMatrix4x4f_Multiply_Scalar(&m, &translation, &rs);
+
+    XrMatrix4x4f simd;
+    XrMatrix4x4f_Invert(&simd, &m);
+    XrMatrix4x4f scalar;
+    XrMatrix4x4f_Invert_Scalar(&scalar, &m);
+    REQUIRE(CompareMatrix(std::span{simd.m, 16}, std::span{scalar.m, 16}));
+
+    XrMatrix4x4f identity;
+    XrMatrix4x4f_CreateIdentity(&identity);
+    XrMatrix4x4f product;
+    XrMatrix4x4f_Multiply_Scalar(&product, &m, &simd);
+    REQUIRE(
+        CompareMatrix(std::span{product.m, 16}, std::span{identity.m, 16}));
+  }
+}
+
+TEST_CASE("simd invert rigid body", "[matrix][simd]") {
+  std::mt19937 rng(3);
+  for (int i = 0; i < 1000; ++i) {
+    auto q = RandomRotation(rng);
+    XrMatrix4x4f m;
+    XrMatrix4x4f_CreateFromQuaternion_Scalar(&m, &q);
+    auto r = RandomMatrix(rng);
+    m.m[12] = r.m[0];
+    m.m[13] = r.m[1];
+    m.m[14] = r.m[2];
+
+    XrMatrix4x4f simd;
+    XrMatrix4x4f_InvertRigidBody(&simd, &m);
+    XrMatrix4x4f scalar;
+    XrMatrix4x4f_InvertRigidBody_Scalar(&scalar, &m);
+    REQUIRE(CompareMatrix(std::span{simd.m, 16}, std::span{scalar.m, 16}));
+  }
+}
+
+TEST_CASE("simd quaternion", "[matrix][simd]") {
+  std::mt19937 rng(4);
+  for (int i = 0; i < 1000; ++i) {
+    auto q = RandomRotation(rng);
+    XrMatrix4x4f simd;
+    XrMatrix4x4f_CreateFromQuaternion(&simd, &q);
+    XrMatrix4x4f scalar;
+    XrMatrix4x4f_CreateFromQuaternion_Scalar(&scalar, &q);
+    REQUIRE(CompareMatrix(std::span{simd.m, 16}, std::span{scalar.m, 16}));
+  }
+}
+
+TEST_CASE("simd transform vector", "[matrix][simd]") {
+  std::mt19937 rng(5);
+  for (int i = 0; i < 1000; ++i) {
+    XrFovf fov = {
+        .angleLeft = deg2rad(-50),
+        .angleRight = deg2rad(45),
+        .angleUp = deg2rad(45),
+        .angleDown = deg2rad(-55),
+    };
+    XrMatrix4x4f proj;
+    XrMatrix4x4f_CreateProjectionFov(&proj, GRAPHICS_OPENGL, fov, 0.05f,
+                                     100.0f);
+    auto r = RandomMatrix(rng);
+    // in front of the camera
+    XrVector3f v = {r.m[0], r.m[1], -1.0f - fabsf(r.m[2])};
+
+    XrVector3f simd;
+    XrMatrix4x4f_TransformVector3f(&simd, &proj, &v);
+    XrVector3f scalar;
+    XrMatrix4x4f_TransformVector3f_Scalar(&scalar, &proj, &v);
+    REQUIRE(fabs(simd.x - scalar.x) <= EPSILON);
+    REQUIRE(fabs(simd.y - scalar.y) <= EPSILON);
+    REQUIRE(fabs(simd.z - scalar.z) <= EPSILON);
+  }
+}
+
+// Compile time tables (constexpr xr_linear.h in C++20) against the same calls
+// at run time.
+static constexpr XrFovf CONSTEXPR_FOV = {
+    .angleLeft = deg2rad(-50),
+    .angleRight = deg2rad(45),
+    .angleUp = deg2rad(45),
+    .angleDown = deg2rad(-55),
+};
+
+static constexpr XrMatrix4x4f CONSTEXPR_PROJECTION = [] {
+  XrMatrix4x4f m{};
+  XrMatrix4x4f_CreateProjectionFov(&m, GRAPHICS_OPENGL, CONSTEXPR_FOV, 0.05f,
+                                   100.0f);
+  return m;
+}();
+static_assert(CONSTEXPR_PROJECTION.m[11] == -1.0f);
+static_assert(CONSTEXPR_PROJECTION.m[15] == 0.0f);
+
+static constexpr XrMatrix4x4f CONSTEXPR_ROTATION = [] {
+  XrMatrix4x4f m{};
+  XrMatrix4x4f_CreateRotation(&m, 30.0f, 45.0f, 60.0f);
+  return m;
+}();
+static_assert(XrMatrix4x4f_IsRigidBody(&CONSTEXPR_ROTATION, 1e-5f));
+
+// the SIMD versions fall back to the scalar ones
+static constexpr XrMatrix4x4f CONSTEXPR_ROTATION_INVERSE = [] {
+  XrMatrix4x4f inverse{};
+  XrMatrix4x4f_Invert(&inverse, &CONSTEXPR_ROTATION);
+  XrMatrix4x4f identity{};
+  XrMatrix4x4f_Multiply(&identity, &inverse, &CONSTEXPR_ROTATION);
+  return identity;
+}();
+static_assert(XrMath_Fabs(CONSTEXPR_ROTATION_INVERSE.m[0] - 1.0f) < 1e-5f);
+static_assert(XrMath_Fabs(CONSTEXPR_ROTATION_INVERSE.m[4]) < 1e-5f);
+
+static constexpr std::array<float, 64> CONSTEXPR_SIN_TABLE = [] {
+  std::array<float, 64> table{};
+  for (size_t i = 0; i < table.size(); ++i) {
+    table[i] = XrMath_Sin(i * 2.0f * MATH_PI / table.size());
+  }
+  return table;
+}();
+static_assert(CONSTEXPR_SIN_TABLE[0] == 0.0f);
+static_assert(XrMath_Fabs(CONSTEXPR_SIN_TABLE[16] - 1.0f) < 1e-6f);
+static_assert(XrMath_Sqrt(16.0f) == 4.0f);
+
+// sin, cos, tan, sqrt over [-100, 100)
+static constexpr float CONSTEXPR_STEP = 0.37f;
+// x is stored with the values, recomputing it at run time may contract to fma
+static constexpr std::array<std::array<float, 5>, 541> CONSTEXPR_MATH = [] {
+  std::array<std::array<float, 5>, 541> table{};
+  for (size_t i = 0; i < table.size(); ++i) {
+    float x = -100.0f + i * CONSTEXPR_STEP;
+    table[i] = {x, XrMath_Sin(x), XrMath_Cos(x), XrMath_Tan(x),
+                XrMath_Sqrt(XrMath_Fabs(x))};
+  }
+  return table;
+}();
+
+TEST_CASE("constexpr math", "[math][constexpr]") {
+  for (size_t i = 0; i < CONSTEXPR_SIN_TABLE.size(); ++i) {
+    REQUIRE(fabs(CONSTEXPR_SIN_TABLE[i] -
+                 sinf(i * 2.0f * MATH_PI / CONSTEXPR_SIN_TABLE.size())) <=
+            1e-6f);
+  }
+  for (auto &values : CONSTEXPR_MATH) {
+    float x = values[0];
+    REQUIRE(fabs(values[1] - sinf(x)) <= 1e-5f);
+    REQUIRE(fabs(values[2] - cosf(x)) <= 1e-5f);
+    REQUIRE(fabs(values[3] - tanf(x)) <= 1e-5f * (1 + tanf(x) * tanf(x)));
+    REQUIRE(values[4] == sqrtf(fabsf(x)));
+  }
+}
+
+TEST_CASE("constexpr matrix", "[matrix][constexpr]") {
+  XrMatrix4x4f proj;
+  XrMatrix4x4f_CreateProjectionFov(&proj, GRAPHICS_OPENGL, CONSTEXPR_FOV, 0.05f,
+                                   100.0f);
+  REQUIRE(CompareMatrix(std::span{CONSTEXPR_PROJECTION.m, 16},
+                        std::span{proj.m, 16}));
+
+  XrMatrix4x4f rotation;
+  XrMatrix4x4f_CreateRotation(&rotation, 30.0f, 45.0f, 60.0f);
+  REQUIRE(CompareMatrix(std::span{CONSTEXPR_ROTATION.m, 16},
+                        std::span{rotation.m, 16}));
+}
+
+// XrfwPoseBatch (include/xrfw_pose_batch.h) against the matrices of
+// xr_linear.h. The count is not a multiple of the lane width, the last lane is
+// partial.
+static const size_t POSE_COUNT = 3 * XRFW_SIMD_WIDTH + 1;
+
+static XrPosef RandomPose(std::mt19937 &rng) {
+  std::uniform_real_distribution<float> dist(-4.0f, 4.0f);
+  return {RandomRotation(rng), {dist(rng), dist(rng), dist(rng)}};
+}
+
+static float RandomScale(std::mt19937 &rng) {
+  std::uniform_real_distribution<float> dist(0.5f, 2.0f);
+  return dist(rng);
+}
+
+static XrMatrix4x4f PoseMatrix(const XrPosef &pose, float scale) {
+  XrVector3f s = {scale, scale, scale};
+  XrMatrix4x4f m;
+  XrMatrix4x4f_CreateTranslationRotationScale(&m, &pose.position,
+                                              &pose.orientation, &s);
+  return m;
+}
+
+// StoreMatrix4x4 of all joints. One more matrix to catch a write past count
+static std::array<XrMatrix4x4f, POSE_COUNT + 1>
+StoreMatrices(const XrfwPoseBatch<POSE_COUNT> &batch) {
+  std::array<XrMatrix4x4f, POSE_COUNT + 1> matrices{};
+  batch.StoreMatrix4x4(matrices.data());
+  return matrices;
+}
+
+TEST_CASE("pose batch matrix", "[matrix][simd][pose_batch]") {
+  std::mt19937 rng(6);
+  std::array<XrPosef, POSE_COUNT> poses;
+  std::array<float, POSE_COUNT> scales;
+  XrfwPoseBatch<POSE_COUNT> batch;
+  for (size_t i = 0; i < POSE_COUNT; ++i) {
+    poses[i] = RandomPose(rng);
+    scales[i] = RandomScale(rng);
+    batch.Push(poses[i], scales[i]);
+  }
+  // over the capacity
+  batch.Push(RandomPose(rng));
+  REQUIRE(batch.count == POSE_COUNT);
+
+  auto matrices = StoreMatrices(batch);
+  float rows[POSE_COUNT + 1][12] = {};
+  batch.StoreMatrix3x4(rows);
+  for (size_t i = 0; i < POSE_COUNT; ++i) {
+    auto expected = PoseMatrix(poses[i], scales[i]);
+    REQUIRE(CompareMatrix(std::span{matrices[i].m, 16},
+                          std::span{expected.m, 16}));
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 4; ++c) {
+        REQUIRE(fabs(rows[i][r * 4 + c] - expected.m[c * 4 + r]) <= EPSILON);
+      }
+    }
+  }
+  XrMatrix4x4f zero{};
+  REQUIRE(CompareMatrix(std::span{matrices[POSE_COUNT].m, 16},
+                        std::span{zero.m, 16}));
+  for (auto f : rows[POSE_COUNT]) {
+    REQUIRE(f == 0.0f);
+  }
+}
+
+TEST_CASE("pose batch compose", "[matrix][simd][pose_batch]") {
+  std::mt19937 rng(7);
+  std::array<XrMatrix4x4f, POSE_COUNT> parents;
+  std::array<XrMatrix4x4f, POSE_COUNT> children;
+  XrfwPoseBatch<POSE_COUNT> parentBatch;
+  XrfwPoseBatch<POSE_COUNT> childBatch;
+  for (size_t i = 0; i < POSE_COUNT; ++i) {
+    auto parent = RandomPose(rng);
+    auto parentScale = RandomScale(rng);
+    parents[i] = PoseMatrix(parent, parentScale);
+    parentBatch.Push(parent, parentScale);
+    auto child = RandomPose(rng);
+    auto childScale = RandomScale(rng);
+    children[i] = PoseMatrix(child, childScale);
+    childBatch.Push(child, childScale);
+  }
+
+  // a pose and a batch
+  auto root = RandomPose(rng);
+  auto rootMatrix = PoseMatrix(root, 1.0f);
+  XrfwPoseBatch<POSE_COUNT> composed;
+  composed.Compose(root, childBatch);
+  REQUIRE(composed.count == POSE_COUNT);
+  auto matrices = StoreMatrices(composed);
+  for (size_t i = 0; i < POSE_COUNT; ++i) {
+    XrMatrix4x4f expected;
+    XrMatrix4x4f_Multiply_Scalar(&expected, &rootMatrix, &children[i]);
+    REQUIRE(CompareMatrix(std::span{matrices[i].m, 16},
+                          std::span{expected.m, 16}));
+  }
+
+  // two batches
+  composed.Compose(parentBatch, childBatch);
+  REQUIRE(composed.count == POSE_COUNT);
+  matrices = StoreMatrices(composed);
+  for (size_t i = 0; i < POSE_COUNT; ++i) {
+    XrMatrix4x4f expected;
+    XrMatrix4x4f_Multiply_Scalar(&expected, &parents[i], &children[i]);
+    REQUIRE(CompareMatrix(std::span{matrices[i].m, 16},
+                          std::span{expected.m, 16}));
+  }
+
+  // in place, this is the child
+  composed = childBatch;
+  composed.Compose(parentBatch, composed);
+  auto inPlace = StoreMatrices(composed);
+  for (size_t i = 0; i < POSE_COUNT; ++i) {
+    REQUIRE(CompareMatrix(std::span{inPlace[i].m, 16},
+                          std::span{matrices[i].m, 16}));
+  }
+
+  // a shorter parent clamps the count. the lanes after it are not composed
+  auto shortCount = POSE_COUNT - XRFW_SIMD_WIDTH - 1;
+  XrfwPoseBatch<POSE_COUNT> shortParent = parentBatch;
+  shortParent.count = shortCount;
+  composed.Compose(shortParent, childBatch);
+  REQUIRE(composed.count == shortCount);
+  auto clamped = StoreMatrices(composed);
+  for (size_t i = 0; i < POSE_COUNT + 1; ++i) {
+    if (i < shortCount) {
+      REQUIRE(CompareMatrix(std::span{clamped[i].m, 16},
+                            std::span{matrices[i].m, 16}));
+    } else {
+      XrMatrix4x4f zero{};
+      REQUIRE(
+          CompareMatrix(std::span{clamped[i].m, 16}, std::span{zero.m, 16}));
+    }
+  }
+}
+
+TEST_CASE("pose batch invert", "[matrix][simd][pose_batch]") {
+  std::mt19937 rng(8);
+  std::array<XrMatrix4x4f, POSE_COUNT> expected;
+  XrfwPoseBatch<POSE_COUNT> batch;
+  for (size_t i = 0; i < POSE_COUNT; ++i) {
+    auto pose = RandomPose(rng);
+    auto scale = RandomScale(rng);
+    auto m = PoseMatrix(pose, scale);
+    XrMatrix4x4f_Invert_Scalar(&expected[i], &m);
+    batch.Push(pose, scale);
+  }
+
+  XrfwPoseBatch<POSE_COUNT> inverse;
+  inverse.Invert(batch);
+  REQUIRE(inverse.count == POSE_COUNT);
+  auto matrices = StoreMatrices(inverse);
+  for (size_t i = 0; i < POSE_COUNT; ++i) {
+    REQUIRE(CompareMatrix(std::span{matrices[i].m, 16},
+                          std::span{expected[i].m, 16}));
+  }
+
+  // in place, then back
+  inverse.Invert(inverse);
+  auto original = StoreMatrices(batch);
+  matrices = StoreMatrices(inverse);
+  for (size_t i = 0; i < POSE_COUNT; ++i) {
+    REQUIRE(CompareMatrix(std::span{matrices[i].m, 16},
+                          std::span{original[i].m, 16}));
+  }
+}
+
+// xrfwCullBoxes / xrfwCullSpheres (include/xrfw_cull.h) against
+// XrMatrix4x4f_CullBounds per eye. Eyes 64mm apart at the origin look at -Z.
+struct CullEyes {
+  XrMatrix4x4f projection[2];
+  XrMatrix4x4f view[2];
+  XrMatrix4x4f viewProjection[2];
+  XrfwCullFrustum frustum;
+
+  CullEyes() {
+    XrFovf fov = {
+        .angleLeft = deg2rad(-45),
+        .angleRight = deg2rad(45),
+        .angleUp = deg2rad(45),
+        .angleDown = deg2rad(-45),
+    };
+    for (int eye = 0; eye < 2; ++eye) {
+      XrMatrix4x4f_CreateProjectionFov(&projection[eye], GRAPHICS_OPENGL, fov,
+                                       0.05f, 100.0f);
+      XrMatrix4x4f pose;
+      XrMatrix4x4f_CreateTranslation(&pose, eye ? 0.032f : -0.032f, 0, 0);
+      XrMatrix4x4f_InvertRigidBody(&view[eye], &pose);
+      XrMatrix4x4f_Multiply_Scalar(&viewProjection[eye], &projection[eye],
+                                   &view[eye]);
+    }
+    frustum.Set(projection[0].m, view[0].m, projection[1].m, view[1].m);
+  }
+
+  bool Visible(const XrVector3f &mins, const XrVector3f &maxs) const {
+    return !XrMatrix4x4f_CullBounds(&viewProjection[0], &mins, &maxs) ||
+           !XrMatrix4x4f_CullBounds(&viewProjection[1], &mins, &maxs);
+  }
+};
+
+struct CullBox {
+  XrVector3f mins;
+  XrVector3f maxs;
+};
+
+static std::vector<CullBox> CullEdgeBoxes() {
+  return {
+      // fully inside
+      {{-0.5f, -0.5f, -5.5f}, {0.5f, 0.5f, -4.5f}},
+      // straddling the left plane
+      {{-6.0f, -0.5f, -5.5f}, {-4.0f, 0.5f, -4.5f}},
+      // straddling the near plane
+      {{-0.01f, -0.01f, -0.06f}, {0.01f, 0.01f, -0.04f}},
+      // straddling the far plane
+      {{-0.5f, -0.5f, -100.5f}, {0.5f, 0.5f, -99.5f}},
+      // between the eye and the near plane
+      {{-0.01f, -0.01f, -0.04f}, {0.01f, 0.01f, -0.02f}},
+      // behind the eye
+      {{-0.5f, -0.5f, 4.5f}, {0.5f, 0.5f, 5.5f}},
+      // past the far plane
+      {{-0.5f, -0.5f, -120.5f}, {0.5f, 0.5f, -119.5f}},
+      // right of the left eye, inside the right one
+      {{0.99f, -0.01f, -1.01f}, {1.01f, 0.01f, -0.99f}},
+      // right of both eyes
+      {{1.1f, -0.01f, -1.01f}, {1.2f, 0.01f, -0.99f}},
+      // enclosing both eyes
+      {{-200.0f, -200.0f, -200.0f}, {200.0f, 200.0f, 200.0f}},
+  };
+}
+
+static std::vector<CullBox> CullRandomBoxes(std::mt19937 &rng, size_t count) {
+  std::uniform_real_distribution<float> center(-20.0f, 20.0f);
+  std::uniform_real_distribution<float> extent(0.01f, 2.0f);
+  std::vector<CullBox> boxes;
+  for (size_t i = 0; i < count; ++i) {
+    XrVector3f c = {center(rng), center(rng), center(rng)};
+    XrVector3f e = {extent(rng), extent(rng), extent(rng)};
+    boxes.push_back(
+        {{c.x - e.x, c.y - e.y, c.z - e.z}, {c.x + e.x, c.y + e.y, c.z + e.z}});
+  }
+  return boxes;
+}
+
+TEST_CASE("cull edge boxes", "[cull][simd]") {
+  CullEyes eyes;
+  auto boxes = CullEdgeBoxes();
+  const bool expected[] = {true,  true,  true,  true, false,
+                           false, false, true,  false, true};
+  REQUIRE(boxes.size() == std::size(expected));
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    REQUIRE(eyes.Visible(boxes[i].mins, boxes[i].maxs) == expected[i]);
+    // one box, the first lane partial
+    XrfwCullBoxes soa;
+    soa.Push(boxes[i].mins, boxes[i].maxs);
+    uint32_t visible[1];
+    REQUIRE(xrfwCullBoxes(eyes.frustum, soa, visible) == (expected[i] ? 1 : 0));
+  }
+
+  // the lanes past the count are not visible
+  XrfwCullBoxes partial;
+  for (size_t i = 0; i < XRFW_SIMD_WIDTH; ++i) {
+    partial.Push(boxes[0].mins, boxes[0].maxs);
+  }
+  partial.count = 1;
+  uint32_t visible[XRFW_SIMD_WIDTH];
+  REQUIRE(xrfwCullBoxes(eyes.frustum, partial, visible) == 1);
+  REQUIRE(visible[0] == 0);
+
+  XrfwCullBoxes empty;
+  REQUIRE(xrfwCullBoxes(eyes.frustum, empty, nullptr) == 0);
+}
+
+TEST_CASE("cull boxes", "[cull][simd]") {
+  CullEyes eyes;
+  std::mt19937 rng(9);
+  // the edge cases at the start, a count with a partial last lane
+  auto boxes = CullEdgeBoxes();
+  auto random = CullRandomBoxes(rng, 64 * XRFW_SIMD_WIDTH + 3);
+  boxes.insert(boxes.end(), random.begin(), random.end());
+  REQUIRE((XRFW_SIMD_WIDTH == 1 || boxes.size() % XRFW_SIMD_WIDTH != 0));
+
+  XrfwCullBoxes soa;
+  std::vector<uint32_t> expected;
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    soa.Push(boxes[i].mins, boxes[i].maxs);
+    if (eyes.Visible(boxes[i].mins, boxes[i].maxs)) {
+      expected.push_back(static_cast<uint32_t>(i));
+    }
+  }
+  // some of both
+  REQUIRE(!expected.empty());
+  REQUIRE(expected.size() < boxes.size());
+
+  std::vector<uint32_t> visible(soa.count);
+  visible.resize(xrfwCullBoxes(eyes.frustum, soa, visible.data()));
+  REQUIRE(visible == expected);
+}
+
+TEST_CASE("cull spheres", "[cull][simd]") {
+  CullEyes eyes;
+  std::mt19937 rng(10);
+  auto boxes = CullRandomBoxes(rng, 64 * XRFW_SIMD_WIDTH + 5);
+  REQUIRE((XRFW_SIMD_WIDTH == 1 || boxes.size() % XRFW_SIMD_WIDTH != 0));
+
+  // a sphere is between its inscribed and its enclosing box
+  XrfwCullSpheres soa;
+  std::vector<bool> enclosing;
+  std::vector<bool> inscribed;
+  for (auto &box : boxes) {
+    XrVector3f c = {(box.mins.x + box.maxs.x) * 0.5f,
+                    (box.mins.y + box.maxs.y) * 0.5f,
+                    (box.mins.z + box.maxs.z) * 0.5f};
+    auto r = (box.maxs.x - box.mins.x) * 0.5f;
+    soa.Push(c, r);
+    XrVector3f outer = {r, r, r};
+    XrVector3f mins, maxs;
+    XrVector3f_Sub(&mins, &c, &outer);
+    XrVector3f_Add(&maxs, &c, &outer);
+    enclosing.push_back(eyes.Visible(mins, maxs));
+    auto e = r / sqrtf(3.0f) * 0.99f;
+    XrVector3f inner = {e, e, e};
+    XrVector3f_Sub(&mins, &c, &inner);
+    XrVector3f_Add(&maxs, &c, &inner);
+    inscribed.push_back(eyes.Visible(mins, maxs));
+  }
+
+  std::vector<uint32_t> visible(soa.count);
+  visible.resize(xrfwCullSpheres(eyes.frustum, soa, visible.data()));
+  std::vector<bool> sphere(soa.count);
+  for (size_t i = 0; i < visible.size(); ++i) {
+    REQUIRE(visible[i] < soa.count);
+    REQUIRE((i == 0 || visible[i - 1] < visible[i]));
+    sphere[visible[i]] = true;
+  }
+  for (size_t i = 0; i < soa.count; ++i) {
+    if (inscribed[i]) {
+      REQUIRE(sphere[i]);
+    }
+    if (sphere[i]) {
+      REQUIRE(enclosing[i]);
+    }
+  }
+}
@@ -10,6 +10,88 @@
 #include "util_matrix.h"
 #include <cfloat>
 
+/* ------------------------------------------------ *
+ *  SSE2 / NEON
+ *
+ *  A column of a matrix is 4 floats. The column
+ *  kernels only multiply and add in the order of the
+ *  scalar code, so they give the same results.
+ *  matrix_invert is the exception, see below.
+ *  UTIL_MATRIX_NO_SIMD selects the scalar code.
+ * ------------------------------------------------ */
+#if !defined(UTIL_MATRIX_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define UTIL_MATRIX_SIMD
+typedef __m128 vec4f;
+
+static inline vec4f v4_load  (const float *p)      { return _mm_loadu_ps (p); }
+static inline void  v4_store (float *p, vec4f v)   { _mm_storeu_ps (p, v); }
+static inline vec4f v4_set   (float x, float y, float z, float w) { return _mm_setr_ps (x, y, z, w); }
+static inline vec4f v4_splat (float x)             { return _mm_set1_ps (x); }
+static inline vec4f v4_add   (vec4f a, vec4f b)    { return _mm_add_ps (a, b); }
+static inline vec4f v4_sub   (vec4f a, vec4f b)    { return _mm_sub_ps (a, b); }
+static inline vec4f v4_mul   (vec4f a, vec4f b)    { return _mm_mul_ps (a, b); }
+/* (a[x], a[y], b[z], b[w]) */
+#define V4_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps ((a), (b), _MM_SHUFFLE ((w), (z), (y), (x)))
+
+#elif !defined(UTIL_MATRIX_NO_SIMD) && \
+    (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define UTIL_MATRIX_SIMD
+typedef float32x4_t vec4f;
+
+static inline vec4f v4_load  (const float *p)      { return vld1q_f32 (p); }
+static inline void  v4_store (float *p, vec4f v)   { vst1q_f32 (p, v); }
+static inline vec4f v4_set   (float x, float y, float z, float w)
+{
+    float v[4] = {x, y, z, w};
+    return vld1q_f32 (v);
+}
+static inline vec4f v4_splat (float x)             { return vdupq_n_f32 (x); }
+static inline vec4f v4_add   (vec4f a, vec4f b)    { return vaddq_f32 (a, b); }
+static inline vec4f v4_sub   (vec4f a, vec4f b)    { return vsubq_f32 (a, b); }
+static inline vec4f v4_mul   (vec4f a, vec4f b)    { return vmulq_f32 (a, b); }
+/* (a[x], a[y], b[z], b[w]) */
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 12)
+#define V4_SHUFFLE(a, b, x, y, z, w) __builtin_shufflevector ((a), (b), (x), (y), (z) + 4, (w) + 4)
+#else
+#define V4_SHUFFLE(a, b, x, y, z, w) \
+    v4_set (vgetq_lane_f32 ((a), (x)), vgetq_lane_f32 ((a), (y)), vgetq_lane_f32 ((b), (z)), vgetq_lane_f32 ((b), (w)))
+#endif
+#endif
+
+#if defined(UTIL_MATRIX_SIMD)
+/* col0 * v[0] + col1 * v[1] + col2 * v[2] + col3 * v[3], summed from col3 like matrix_multvec4 */
+static inline vec4f
+v4_transform (vec4f c0, vec4f c1, vec4f c2, vec4f c3, const float *v)
+{
+    vec4f d = v4_mul (c3, v4_splat (v[3]));
+    d = v4_add (d, v4_mul (c2, v4_splat (v[2])));
+    d = v4_add (d, v4_mul (c1, v4_splat (v[1])));
+    return v4_add (d, v4_mul (c0, v4_splat (v[0])));
+}
+
+/* col0 * v[0] + col1 * v[1] + col2 * v[2] + col3, summed like matrix_multvec3 */
+static inline vec4f
+v4_transform_point (vec4f c0, vec4f c1, vec4f c2, vec4f c3, float v0, float v1, float v2)
+{
+    vec4f d = v4_add (c3, v4_mul (c2, v4_splat (v2)));
+    d = v4_add (d, v4_mul (c1, v4_splat (v1)));
+    return v4_add (d, v4_mul (c0, v4_splat (v0)));
+}
+
+/* m1 * b, b is column major. summed from column 0 like matrix_mult */
+static inline vec4f
+v4_mult_column (vec4f c0, vec4f c1, vec4f c2, vec4f c3, const float *b)
+{
+    vec4f d = v4_mul (c0, v4_splat (b[0]));
+    d = v4_add (d, v4_mul (c1, v4_splat (b[1])));
+    d = v4_add (d, v4_mul (c2, v4_splat (b[2])));
+    return v4_add (d, v4_mul (c3, v4_splat (b[3])));
+}
+#endif
+
 float
 vec3_length (float *v)
 {
@@ -214,6 +296,15 @@ ray_proj_perspective (float *ray,                           /* [out] ray vector
 static void
 turn_x (float *m, float cosA, float sinA)
 {
+#if defined(UTIL_MATRIX_SIMD)
+    vec4f c  = v4_splat (cosA);
+    vec4f s  = v4_splat (sinA);
+    vec4f c1 = v4_load (&m[4]);
+    vec4f c2 = v4_load (&m[8]);
+
+    v4_store (&m[4], v4_add (v4_mul (s, c2), v4_mul (c, c1)));
+    v4_store (&m[8], v4_sub (v4_mul (c, c2), v4_mul (s, c1)));
+#else
     float m01, m02;
     float m11, m12;
     float m21, m22;
@@ -267,6 +358,7 @@ turn_x (float *m, float cosA, float sinA)
 
     m[7] = mx31;
     m[11] = mx32;
+#endif
 }
 
 /*
@@ -282,6 +374,15 @@ turn_x (float *m, float cosA, float sinA)
 static void
 turn_y (float *m, float cosA, float sinA)
 {
+#if defined(UTIL_MATRIX_SIMD)
+    vec4f c  = v4_splat (cosA);
+    vec4f s  = v4_splat (sinA);
+    vec4f c0 = v4_load (&m[0]);
+    vec4f c2 = v4_load (&m[8]);
+
+    v4_store (&m[0], v4_sub (v4_mul (c, c0), v4_mul (s, c2)));
+    v4_store (&m[8], v4_add (v4_mul (c, c2), v4_mul (s, c0)));
+#else
     float m00, m02;
     float m10, m12;
     float m20, m22;
@@ -335,6 +436,7 @@ turn_y (float *m, float cosA, float sinA)
 
     m[3] = mx30;
     m[11] = mx32;
+#endif
 }
 
 /*
@@ -351,6 +453,15 @@ turn_y (float *m, float cosA, float sinA)
 static void
 turn_z (float *m, float cosA, float sinA)
 {
+#if defined(UTIL_MATRIX_SIMD)
+    vec4f c  = v4_splat (cosA);
+    vec4f s  = v4_splat (sinA);
+    vec4f c0 = v4_load (&m[0]);
+    vec4f c1 = v4_load (&m[4]);
+
+    v4_store (&m[0], v4_add (v4_mul (s, c1), v4_mul (c, c0)));
+    v4_store (&m[4], v4_sub (v4_mul (c, c1), v4_mul (s, c0)));
+#else
     float m00, m01;
     float m10, m11;
     float m20, m21;
@@ -401,6 +512,7 @@ turn_z (float *m, float cosA, float sinA)
     m[6] = mx21;
     m[3] = mx30;
     m[7] = mx31;
+#endif
 }
 
 /************************************************************
@@ -415,6 +527,14 @@ turn_z (float *m, float cosA, float sinA)
 void
 matrix_translate (float *m, float x, float y, float z)
 {
+#if defined(UTIL_MATRIX_SIMD)
+    vec4f c3 = v4_load (&m[12]);
+
+    c3 = v4_add (c3, v4_mul (v4_load (&m[8]), v4_splat (z)));
+    c3 = v4_add (c3, v4_mul (v4_load (&m[4]), v4_splat (y)));
+    c3 = v4_add (c3, v4_mul (v4_load (&m[0]), v4_splat (x)));
+    v4_store (&m[12], c3);
+#else
     float m00, m01, m02, m03;
     float m04, m05, m06, m07;
     float m08, m09, m10, m11;
@@ -449,6 +569,7 @@ matrix_translate (float *m, float x, float y, float z)
     m[13] = m13;
     m[14] = m14;
     m[15] = m15;
+#endif
 }
 
 /************************************************************
@@ -562,6 +683,21 @@ matrix_rotate (float *m, float angle, float x, float y, float z)
         r22  = z * zcosA2 + cosA;
 
         /* multing with 3x3 rotating matrix. */
+#if defined(UTIL_MATRIX_SIMD)
+        {
+            vec4f c0 = v4_load (&m[0]);
+            vec4f c1 = v4_load (&m[4]);
+            vec4f c2 = v4_load (&m[8]);
+            vec4f d;
+
+            d = v4_add (v4_mul (c0, v4_splat (r00)), v4_mul (c1, v4_splat (r10)));
+            v4_store (&m[0], v4_add (d, v4_mul (c2, v4_splat (r20))));
+            d = v4_add (v4_mul (c0, v4_splat (r01)), v4_mul (c1, v4_splat (r11)));
+            v4_store (&m[4], v4_add (d, v4_mul (c2, v4_splat (r21))));
+            d = v4_add (v4_mul (c0, v4_splat (r02)), v4_mul (c1, v4_splat (r12)));
+            v4_store (&m[8], v4_add (d, v4_mul (c2, v4_splat (r22))));
+        }
+#else
         {
             float fm0, fm1, fm2;
             float mx, my, mz;
@@ -634,6 +770,7 @@ matrix_rotate (float *m, float angle, float x, float y, float z)
 
             m[3] = mx; m[7] = my; m[11] = mz;
         }
+#endif
     }
 }
 
@@ -647,6 +784,11 @@ matrix_rotate (float *m, float angle, float x, float y, float z)
 void
 matrix_scale (float *m, float x, float y, float z)
 {
+#if defined(UTIL_MATRIX_SIMD)
+    v4_store (&m[0], v4_mul (v4_load (&m[0]), v4_splat (x)));
+    v4_store (&m[4], v4_mul (v4_load (&m[4]), v4_splat (y)));
+    v4_store (&m[8], v4_mul (v4_load (&m[8]), v4_splat (z)));
+#else
     float m00, m01, m02, m03;
     float m04, m05, m06, m07;
     float m08, m09, m10, m11;
@@ -688,6 +830,7 @@ matrix_scale (float *m, float x, float y, float z)
     m[ 3] = m03;
     m[ 7] = m07;
     m[11] = m11;
+#endif
 }
 
 /******************************************
@@ -827,6 +970,22 @@ matrix_modellookat (float *m, float *src_pos, float *tgt_pos, float twist)
 void
 matrix_mult (float *m, float *m1, float *m2)
 {
+#if defined(UTIL_MATRIX_SIMD)
+    /* all of m1 and m2 are read before m is written, m may be m1 or m2 */
+    vec4f c0 = v4_load (&m1[ 0]);
+    vec4f c1 = v4_load (&m1[ 4]);
+    vec4f c2 = v4_load (&m1[ 8]);
+    vec4f c3 = v4_load (&m1[12]);
+    vec4f d0 = v4_mult_column (c0, c1, c2, c3, &m2[ 0]);
+    vec4f d1 = v4_mult_column (c0, c1, c2, c3, &m2[ 4]);
+    vec4f d2 = v4_mult_column (c0, c1, c2, c3, &m2[ 8]);
+    vec4f d3 = v4_mult_column (c0, c1, c2, c3, &m2[12]);
+
+    v4_store (&m[ 0], d0);
+    v4_store (&m[ 4], d1);
+    v4_store (&m[ 8], d2);
+    v4_store (&m[12], d3);
+#else
     float fm0, fm1, fm2, fm3;
     float fpm00, fpm01, fpm02, fpm03;
     float fpm10, fpm11, fpm12, fpm13;
@@ -978,6 +1137,7 @@ matrix_mult (float *m, float *m1, float *m2)
     m[7] = y;
     m[11] = z;
     m[15] = w;
+#endif
 }
 
 
@@ -1119,6 +1279,15 @@ matrix_multvec2 (float *m, float *svec, float *dvec)
 void
 matrix_multvec3 (float *m, float *svec, float *dvec)
 {
+#if defined(UTIL_MATRIX_SIMD)
+    float d[4];
+
+    v4_store (d, v4_transform_point (v4_load (&m[0]), v4_load (&m[4]), v4_load (&m[8]), v4_load (&m[12]),
+                                     svec[0], svec[1], svec[2]));
+    dvec[0] = d[0];
+    dvec[1] = d[1];
+    dvec[2] = d[2];
+#else
     float v0 = svec[0];
     float v1 = svec[1];
     float v2 = svec[2];
@@ -1147,11 +1316,15 @@ matrix_multvec3 (float *m, float *svec, float *dvec)
     dvec[0] = _d0;
     dvec[1] = _d1;
     dvec[2] = _d2;
+#endif
 }
 
 void
 matrix_multvec4 (float *m, float *svec, float *dvec)
 {
+#if defined(UTIL_MATRIX_SIMD)
+    v4_store (dvec, v4_transform (v4_load (&m[0]), v4_load (&m[4]), v4_load (&m[8]), v4_load (&m[12]), svec));
+#else
     float v0 = svec[0];
     float v1 = svec[1];
     float v2 = svec[2];
@@ -1187,6 +1360,103 @@ matrix_multvec4 (float *m, float *svec, float *dvec)
     dvec[1] = _d1;
     dvec[2] = _d2;
     dvec[3] = _d3;
+#endif
+}
+
+
+/*
+ *  batches. one matrix for count elements, the elements packed.
+ *    - accept (dst) == (src)
+ */
+
+/* m[i] = m1 * m2[i] */
+void
+matrix_mult_batch (float *m, float *m1, float *m2, int count)
+{
+#if defined(UTIL_MATRIX_SIMD)
+    vec4f c0 = v4_load (&m1[ 0]);
+    vec4f c1 = v4_load (&m1[ 4]);
+    vec4f c2 = v4_load (&m1[ 8]);
+    vec4f c3 = v4_load (&m1[12]);
+    int i;
+
+    for (i = 0; i < count; i ++, m += 16, m2 += 16)
+    {
+        vec4f d0 = v4_mult_column (c0, c1, c2, c3, &m2[ 0]);
+        vec4f d1 = v4_mult_column (c0, c1, c2, c3, &m2[ 4]);
+        vec4f d2 = v4_mult_column (c0, c1, c2, c3, &m2[ 8]);
+        vec4f d3 = v4_mult_column (c0, c1, c2, c3, &m2[12]);
+
+        v4_store (&m[ 0], d0);
+        v4_store (&m[ 4], d1);
+        v4_store (&m[ 8], d2);
+        v4_store (&m[12], d3);
+    }
+#else
+    float tmp[16];
+    int i;
+
+    /* m1 is read after m[0] is written */
+    matrix_copy (tmp, m1);
+    for (i = 0; i < count; i ++)
+    {
+        matrix_mult (&m[i * 16], tmp, &m2[i * 16]);
+    }
+#endif
+}
+
+/* dvec[i] = m * svec[i], 3 floats each */
+void
+matrix_multvec3_batch (float *m, float *svec, float *dvec, int count)
+{
+#if defined(UTIL_MATRIX_SIMD)
+    vec4f c0 = v4_load (&m[ 0]);
+    vec4f c1 = v4_load (&m[ 4]);
+    vec4f c2 = v4_load (&m[ 8]);
+    vec4f c3 = v4_load (&m[12]);
+    float d[4];
+    int i;
+
+    for (i = 0; i < count; i ++, svec += 3, dvec += 3)
+    {
+        v4_store (d, v4_transform_point (c0, c1, c2, c3, svec[0], svec[1], svec[2]));
+        dvec[0] = d[0];
+        dvec[1] = d[1];
+        dvec[2] = d[2];
+    }
+#else
+    int i;
+
+    for (i = 0; i < count; i ++)
+    {
+        matrix_multvec3 (m, &svec[i * 3], &dvec[i * 3]);
+    }
+#endif
+}
+
+/* dvec[i] = m * svec[i], 4 floats each */
+void
+matrix_multvec4_batch (float *m, float *svec, float *dvec, int count)
+{
+#if defined(UTIL_MATRIX_SIMD)
+    vec4f c0 = v4_load (&m[ 0]);
+    vec4f c1 = v4_load (&m[ 4]);
+    vec4f c2 = v4_load (&m[ 8]);
+    vec4f c3 = v4_load (&m[12]);
+    int i;
+
+    for (i = 0; i < count; i ++, svec += 4, dvec += 4)
+    {
+        v4_store (dvec, v4_transform (c0, c1, c2, c3, svec));
+    }
+#else
+    int i;
+
+    for (i = 0; i < count; i ++)
+    {
+        matrix_multvec4 (m, &svec[i * 4], &dvec[i * 4]);
+    }
+#endif
 }
 
 
@@ -1285,6 +1555,70 @@ matrix_transpose (float *m)
 }
 
 
+#if defined(UTIL_MATRIX_SIMD)
+/* (a[i], a[i], a[i], b[i]) */
+#define INV_LANES(a, b, i) \
+    V4_SHUFFLE (V4_SHUFFLE (a, b, i, i, i, i), V4_SHUFFLE (a, b, i, i, i, i), 0, 0, 0, 2)
+/* row r of columns 0, 1: (c1[r], c0[r], c0[r], c0[r]) */
+#define INV_ROW(c0, c1, r) \
+    V4_SHUFFLE (V4_SHUFFLE (c1, c0, r, r, r, r), V4_SHUFFLE (c1, c0, r, r, r, r), 0, 2, 2, 2)
+/* 2x2 determinants of rows i and j: (columns 23, columns 23, columns 13, columns 12) */
+#define INV_FACTOR(c1, c2, c3, i, j)                                        \
+    v4_sub (v4_mul (V4_SHUFFLE (c2, c1, i, i, i, i), INV_LANES (c3, c2, j)), \
+            v4_mul (INV_LANES (c3, c2, i), V4_SHUFFLE (c2, c1, j, j, j, j)))
+
+/*
+ *  the cofactors from 6 shared 2x2 determinants instead of 16 3x3 minors.
+ *  the rounding differs from the scalar code by a few ulp.
+ */
+static void
+invert_general (float *m)
+{
+    vec4f c0 = v4_load (&m[ 0]);
+    vec4f c1 = v4_load (&m[ 4]);
+    vec4f c2 = v4_load (&m[ 8]);
+    vec4f c3 = v4_load (&m[12]);
+
+    vec4f fac0 = INV_FACTOR (c1, c2, c3, 2, 3);
+    vec4f fac1 = INV_FACTOR (c1, c2, c3, 1, 3);
+    vec4f fac2 = INV_FACTOR (c1, c2, c3, 1, 2);
+    vec4f fac3 = INV_FACTOR (c1, c2, c3, 0, 3);
+    vec4f fac4 = INV_FACTOR (c1, c2, c3, 0, 2);
+    vec4f fac5 = INV_FACTOR (c1, c2, c3, 0, 1);
+
+    vec4f vec0 = INV_ROW (c0, c1, 0);
+    vec4f vec1 = INV_ROW (c0, c1, 1);
+    vec4f vec2 = INV_ROW (c0, c1, 2);
+    vec4f vec3 = INV_ROW (c0, c1, 3);
+
+    vec4f signA = v4_set ( 1.0f, -1.0f,  1.0f, -1.0f);
+    vec4f signB = v4_set (-1.0f,  1.0f, -1.0f,  1.0f);
+    vec4f inv0 = v4_mul (v4_add (v4_sub (v4_mul (vec1, fac0), v4_mul (vec2, fac1)), v4_mul (vec3, fac2)), signA);
+    vec4f inv1 = v4_mul (v4_add (v4_sub (v4_mul (vec0, fac0), v4_mul (vec2, fac3)), v4_mul (vec3, fac4)), signB);
+    vec4f inv2 = v4_mul (v4_add (v4_sub (v4_mul (vec0, fac1), v4_mul (vec1, fac3)), v4_mul (vec3, fac5)), signA);
+    vec4f inv3 = v4_mul (v4_add (v4_sub (v4_mul (vec0, fac2), v4_mul (vec1, fac4)), v4_mul (vec2, fac5)), signB);
+
+    /* row 0 of the inverse is lane 0 of each column */
+    float w[16];
+    v4_store (&w[ 0], inv0);
+    v4_store (&w[ 4], inv1);
+    v4_store (&w[ 8], inv2);
+    v4_store (&w[12], inv3);
+
+    float det = (m[0] * w[0] + m[1] * w[4]) + (m[2] * w[8] + m[3] * w[12]);
+    if ( det == 0.0f )
+    {
+        return;
+    }
+    vec4f invdet = v4_splat (1.0f / det);
+
+    v4_store (&m[ 0], v4_mul (inv0, invdet));
+    v4_store (&m[ 4], v4_mul (inv1, invdet));
+    v4_store (&m[ 8], v4_mul (inv2, invdet));
+    v4_store (&m[12], v4_mul (inv3, invdet));
+}
+#endif
+
 void
 matrix_invert (float *m)
 {
@@ -1292,10 +1626,10 @@ matrix_invert (float *m)
     float m04, m05, m06, m07;
     float m08, m09, m10, m11;
     float m12, m13, m14, m15;
-    float W00, W04, W08, W12;
-    float W01, W05, W09, W13;
-    float W02, W06, W10, W14;
-    float W03, W07, W11, W15;
+    float W00, W04, W08;
+    float W01, W05, W09;
+    float W02, W06, W10;
+    float W03, W07, W11;
     float det, invdet;
 
     m00 = m[ 0]; m04 = m[ 4]; m08 = m[ 8]; m12 = m[12];
@@ -1352,6 +1686,11 @@ matrix_invert (float *m)
     }
     else
     {
+#if defined(UTIL_MATRIX_SIMD)
+        invert_general (m);
+#else
+        float W12, W13, W14, W15;
+
         W00 = (m05 * (m10 * m15 - m14 * m11))
             + (m09 * (m14 * m07 - m06 * m15))
             + (m13 * (m06 * m11 - m10 * m07));
@@ -1425,6 +1764,7 @@ matrix_invert (float *m)
         m[13] =  W13 * invdet;
         m[14] = -W14 * invdet;
         m[15] =  W15 * invdet;
+#endif
     }
 }
 
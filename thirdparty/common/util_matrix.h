@@ -37,6 +37,11 @@ void matrix_multvec2 (float *m, float *svec, float *dvec);
 void matrix_multvec3 (float *m, float *svec, float *dvec);
 void matrix_multvec4 (float *m, float *svec, float *dvec);
 
+/* one matrix for count packed matrices or vectors */
+void matrix_mult_batch     (float *m, float *m1, float *m2, int count);
+void matrix_multvec3_batch (float *m, float *svec, float *dvec, int count);
+void matrix_multvec4_batch (float *m, float *svec, float *dvec, int count);
+
 void matrix_print (float *m);
 
 void matrix_copy( float *d, float *s );
@@ -885,9 +885,15 @@ oxr_locate_handjoints (XrInstance instance, XrHandTrackerEXT handTracker,
                        XrSpace bspace, XrTime time,
                        XrHandJointLocationsEXT *loc)
 {
-    PFN_xrLocateHandJointsEXT xrLocateHandJointsEXT;
-    xrGetInstanceProcAddr (instance, "xrLocateHandJointsEXT",
-                           (PFN_xrVoidFunction *)&xrLocateHandJointsEXT);
+    /* called every frame. resolve once per instance */
+    static XrInstance                s_instance = XR_NULL_HANDLE;
+    static PFN_xrLocateHandJointsEXT xrLocateHandJointsEXT = nullptr;
+    if (s_instance != instance)
+    {
+        xrGetInstanceProcAddr (instance, "xrLocateHandJointsEXT",
+                               (PFN_xrVoidFunction *)&xrLocateHandJointsEXT);
+        s_instance = instance;
+    }
 
     XrHandJointsLocateInfoEXT info = {XR_TYPE_HAND_JOINTS_LOCATE_INFO_EXT};
     info.baseSpace = bspace;
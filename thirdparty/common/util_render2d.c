@@ -709,7 +709,6 @@ draw_2d_rect (int x, int y, int w, int h, float *color, float line_width)
 {
     int ttype = SHADER_TYPE_FILL;
     shader_obj_t *sobj = &s_sobj[ttype];
-    float matrix[16];
 
     glBindBuffer (GL_ARRAY_BUFFER, 0);
     glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -721,9 +720,8 @@ draw_2d_rect (int x, int y, int w, int h, float *color, float line_width)
     glBlendFuncSeparate (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, 
                GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-    matrix_identity (matrix);
-    matrix_mult (matrix, s_matprj, matrix);
-    glUniformMatrix4fv (s_loc_mtx[ttype], 1, GL_FALSE, matrix);
+    /* no model transform, the projection as is */
+    glUniformMatrix4fv (s_loc_mtx[ttype], 1, GL_FALSE, s_matprj);
 
     glLineWidth (line_width);
     float x1 = x;
@@ -810,7 +808,6 @@ draw_2d_line (int x0, int y0, int x1, int y1, float *color, float line_width)
     {
         int ttype = 0;
         shader_obj_t *sobj = &s_sobj[ttype];
-        float matrix[16];
 
         glUseProgram (sobj->program);
         glUniform4fv (s_loc_color[ttype], 1, color);
@@ -819,9 +816,8 @@ draw_2d_line (int x0, int y0, int x1, int y1, float *color, float line_width)
         glBlendFuncSeparate (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
                    GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-        matrix_identity (matrix);
-        matrix_mult (matrix, s_matprj, matrix);
-        glUniformMatrix4fv (s_loc_mtx[ttype], 1, GL_FALSE, matrix);
+        /* no model transform, the projection as is */
+        glUniformMatrix4fv (s_loc_mtx[ttype], 1, GL_FALSE, s_matprj);
 
         glLineWidth (line_width);
         if (sobj->loc_vtx >= 0)
@@ -869,7 +865,6 @@ draw_2d_fillcircle (int x, int y, int radius, float *color)
 {
     int ttype = SHADER_TYPE_FILL;
     shader_obj_t *sobj = &s_sobj[ttype];
-    float matrix[16];
     float vtx[(CIRCLE_DIVNUM+2) * 2];
 
     glBindBuffer (GL_ARRAY_BUFFER, 0);
@@ -882,9 +877,8 @@ draw_2d_fillcircle (int x, int y, int radius, float *color)
     glBlendFuncSeparate (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
                GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-    matrix_identity (matrix);
-    matrix_mult (matrix, s_matprj, matrix);
-    glUniformMatrix4fv (s_loc_mtx[ttype], 1, GL_FALSE, matrix);
+    /* no model transform, the projection as is */
+    glUniformMatrix4fv (s_loc_mtx[ttype], 1, GL_FALSE, s_matprj);
 
     if (sobj->loc_vtx >= 0)
     {
@@ -915,7 +909,6 @@ draw_2d_circle (int x, int y, int radius, int ndiv, float *color, float line_wid
 {
     int ttype = SHADER_TYPE_FILL;
     shader_obj_t *sobj = &s_sobj[ttype];
-    float matrix[16];
     float vtx[65535];
 
     glBindBuffer (GL_ARRAY_BUFFER, 0);
@@ -928,9 +921,8 @@ draw_2d_circle (int x, int y, int radius, int ndiv, float *color, float line_wid
     glBlendFuncSeparate (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
                GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-    matrix_identity (matrix);
-    matrix_mult (matrix, s_matprj, matrix);
-    glUniformMatrix4fv (s_loc_mtx[ttype], 1, GL_FALSE, matrix);
+    /* no model transform, the projection as is */
+    glUniformMatrix4fv (s_loc_mtx[ttype], 1, GL_FALSE, s_matprj);
 
     glLineWidth (line_width);
     if (sobj->loc_vtx >= 0)